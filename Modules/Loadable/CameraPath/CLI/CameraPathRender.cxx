@@ -0,0 +1,925 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Render a camera path offscreen, without the application or a display.
+//
+// The scene models are rendered by the model displayable manager in an
+// offscreen render window, the camera being moved along the path at each
+// frame. Only models are rendered: volume rendering, markups and the other
+// displayable managers of the application are not, and the path splines
+// are hidden. Frames are written as numbered PNG screenshots or as a video clip,
+// like the export of the CameraPath module. On a server without a display,
+// VTK must be built with an offscreen OpenGL implementation (e.g. OSMesa).
+//
+// Usage:
+//   CameraPathRender --scene scene.mrml --path path.kcsv
+//                    --width 1920 --height 1080 --fps 30
+//                    --output frames/path.png
+//
+// Long paths can be split in shards rendered by independent processes:
+//   CameraPathRender ... --shard-index 1 --shard-count 4 --output frames/path.png
+//   ...
+//   CameraPathRender ... --shard-index 4 --shard-count 4 --output frames/path.png
+// then assembled in a video clip from the numbered screenshots, up to the
+// last frame of the shard manifests:
+//   CameraPathRender --merge frames/path.png --fps 30 --output path.mkv
+//
+// Frames larger than the offscreen buffers of the graphics driver, e.g. 8K
+// posters, are rendered in tiles stitched together:
+//   CameraPathRender ... --width 7680 --height 4320 --tile-width 1920
+//                    --tile-height 1080 --output poster.png
+//
+// Video clips are encoded on a separate thread, in H.264, H.265 or VP9 by
+// ffmpeg, or in MPEG-4 by VTK:
+//   CameraPathRender ... --output path.mp4 --codec h265 --crf 26 --gop 60
+// They can also be encoded by an external command reading a YUV4MPEG2
+// stream, "%o" being replaced by the output file:
+//   CameraPathRender ... --output path.mp4
+//                    --encoder "ffmpeg -y -f yuv4mpegpipe -i - -crf 18 %o"
+//
+// Smaller outputs are downscaled from the rendered frames instead of being
+// rendered again, e.g. path_1280x720.mp4 and the path_640x360_*.png
+// thumbnails with:
+//   CameraPathRender ... --width 1920 --height 1080 --output path.mp4
+//                    --outputs "1280x720, 640x360.png"
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathCommandEncoder.h"
+#include "vtkSlicerCameraPathDownscaler.h"
+#include "vtkSlicerCameraPathExporter.h"
+#include "vtkSlicerCameraPathFFMPEGEncoder.h"
+#include "vtkSlicerCameraPathLogic.h"
+#include "vtkSlicerCameraPathTileRenderer.h"
+#include "vtkMRMLPointSplineNode.h"
+
+// MRML includes
+#include <vtkMRMLApplicationLogic.h>
+#include <vtkMRMLCameraNode.h>
+#include <vtkMRMLDisplayableManagerGroup.h>
+#include <vtkMRMLDisplayNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLThreeDViewDisplayableManagerFactory.h>
+#include <vtkMRMLViewNode.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPNGReader.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkSmartPointer.h>
+#include <vtksys/CommandLineArguments.hxx>
+#include <vtksys/Directory.hxx>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+enum ExportQuality{ LOW=0, MEDIUM, HIGH};
+
+//----------------------------------------------------------------------------
+// Encoder settings given on the command line
+struct EncoderSettings
+{
+  std::string Codec;
+  /// Constant rate factor, the default of the codec for Quality if negative
+  int ConstantRateFactor;
+  int Quality;
+  int BitRate;
+  int GOPSize;
+  int NumberOfThreads;
+  std::string Command;
+};
+
+//----------------------------------------------------------------------------
+// Start the encoder backend of the settings for frames of width by height
+// pixels, 0 if the codec is unknown or the encoder could not start
+vtkSmartPointer<vtkSlicerCameraPathVideoEncoder> startEncoder(
+  const EncoderSettings& settings, const std::string& outputFileName,
+  int framerate, int width, int height)
+{
+  vtkSmartPointer<vtkSlicerCameraPathVideoEncoder> encoder;
+  int codec = vtkSlicerCameraPathVideoEncoder::H264;
+  std::string codecName = vtksys::SystemTools::LowerCase(settings.Codec);
+  if (codecName == "h265")
+    {
+    codec = vtkSlicerCameraPathVideoEncoder::H265;
+    }
+  else if (codecName == "vp9")
+    {
+    codec = vtkSlicerCameraPathVideoEncoder::VP9;
+    }
+  else if (codecName == "mpeg4")
+    {
+    codec = vtkSlicerCameraPathVideoEncoder::MPEG4;
+    }
+  else if (codecName != "h264")
+    {
+    std::cerr << "Unknown codec " << settings.Codec
+              << ", use h264, h265, vp9 or mpeg4" << std::endl;
+    return encoder;
+    }
+
+  if (codec == vtkSlicerCameraPathVideoEncoder::MPEG4 &&
+      settings.Command.empty())
+    {
+    encoder.TakeReference(vtkSlicerCameraPathFFMPEGEncoder::New());
+    }
+  else
+    {
+    vtkSmartPointer<vtkSlicerCameraPathCommandEncoder> commandEncoder =
+      vtkSmartPointer<vtkSlicerCameraPathCommandEncoder>::New();
+    commandEncoder->SetCommand(settings.Command.c_str());
+    encoder = commandEncoder.GetPointer();
+    }
+  int constantRateFactor = settings.ConstantRateFactor;
+  if (settings.BitRate > 0)
+    {
+    constantRateFactor = -1;
+    }
+  else if (constantRateFactor < 0)
+    {
+    constantRateFactor = vtkSlicerCameraPathVideoEncoder::
+      GetDefaultConstantRateFactor(codec, settings.Quality);
+    }
+  encoder->SetCodec(codec);
+  encoder->SetConstantRateFactor(constantRateFactor);
+  encoder->SetBitRate(settings.BitRate);
+  encoder->SetGOPSize(settings.GOPSize);
+  encoder->SetNumberOfThreads(settings.NumberOfThreads);
+  encoder->SetFileName(outputFileName.c_str());
+  encoder->SetRate(framerate);
+  if (!encoder->Start(width, height))
+    {
+    std::cerr << "Could not start the "
+              << vtkSlicerCameraPathVideoEncoder::GetCodecName(codec)
+              << " encoder" << std::endl;
+    encoder = 0;
+    }
+  return encoder;
+}
+
+//----------------------------------------------------------------------------
+// Start writing screenshots compressed for the quality, resuming an
+// interrupted render of the same frames
+bool startExporter(vtkSlicerCameraPathExporter* exporter, int quality,
+                   const std::string& path, const std::string& baseName,
+                   int firstFrame, int lastFrame, const std::string& hash,
+                   int framerate, int width, int height)
+{
+  const int compressionLevels[3] = {9, 5, 1};
+  exporter->SetCompressionLevel(compressionLevels[quality]);
+  exporter->SetManifestFileName(vtkSlicerCameraPathLogic::GetManifestFileName(
+    path, baseName, firstFrame, lastFrame).c_str());
+  exporter->SetExportSettings(hash.c_str(), width, height, framerate);
+  if (!exporter->Start())
+    {
+    std::cerr << "Could not start writing screenshots " << baseName
+              << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Downscaled output, written by its own screenshot writers or video encoder
+struct OutputWriter
+{
+  ExportOutput Output;
+  std::string BaseName;
+  vtkSmartPointer<vtkSlicerCameraPathDownscaler> Downscaler;
+  vtkSmartPointer<vtkImageData> Image;
+  vtkSmartPointer<vtkSlicerCameraPathExporter> Exporter;
+  vtkSmartPointer<vtkSlicerCameraPathVideoEncoder> Encoder;
+};
+
+//----------------------------------------------------------------------------
+vtkMRMLCameraPathNode* findCameraPathNode(vtkMRMLScene* scene,
+                                          const std::string& name)
+{
+  int numberOfNodes = scene->GetNumberOfNodesByClass("vtkMRMLCameraPathNode");
+  for (int i = 0; i < numberOfNodes; ++i)
+    {
+    vtkMRMLCameraPathNode* cameraPathNode = vtkMRMLCameraPathNode::SafeDownCast(
+      scene->GetNthNodeByClass(i, "vtkMRMLCameraPathNode"));
+    if (name.empty() ||
+        (cameraPathNode->GetName() && name == cameraPathNode->GetName()) ||
+        name == cameraPathNode->GetID())
+      {
+      return cameraPathNode;
+      }
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLCameraNode* findViewCameraNode(vtkMRMLScene* scene,
+                                      vtkMRMLViewNode* viewNode)
+{
+  int numberOfNodes = scene->GetNumberOfNodesByClass("vtkMRMLCameraNode");
+  for (int i = 0; i < numberOfNodes; ++i)
+    {
+    vtkMRMLCameraNode* cameraNode = vtkMRMLCameraNode::SafeDownCast(
+      scene->GetNthNodeByClass(i, "vtkMRMLCameraNode"));
+    if (cameraNode->GetActiveTag() &&
+        !strcmp(cameraNode->GetActiveTag(), viewNode->GetID()))
+      {
+      return cameraNode;
+      }
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+// Hide the point spline models of the camera paths, which are added to the
+// scene to edit the paths but must not appear in the rendered frames
+void hidePointSplines(vtkMRMLScene* scene)
+{
+  int numberOfNodes = scene->GetNumberOfNodesByClass("vtkMRMLPointSplineNode");
+  for (int i = 0; i < numberOfNodes; ++i)
+    {
+    vtkMRMLPointSplineNode* splineNode = vtkMRMLPointSplineNode::SafeDownCast(
+      scene->GetNthNodeByClass(i, "vtkMRMLPointSplineNode"));
+    for (int d = 0; d < splineNode->GetNumberOfDisplayNodes(); ++d)
+      {
+      if (splineNode->GetNthDisplayNode(d))
+        {
+        splineNode->GetNthDisplayNode(d)->SetVisibility(0);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Return the last frame of the shard manifests of the screenshots named
+// after baseName in path, see vtkSlicerCameraPathLogic::GetManifestFileName(),
+// or -1 if there is none
+int findManifestsLastFrame(const std::string& path, const std::string& baseName)
+{
+  int lastFrame = -1;
+  vtksys::Directory directory;
+  if (!directory.Load(path.c_str()))
+    {
+    return lastFrame;
+    }
+  const std::string prefix = baseName + "_";
+  const std::string suffix = ".manifest";
+  for (unsigned long i = 0; i < directory.GetNumberOfFiles(); ++i)
+    {
+    std::string fileName = directory.GetFile(i);
+    if (fileName.size() <= prefix.size() + suffix.size() ||
+        fileName.compare(0, prefix.size(), prefix) != 0 ||
+        fileName.compare(fileName.size() - suffix.size(), suffix.size(), suffix) != 0)
+      {
+      continue;
+      }
+    std::string range = fileName.substr(
+      prefix.size(), fileName.size() - prefix.size() - suffix.size());
+    int shardFirstFrame = 0;
+    int shardLastFrame = 0;
+    char end = 0;
+    if (sscanf(range.c_str(), "%d-%d%c", &shardFirstFrame, &shardLastFrame, &end) == 2)
+      {
+      lastFrame = std::max(lastFrame, shardLastFrame);
+      }
+    }
+  return lastFrame;
+}
+
+//----------------------------------------------------------------------------
+// Write the screenshots numbered after framesFileName, from firstFrame to
+// lastFrame, in a video clip encoded with the encoder settings. If lastFrame
+// is negative, it is the last frame of the shard manifests. A missing
+// screenshot fails the merge.
+int mergeFrames(const std::string& framesFileName, int firstFrame,
+                int lastFrame, const std::string& outputFileName,
+                int framerate, const EncoderSettings& encoderSettings)
+{
+  std::string path = vtksys::SystemTools::GetFilenamePath(framesFileName);
+  std::string baseName =
+    vtksys::SystemTools::GetFilenameWithoutLastExtension(framesFileName);
+  if (path.empty())
+    {
+    path = ".";
+    }
+  if (lastFrame < 0)
+    {
+    lastFrame = findManifestsLastFrame(path, baseName);
+    if (lastFrame < 0)
+      {
+      std::cerr << "No manifest of the screenshots " << baseName
+                << ", give the last frame with --last-frame" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if (lastFrame < firstFrame)
+    {
+    std::cerr << "No frame to merge" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::string frameFileName = vtkSlicerCameraPathLogic::GetFrameFileName(
+    path, baseName, firstFrame, "png");
+  if (!vtksys::SystemTools::FileExists(frameFileName.c_str(), true))
+    {
+    std::cerr << "No frame " << frameFileName << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkPNGReader> reader;
+  reader->SetFileName(frameFileName.c_str());
+  reader->Update();
+  int dimensions[3];
+  reader->GetOutput()->GetDimensions(dimensions);
+  vtkSmartPointer<vtkSlicerCameraPathVideoEncoder> encoder = startEncoder(
+    encoderSettings, outputFileName, framerate, dimensions[0], dimensions[1]);
+  if (!encoder)
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Reading the next screenshot overlaps encoding the previous ones
+  int frame = firstFrame;
+  bool written = true;
+  for (; frame <= lastFrame && written; ++frame)
+    {
+    frameFileName = vtkSlicerCameraPathLogic::GetFrameFileName(
+      path, baseName, frame, "png");
+    if (!vtksys::SystemTools::FileExists(frameFileName.c_str(), true))
+      {
+      encoder->End();
+      std::cerr << "Missing frame " << frame << ": " << frameFileName
+                << std::endl;
+      return EXIT_FAILURE;
+      }
+    reader->SetFileName(frameFileName.c_str());
+    reader->Update();
+    written = encoder->AddFrame(reader->GetOutput());
+    std::cout << "Merged frame " << frame << std::endl;
+    }
+  if (!encoder->End() || !written)
+    {
+    std::cerr << "The video could not be encoded" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Merged " << frame - firstFrame << " frames to "
+            << outputFileName << std::endl;
+  return EXIT_SUCCESS;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  std::string sceneFileName;
+  std::string pathFileName;
+  std::string pathNodeName;
+  std::string viewNodeID;
+  std::string outputFileName;
+  std::string framesFileName;
+  std::string outputsText;
+  EncoderSettings encoderSettings;
+  encoderSettings.Codec = "h264";
+  encoderSettings.ConstantRateFactor = -2;
+  encoderSettings.Quality = HIGH;
+  encoderSettings.BitRate = 0;
+  encoderSettings.GOPSize = 0;
+  encoderSettings.NumberOfThreads = 0;
+  int width = 1280;
+  int height = 720;
+  int tileWidth = 0;
+  int tileHeight = 0;
+  int framerate = 30;
+  int quality = HIGH;
+  int firstFrame = 0;
+  int lastFrame = -1;
+  int shardIndex = 1;
+  int shardCount = 1;
+  bool help = false;
+
+  typedef vtksys::CommandLineArguments argT;
+  argT arguments;
+  arguments.Initialize(argc, argv);
+  arguments.AddArgument("--scene", argT::SPACE_ARGUMENT, &sceneFileName,
+    "MRML scene (.mrml) with the models to render, and the camera path if "
+    "--path is not given. Only models are rendered, not volume rendering");
+  arguments.AddArgument("--path", argT::SPACE_ARGUMENT, &pathFileName,
+    "Camera path keyframes file (.kcsv) to render");
+  arguments.AddArgument("--path-node", argT::SPACE_ARGUMENT, &pathNodeName,
+    "Name or ID of the camera path node of the scene to render, the first "
+    "one by default");
+  arguments.AddArgument("--view", argT::SPACE_ARGUMENT, &viewNodeID,
+    "ID of the view node of the scene to render, the first one by default");
+  arguments.AddArgument("--output", argT::SPACE_ARGUMENT, &outputFileName,
+    "Output file: a video clip (.mkv, .mp4, .webm, .avi) or screenshots "
+    "(.png) numbered after the file base name");
+  arguments.AddArgument("--outputs", argT::SPACE_ARGUMENT, &outputsText,
+    "Smaller outputs downscaled from the rendered frames, separated by "
+    "commas: <width>x<height> with an optional extension, e.g. "
+    "\"1280x720, 640x360.png\". They are written next to the output, named "
+    "<base name>_<width>x<height>, as screenshots for .png and as video "
+    "clips encoded with the codec settings otherwise. Outputs must have the "
+    "aspect ratio of the frames.");
+  arguments.AddArgument("--width", argT::SPACE_ARGUMENT, &width,
+    "Width of the frames in pixels");
+  arguments.AddArgument("--height", argT::SPACE_ARGUMENT, &height,
+    "Height of the frames in pixels");
+  arguments.AddArgument("--tile-width", argT::SPACE_ARGUMENT, &tileWidth,
+    "Width of the tiles the frames are rendered in, the frame width if 0");
+  arguments.AddArgument("--tile-height", argT::SPACE_ARGUMENT, &tileHeight,
+    "Height of the tiles the frames are rendered in, the frame height if 0");
+  arguments.AddArgument("--fps", argT::SPACE_ARGUMENT, &framerate,
+    "Number of frames per second of path time");
+  arguments.AddArgument("--quality", argT::SPACE_ARGUMENT, &quality,
+    "Export quality: 0 (low), 1 (medium) or 2 (high)");
+  arguments.AddArgument("--first-frame", argT::SPACE_ARGUMENT, &firstFrame,
+    "First frame to render, frames are numbered from 0 at the start of the "
+    "path");
+  arguments.AddArgument("--last-frame", argT::SPACE_ARGUMENT, &lastFrame,
+    "Last frame to render, the last frame of the path by default");
+  arguments.AddArgument("--shard-index", argT::SPACE_ARGUMENT, &shardIndex,
+    "Index, from 1 to --shard-count, of the shard of the frame range to "
+    "render");
+  arguments.AddArgument("--shard-count", argT::SPACE_ARGUMENT, &shardCount,
+    "Number of shards the frame range is split in, each rendered by a "
+    "separate process as screenshots");
+  arguments.AddArgument("--codec", argT::SPACE_ARGUMENT, &encoderSettings.Codec,
+    "Codec of the video clip: h264 (default), h265 or vp9, encoded by "
+    "ffmpeg, or mpeg4 encoded by VTK");
+  arguments.AddArgument("--crf", argT::SPACE_ARGUMENT,
+    &encoderSettings.ConstantRateFactor,
+    "Constant rate factor of the codec, lower is better. By default the "
+    "usual factor of the codec for the quality, e.g. 28, 23 or 18 with "
+    "h264 and 40, 33 or 24 with vp9 for the low, medium or high quality.");
+  arguments.AddArgument("--bitrate", argT::SPACE_ARGUMENT,
+    &encoderSettings.BitRate,
+    "Bit rate of the video clip in kbit/s, instead of a constant rate factor");
+  arguments.AddArgument("--gop", argT::SPACE_ARGUMENT, &encoderSettings.GOPSize,
+    "Maximum number of frames between key frames, the codec default if 0");
+  arguments.AddArgument("--encoder-threads", argT::SPACE_ARGUMENT,
+    &encoderSettings.NumberOfThreads,
+    "Number of worker threads of the codec, chosen by the codec if 0");
+  arguments.AddArgument("--encoder", argT::SPACE_ARGUMENT,
+    &encoderSettings.Command,
+    "Encoder command the frames are streamed to in YUV4MPEG2 format, "
+    "instead of the codec settings. \"%o\" is replaced by the output "
+    "file, whose extension can then be any container of the encoder.");
+  arguments.AddArgument("--merge", argT::SPACE_ARGUMENT, &framesFileName,
+    "Screenshots (.png) to write in the output video clip, numbered after "
+    "the file base name from --first-frame to --last-frame, instead of "
+    "rendering. The last frame defaults to the last frame of the shard "
+    "manifests, and a missing screenshot fails the merge");
+  arguments.AddBooleanArgument("--help", &help, "Print this help");
+
+  if (!arguments.Parse() || help ||
+      (sceneFileName.empty() && pathFileName.empty() &&
+       framesFileName.empty()) ||
+      outputFileName.empty())
+    {
+    std::cerr << "Usage: " << argv[0] << " [options] --output <file>\n"
+              << "Renders the scene models along a camera path; volume "
+              << "rendering and the other 3D view content are not rendered.\n"
+              << arguments.GetHelp() << std::endl;
+    return help ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  if (width <= 0 || height <= 0 || framerate <= 0 ||
+      tileWidth < 0 || tileHeight < 0 || quality < LOW || quality > HIGH)
+    {
+    std::cerr << "Invalid size, framerate or quality" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (tileWidth == 0 || tileWidth > width)
+    {
+    tileWidth = width;
+    }
+  if (tileHeight == 0 || tileHeight > height)
+    {
+    tileHeight = height;
+    }
+  const bool tiled = tileWidth < width || tileHeight < height;
+  encoderSettings.Quality = quality;
+
+  std::string suffix = vtksys::SystemTools::LowerCase(
+    vtksys::SystemTools::GetFilenameLastExtension(outputFileName));
+  const bool video = !encoderSettings.Command.empty() || suffix == ".mkv" ||
+    suffix == ".mp4" || suffix == ".webm" || suffix == ".avi";
+  if (!video && suffix != ".png")
+    {
+    std::cerr << "Unsupported output extension " << suffix
+              << ", use .mkv, .mp4, .webm, .avi or .png" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!framesFileName.empty())
+    {
+    if (!video)
+      {
+      std::cerr << "Screenshots are merged in a video clip" << std::endl;
+      return EXIT_FAILURE;
+      }
+    return mergeFrames(framesFileName, firstFrame, lastFrame, outputFileName,
+                       framerate, encoderSettings);
+    }
+
+  // Outputs default to the extension of the output
+  std::vector<ExportOutput> outputs;
+  if (!vtkSlicerCameraPathLogic::ParseExportOutputs(outputsText, outputs))
+    {
+    std::cerr << "Invalid outputs " << outputsText
+              << ", use <width>x<height>[.<extension>]" << std::endl;
+    return EXIT_FAILURE;
+    }
+  bool videoOutputs = false;
+  for (size_t o = 0; o < outputs.size(); ++o)
+    {
+    if (outputs[o].Width > width || outputs[o].Height > height)
+      {
+      std::cerr << "Output " << outputs[o].Width << "x" << outputs[o].Height
+                << " is larger than the frames" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (!vtkSlicerCameraPathLogic::HasFrameAspectRatio(outputs[o], width,
+                                                       height))
+      {
+      std::cerr << "Output " << outputs[o].Width << "x" << outputs[o].Height
+                << " does not have the aspect ratio of the frames " << width
+                << "x" << height << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (outputs[o].Extension.empty())
+      {
+      outputs[o].Extension = suffix.empty() ? "mkv" : suffix.substr(1);
+      }
+    videoOutputs = videoOutputs ||
+      vtksys::SystemTools::LowerCase(outputs[o].Extension) != "png";
+    }
+  if ((video || videoOutputs) && shardCount > 1)
+    {
+    std::cerr << "Shards can only be rendered as screenshots" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Scene
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLApplicationLogic> applicationLogic;
+  applicationLogic->SetMRMLScene(scene.GetPointer());
+  vtkNew<vtkSlicerCameraPathLogic> logic;
+  logic->SetMRMLScene(scene.GetPointer());
+
+  if (!sceneFileName.empty())
+    {
+    scene->SetURL(sceneFileName.c_str());
+    if (!scene->Connect())
+      {
+      std::cerr << "Could not load scene " << sceneFileName << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Camera path
+  vtkMRMLCameraPathNode* cameraPathNode = 0;
+  if (!pathFileName.empty())
+    {
+    std::string name =
+      vtksys::SystemTools::GetFilenameWithoutLastExtension(pathFileName);
+    char* nodeIDs = logic->LoadCameraPath(pathFileName.c_str(), name.c_str());
+    if (nodeIDs)
+      {
+      std::string pathNodeID(nodeIDs, strcspn(nodeIDs, ","));
+      cameraPathNode = vtkMRMLCameraPathNode::SafeDownCast(
+        scene->GetNodeByID(pathNodeID.c_str()));
+      free(nodeIDs);
+      }
+    }
+  else
+    {
+    cameraPathNode = findCameraPathNode(scene.GetPointer(), pathNodeName);
+    }
+  if (!cameraPathNode || cameraPathNode->GetNumberOfKeyFrames() < 2)
+    {
+    std::cerr << "No camera path with at least two keyframes to render"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  hidePointSplines(scene.GetPointer());
+
+  // View and its camera
+  vtkMRMLViewNode* viewNode = 0;
+  if (!viewNodeID.empty())
+    {
+    viewNode = vtkMRMLViewNode::SafeDownCast(
+      scene->GetNodeByID(viewNodeID.c_str()));
+    }
+  else
+    {
+    viewNode = vtkMRMLViewNode::SafeDownCast(
+      scene->GetNthNodeByClass(0, "vtkMRMLViewNode"));
+    }
+  if (!viewNode)
+    {
+    if (!viewNodeID.empty())
+      {
+      std::cerr << "No view node " << viewNodeID << std::endl;
+      return EXIT_FAILURE;
+      }
+    vtkNew<vtkMRMLViewNode> newViewNode;
+    scene->AddNode(newViewNode.GetPointer());
+    viewNode = newViewNode.GetPointer();
+    }
+  vtkMRMLCameraNode* cameraNode =
+    findViewCameraNode(scene.GetPointer(), viewNode);
+  if (!cameraNode)
+    {
+    vtkNew<vtkMRMLCameraNode> newCameraNode;
+    newCameraNode->SetActiveTag(viewNode->GetID());
+    scene->AddNode(newCameraNode.GetPointer());
+    cameraNode = newCameraNode.GetPointer();
+    }
+
+  // Offscreen renderer, the camera node camera is moved along the path
+  vtkNew<vtkRenderer> renderer;
+  renderer->SetBackground(viewNode->GetBackgroundColor());
+  renderer->SetBackground2(viewNode->GetBackgroundColor2());
+  renderer->SetGradientBackground(true);
+  renderer->SetActiveCamera(cameraNode->GetCamera());
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetOffScreenRendering(1);
+  renderWindow->SetSize(tileWidth, tileHeight);
+  renderWindow->AddRenderer(renderer.GetPointer());
+  vtkNew<vtkSlicerCameraPathTileRenderer> tileRenderer;
+  tileRenderer->SetSize(width, height);
+  vtkNew<vtkImageData> frameImage;
+  // Frames are read into memory to be downscaled
+  const bool frameInMemory = tiled || !outputs.empty();
+
+  // The models are shown by their displayable manager, as in the 3D views
+  vtkMRMLThreeDViewDisplayableManagerFactory* factory =
+    vtkMRMLThreeDViewDisplayableManagerFactory::GetInstance();
+  factory->SetMRMLApplicationLogic(applicationLogic.GetPointer());
+  if (!factory->IsDisplayableManagerRegistered("vtkMRMLModelDisplayableManager"))
+    {
+    factory->RegisterDisplayableManager("vtkMRMLModelDisplayableManager");
+    }
+  vtkSmartPointer<vtkMRMLDisplayableManagerGroup> displayableManagerGroup;
+  displayableManagerGroup.TakeReference(
+    factory->InstantiateDisplayableManagers(renderer.GetPointer()));
+  if (!displayableManagerGroup)
+    {
+    std::cerr << "Could not create the displayable managers" << std::endl;
+    return EXIT_FAILURE;
+    }
+  displayableManagerGroup->SetMRMLDisplayableNode(viewNode);
+
+  // Frames of the range rendered by this shard
+  double tmin = cameraPathNode->GetMinimumT();
+  int numberOfFrames = vtkSlicerCameraPathLogic::GetNumberOfFrames(
+    tmin, cameraPathNode->GetMaximumT(), framerate);
+  if (lastFrame < 0 || lastFrame >= numberOfFrames)
+    {
+    lastFrame = numberOfFrames - 1;
+    }
+  if (!vtkSlicerCameraPathLogic::GetShardFrameRange(firstFrame, lastFrame,
+                                                    shardIndex - 1, shardCount,
+                                                    firstFrame, lastFrame))
+    {
+    std::cerr << "No frame to render" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Writers, frames are read back into their reused buffers
+  vtkNew<vtkSlicerCameraPathExporter> exporter;
+  vtkSmartPointer<vtkSlicerCameraPathVideoEncoder> encoder;
+  std::string path = vtksys::SystemTools::GetFilenamePath(outputFileName);
+  std::string baseName =
+    vtksys::SystemTools::GetFilenameWithoutLastExtension(outputFileName);
+  if (path.empty())
+    {
+    path = ".";
+    }
+  const std::string hash =
+    vtkSlicerCameraPathLogic::GetExportHash(cameraPathNode, viewNode);
+  if (video)
+    {
+    encoder = startEncoder(encoderSettings, outputFileName, framerate,
+                           width, height);
+    if (!encoder)
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  else if (!startExporter(exporter.GetPointer(), quality, path, baseName,
+                          firstFrame, lastFrame, hash, framerate,
+                          width, height))
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::vector<OutputWriter> outputWriters(outputs.size());
+  for (size_t o = 0; o < outputs.size(); ++o)
+    {
+    OutputWriter& writer = outputWriters[o];
+    writer.Output = outputs[o];
+    writer.BaseName = vtkSlicerCameraPathLogic::GetExportOutputBaseName(
+      baseName, writer.Output);
+    writer.Downscaler = vtkSmartPointer<vtkSlicerCameraPathDownscaler>::New();
+    writer.Image = vtkSmartPointer<vtkImageData>::New();
+    if (vtksys::SystemTools::LowerCase(writer.Output.Extension) == "png")
+      {
+      writer.Exporter = vtkSmartPointer<vtkSlicerCameraPathExporter>::New();
+      if (!startExporter(writer.Exporter, quality, path, writer.BaseName,
+                         firstFrame, lastFrame, hash, framerate,
+                         writer.Output.Width, writer.Output.Height))
+        {
+        return EXIT_FAILURE;
+        }
+      }
+    else
+      {
+      writer.Encoder = startEncoder(
+        encoderSettings,
+        path + "/" + writer.BaseName + "." + writer.Output.Extension,
+        framerate, writer.Output.Width, writer.Output.Height);
+      if (!writer.Encoder)
+        {
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // Render frame by frame
+  int numberOfShardFrames = lastFrame - firstFrame + 1;
+  std::cout << "Rendering frames " << firstFrame << " to " << lastFrame
+            << " of " << cameraPathNode->GetName() << " to " << outputFileName
+            << std::endl;
+  // Set when a frame could not be rendered or written, the export being
+  // aborted
+  bool failed = false;
+  for (int i = firstFrame; i <= lastFrame; ++i)
+    {
+    int count = i - firstFrame + 1;
+    std::string frameFileName =
+      vtkSlicerCameraPathLogic::GetFrameFileName(path, baseName, i, "png");
+    bool written = !video && !videoOutputs &&
+      exporter->IsFrameWritten(frameFileName.c_str());
+    for (size_t o = 0; o < outputWriters.size() && written; ++o)
+      {
+      written = outputWriters[o].Exporter->IsFrameWritten(
+        vtkSlicerCameraPathLogic::GetFrameFileName(
+          path, outputWriters[o].BaseName, i,
+          outputWriters[o].Output.Extension).c_str());
+      }
+    if (written)
+      {
+      std::cout << "Frame " << i << " (" << count << "/" << numberOfShardFrames
+                << ") already written" << std::endl;
+      continue;
+      }
+
+    double t = vtkSlicerCameraPathLogic::GetFrameTime(tmin, i, framerate);
+    CameraPose pose;
+    cameraPathNode->GetPoseAt(t, pose);
+    double distance = sqrt(vtkMath::Distance2BetweenPoints(pose.Position,
+                                                           pose.FocalPoint));
+    double clippingRange[2] = {0.1, distance*6};
+    vtkMRMLCameraPathNode::ApplyCameraPose(cameraNode, pose, clippingRange);
+
+    // Frames are read straight into a buffer of the writers, or stitched
+    // from their tiles or read into memory and copied into it
+    bool added = true;
+    if (tiled)
+      {
+      if (!tileRenderer->Render(renderWindow.GetPointer(),
+                                frameImage.GetPointer()))
+        {
+        std::cerr << "Could not render the tiles of frame " << i << std::endl;
+        failed = true;
+        break;
+        }
+      }
+    else
+      {
+      renderWindow->Render();
+      if (frameInMemory &&
+          !vtkSlicerCameraPathExporter::ReadPixels(renderWindow.GetPointer(),
+                                                   frameImage.GetPointer()))
+        {
+        std::cerr << "Could not read the pixels of frame " << i << std::endl;
+        failed = true;
+        break;
+        }
+      }
+    if (frameInMemory)
+      {
+      added = video ? encoder->AddFrame(frameImage.GetPointer()) :
+        exporter->AddFrame(frameImage.GetPointer(), frameFileName.c_str());
+      }
+    else
+      {
+      added = video ? encoder->AddFrame(renderWindow.GetPointer()) :
+        exporter->AddFrame(renderWindow.GetPointer(), frameFileName.c_str());
+      }
+    if (!added && !video)
+      {
+      std::cerr << "Could not write frame " << i << std::endl;
+      failed = true;
+      break;
+      }
+    bool stopped = !added;
+
+    // Each output is downscaled from the frame
+    for (size_t o = 0; o < outputWriters.size(); ++o)
+      {
+      OutputWriter& writer = outputWriters[o];
+      writer.Downscaler->Downscale(frameImage.GetPointer(), writer.Image,
+                                   writer.Output.Width, writer.Output.Height);
+      if (writer.Encoder)
+        {
+        stopped = !writer.Encoder->AddFrame(writer.Image) || stopped;
+        }
+      else if (!writer.Exporter->AddFrame(writer.Image,
+                 vtkSlicerCameraPathLogic::GetFrameFileName(
+                   path, writer.BaseName, i, writer.Output.Extension).c_str()))
+        {
+        std::cerr << "Could not write frame " << i << " of "
+                  << writer.BaseName << std::endl;
+        failed = true;
+        break;
+        }
+      }
+    if (failed)
+      {
+      break;
+      }
+    if (stopped)
+      {
+      std::cerr << "The encoder stopped" << std::endl;
+      failed = true;
+      break;
+      }
+
+    std::cout << "Frame " << i << " (" << count << "/" << numberOfShardFrames
+              << ", " << (100 * count) / numberOfShardFrames << "%)"
+              << std::endl;
+    }
+
+  int status = failed ? EXIT_FAILURE : EXIT_SUCCESS;
+  if (video)
+    {
+    if (!encoder->End())
+      {
+      std::cerr << "The video could not be encoded" << std::endl;
+      status = EXIT_FAILURE;
+      }
+    }
+  else if (!exporter->End())
+    {
+    std::cerr << exporter->GetNumberOfErrors()
+              << " screenshots could not be written" << std::endl;
+    status = EXIT_FAILURE;
+    }
+  for (size_t o = 0; o < outputWriters.size(); ++o)
+    {
+    OutputWriter& writer = outputWriters[o];
+    if (writer.Encoder && !writer.Encoder->End())
+      {
+      std::cerr << "The output " << writer.BaseName
+                << " could not be encoded" << std::endl;
+      status = EXIT_FAILURE;
+      }
+    else if (writer.Exporter && !writer.Exporter->End())
+      {
+      std::cerr << writer.Exporter->GetNumberOfErrors() << " screenshots of "
+                << writer.BaseName << " could not be written" << std::endl;
+      status = EXIT_FAILURE;
+      }
+    }
+
+  displayableManagerGroup->SetMRMLDisplayableNode(0);
+  return status;
+}
@@ -0,0 +1,149 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathCommandEncoder.h"
+#include "vtkSlicerCameraPathPipeWriter.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <sstream>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerCameraPathCommandEncoder);
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathCommandEncoder::vtkSlicerCameraPathCommandEncoder()
+{
+  this->Executable = 0;
+  this->Command = 0;
+  this->PipeWriter = vtkSlicerCameraPathPipeWriter::New();
+  this->SetExecutable("ffmpeg");
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathCommandEncoder::~vtkSlicerCameraPathCommandEncoder()
+{
+  this->End();
+  this->PipeWriter->Delete();
+  this->SetExecutable(0);
+  this->SetCommand(0);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathCommandEncoder::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Executable: "
+     << (this->Executable ? this->Executable : "(none)") << "\n";
+  os << indent << "Command: " << (this->Command ? this->Command : "(none)") << "\n";
+}
+
+//----------------------------------------------------------------------------
+std::string vtkSlicerCameraPathCommandEncoder::GetCodecCommand()
+{
+  std::stringstream command;
+  command << (this->Executable && this->Executable[0] != '\0' ?
+              this->Executable : "ffmpeg")
+          << " -y -loglevel error -f yuv4mpegpipe -i -";
+
+  switch (this->Codec)
+    {
+    case H265:
+      command << " -c:v libx265";
+      break;
+    case VP9:
+      command << " -c:v libvpx-vp9";
+      break;
+    case MPEG4:
+      command << " -c:v mpeg4";
+      break;
+    case H264:
+    default:
+      command << " -c:v libx264 -preset medium";
+      break;
+    }
+
+  if (this->ConstantRateFactor >= 0 && this->Codec == MPEG4)
+    {
+    // No constant rate factor, the quantizer is the closest setting
+    int quantizer = this->ConstantRateFactor / 2;
+    command << " -q:v " << (quantizer < 1 ? 1 : (quantizer > 31 ? 31 : quantizer));
+    }
+  else if (this->ConstantRateFactor >= 0)
+    {
+    command << " -crf " << this->ConstantRateFactor;
+    if (this->Codec == VP9)
+      {
+      // Constant quality instead of constrained quality
+      command << " -b:v 0";
+      }
+    }
+  else
+    {
+    command << " -b:v " << this->BitRate << "k";
+    }
+
+  if (this->GOPSize > 0)
+    {
+    command << " -g " << this->GOPSize;
+    }
+  if (this->NumberOfThreads > 0)
+    {
+    command << " -threads " << this->NumberOfThreads;
+    }
+  else if (this->Codec == VP9)
+    {
+    // libvpx is single threaded unless rows are encoded in parallel
+    command << " -row-mt 1";
+    }
+  command << " -pix_fmt yuv420p %o";
+  return command.str();
+}
+
+//----------------------------------------------------------------------------
+std::string vtkSlicerCameraPathCommandEncoder::GetCommandLine()
+{
+  this->PipeWriter->SetCommand(this->Command && this->Command[0] != '\0' ?
+                               this->Command : this->GetCodecCommand().c_str());
+  this->PipeWriter->SetFileName(this->FileName);
+  return this->PipeWriter->GetCommandLine();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathCommandEncoder::StartEncoder(int width, int height)
+{
+  this->PipeWriter->SetCommand(this->Command && this->Command[0] != '\0' ?
+                               this->Command : this->GetCodecCommand().c_str());
+  this->PipeWriter->SetFileName(this->FileName);
+  this->PipeWriter->SetRate(this->Rate);
+  return this->PipeWriter->Start(width, height);
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathCommandEncoder::EncodeFrame(vtkImageData* image)
+{
+  return this->PipeWriter->WriteFrame(image);
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathCommandEncoder::EndEncoder()
+{
+  return this->PipeWriter->End();
+}
@@ -0,0 +1,86 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// .NAME vtkSlicerCameraPathCommandEncoder - video encoder backend running ffmpeg
+// .SECTION Description
+// Frames are streamed by the encoder thread to an ffmpeg process through
+// vtkSlicerCameraPathPipeWriter. The command line is built from the codec,
+// rate control, GOP and thread settings, e.g.
+//   ffmpeg -y -loglevel error -f yuv4mpegpipe -i - -c:v libx264 -crf 23
+//          -g 60 -threads 8 -pix_fmt yuv420p %o
+// unless a custom Command is given. The codec runs with its own worker
+// threads in the ffmpeg process.
+
+#ifndef __vtkSlicerCameraPathCommandEncoder_h
+#define __vtkSlicerCameraPathCommandEncoder_h
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathVideoEncoder.h"
+
+#include "vtkSlicerCameraPathModuleLogicExport.h"
+
+// STD includes
+#include <string>
+
+class vtkSlicerCameraPathPipeWriter;
+
+/// \ingroup Slicer_QtModules_CameraPath
+class VTK_SLICER_CAMERAPATH_MODULE_LOGIC_EXPORT vtkSlicerCameraPathCommandEncoder :
+  public vtkSlicerCameraPathVideoEncoder
+{
+public:
+
+  static vtkSlicerCameraPathCommandEncoder *New();
+  vtkTypeMacro(vtkSlicerCameraPathCommandEncoder, vtkSlicerCameraPathVideoEncoder);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// ffmpeg executable, "ffmpeg" by default, searched in the PATH
+  vtkSetStringMacro(Executable);
+  vtkGetStringMacro(Executable);
+
+  /// Custom encoder command line reading a YUV4MPEG2 stream on its standard
+  /// input, "%o" being replaced by FileName. The codec settings are ignored
+  /// if set. Empty by default.
+  vtkSetStringMacro(Command);
+  vtkGetStringMacro(Command);
+
+  /// Command run by Start(), with the file name substituted
+  std::string GetCommandLine();
+
+protected:
+  vtkSlicerCameraPathCommandEncoder();
+  virtual ~vtkSlicerCameraPathCommandEncoder();
+
+  /// Command line built from the codec settings, with "%o" for the file name
+  std::string GetCodecCommand();
+
+  virtual bool StartEncoder(int width, int height);
+  virtual bool EncodeFrame(vtkImageData* image);
+  virtual bool EndEncoder();
+
+  char* Executable;
+  char* Command;
+
+  vtkSlicerCameraPathPipeWriter* PipeWriter;
+
+private:
+
+  vtkSlicerCameraPathCommandEncoder(const vtkSlicerCameraPathCommandEncoder&); // Not implemented
+  void operator=(const vtkSlicerCameraPathCommandEncoder&); // Not implemented
+};
+
+#endif
@@ -0,0 +1,304 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathDownscaler.h"
+#include "vtkSlicerCameraPathExporter.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Weights of the source pixels covered by each target pixel along an axis,
+// in 16 bit fixed point summing to 65536 for each target pixel
+struct AxisWeights
+{
+  int SourceSize;
+  int Size;
+  /// First source pixel and number of source pixels of each target pixel
+  std::vector<int> First;
+  std::vector<int> Count;
+  /// Weights of the source pixels, Count[i] from Offset[i]
+  std::vector<int> Offset;
+  std::vector<unsigned int> Weights;
+
+  AxisWeights() : SourceSize(0), Size(0) {}
+};
+
+//----------------------------------------------------------------------------
+void computeWeights(int sourceSize, int size, AxisWeights& weights)
+{
+  if (weights.SourceSize == sourceSize && weights.Size == size)
+    {
+    return;
+    }
+  weights.SourceSize = sourceSize;
+  weights.Size = size;
+  weights.First.resize(size);
+  weights.Count.resize(size);
+  weights.Offset.resize(size);
+  weights.Weights.clear();
+
+  const double scale = static_cast<double>(sourceSize) / size;
+  for (int i = 0; i < size; ++i)
+    {
+    const double start = i * scale;
+    const double end = (i + 1) * scale;
+    int first = static_cast<int>(floor(start));
+    int last = static_cast<int>(ceil(end)) - 1;
+    last = (last < sourceSize ? last : sourceSize - 1);
+    weights.First[i] = first;
+    weights.Count[i] = last - first + 1;
+    weights.Offset[i] = static_cast<int>(weights.Weights.size());
+
+    // Area of each source pixel covered, the last weight taking the
+    // rounding errors so that the weights sum to 1
+    unsigned int sum = 0;
+    for (int j = first; j < last; ++j)
+      {
+      double coverage = (j + 1 < end ? j + 1 : end) - (j > start ? j : start);
+      unsigned int weight =
+        static_cast<unsigned int>(coverage / scale * 65536.0 + 0.5);
+      weight = (sum + weight > 65536 ? 65536 - sum : weight);
+      weights.Weights.push_back(weight);
+      sum += weight;
+      }
+    weights.Weights.push_back(65536 - sum);
+    }
+}
+
+// Number of target rows resampled together: their source columns are
+// stored transposed in a buffer that stays in the cache
+const int BLOCK_SIZE = 16;
+
+//----------------------------------------------------------------------------
+// Accumulate a source row with its vertical weight, vectorized by the
+// compiler: the sums stay below 255 * 65536 < 2^24
+void accumulateRow(const unsigned char* row, unsigned int weight, size_t size,
+                   unsigned int* sums)
+{
+  for (size_t i = 0; i < size; ++i)
+    {
+    sums[i] += row[i] * weight;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Store the vertical sums of row \a j of a block, scaled by 256, in the
+// columns of the block
+template <int Components>
+void storeColumns(const unsigned int* sums, int sourceWidth, int j,
+                  unsigned short* columns)
+{
+  const size_t columnSize = BLOCK_SIZE * Components;
+  for (int x = 0; x < sourceWidth; ++x)
+    {
+    for (int c = 0; c < Components; ++c)
+      {
+      columns[x * columnSize + j * Components + c] =
+        static_cast<unsigned short>((sums[x * Components + c] + 128) >> 8);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Accumulate a source column of a block with its horizontal weight,
+// vectorized by the compiler: the sums stay below 255 * 256 * 65536 < 2^32
+void accumulateColumn(const unsigned short* column, unsigned int weight,
+                      size_t size, unsigned int* sums)
+{
+  for (size_t i = 0; i < size; ++i)
+    {
+    sums[i] += column[i] * weight;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Store the sums of target column \a x of a block of \a rows rows
+template <int Components>
+void storeColumn(const unsigned int* sums, int rows, int x, size_t rowSize,
+                 unsigned char* target)
+{
+  for (int y = 0; y < rows; ++y)
+    {
+    for (int c = 0; c < Components; ++c)
+      {
+      target[y * rowSize + x * Components + c] = static_cast<unsigned char>(
+        (sums[y * Components + c] + (1u << 23)) >> 24);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Both passes accumulate whole rows or columns of pixels with the weight of
+// each tap, so that the loops over contiguous pixels vectorize: the source
+// rows of a block of target rows are resampled vertically and stored
+// transposed, then their columns are resampled horizontally
+template <int Components>
+void downscale(const unsigned char* source, int sourceWidth,
+               const AxisWeights& horizontal, const AxisWeights& vertical,
+               std::vector<unsigned short>& columnBuffer,
+               std::vector<unsigned int>& sumBuffer, unsigned char* target)
+{
+  const size_t rowSize = static_cast<size_t>(horizontal.Size) * Components;
+  const size_t sourceRowSize = static_cast<size_t>(sourceWidth) * Components;
+  const size_t columnSize = BLOCK_SIZE * Components;
+  columnBuffer.resize(sourceWidth * columnSize);
+  sumBuffer.resize(std::max(sourceRowSize, columnSize));
+  unsigned short* columns = &columnBuffer[0];
+  unsigned int* sums = &sumBuffer[0];
+
+  for (int y0 = 0; y0 < vertical.Size; y0 += BLOCK_SIZE)
+    {
+    const int rows = std::min(BLOCK_SIZE, vertical.Size - y0);
+    for (int j = 0; j < rows; ++j)
+      {
+      const int y = y0 + j;
+      std::fill(sums, sums + sourceRowSize, 0u);
+      const unsigned int* weight = &vertical.Weights[vertical.Offset[y]];
+      for (int k = 0; k < vertical.Count[y]; ++k)
+        {
+        accumulateRow(
+          source + static_cast<size_t>(vertical.First[y] + k) * sourceRowSize,
+          weight[k], sourceRowSize, sums);
+        }
+      storeColumns<Components>(sums, sourceWidth, j, columns);
+      }
+
+    // Rows of the last block past the target are left out of the sums
+    const size_t blockColumnSize = static_cast<size_t>(rows) * Components;
+    for (int x = 0; x < horizontal.Size; ++x)
+      {
+      std::fill(sums, sums + blockColumnSize, 0u);
+      const unsigned int* weight = &horizontal.Weights[horizontal.Offset[x]];
+      for (int k = 0; k < horizontal.Count[x]; ++k)
+        {
+        accumulateColumn(
+          columns + static_cast<size_t>(horizontal.First[x] + k) * columnSize,
+          weight[k], blockColumnSize, sums);
+        }
+      storeColumn<Components>(sums, rows, x, rowSize,
+                              target + static_cast<size_t>(y0) * rowSize);
+      }
+    }
+}
+
+}
+
+//----------------------------------------------------------------------------
+class vtkSlicerCameraPathDownscaler::vtkInternal
+{
+public:
+  AxisWeights Horizontal;
+  AxisWeights Vertical;
+  /// Source columns of a block of target rows and weighted sums, reused
+  std::vector<unsigned short> Columns;
+  std::vector<unsigned int> Sums;
+};
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerCameraPathDownscaler);
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathDownscaler::vtkSlicerCameraPathDownscaler()
+{
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathDownscaler::~vtkSlicerCameraPathDownscaler()
+{
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathDownscaler::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathDownscaler::Downscale(vtkImageData* source,
+                                              vtkImageData* target,
+                                              int width, int height)
+{
+  if (!source || !target || !source->GetPointData()->GetScalars() ||
+      source->GetScalarType() != VTK_UNSIGNED_CHAR)
+    {
+    vtkErrorMacro("Downscale: invalid image");
+    return false;
+    }
+  int sourceDimensions[3];
+  source->GetDimensions(sourceDimensions);
+  const int components = source->GetNumberOfScalarComponents();
+  if (width <= 0 || height <= 0 ||
+      width > sourceDimensions[0] || height > sourceDimensions[1])
+    {
+    vtkErrorMacro("Downscale: " << width << "x" << height << " is larger than "
+                  << sourceDimensions[0] << "x" << sourceDimensions[1]);
+    return false;
+    }
+
+  const int dimensions[3] = {width, height, 1};
+  vtkSlicerCameraPathExporter::AllocatePixels(target, dimensions, components);
+  bool success = this->Downscale(
+    static_cast<unsigned char*>(source->GetScalarPointer()),
+    sourceDimensions[0], sourceDimensions[1], components,
+    static_cast<unsigned char*>(target->GetScalarPointer()), width, height);
+  target->Modified();
+  return success;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathDownscaler::Downscale(const unsigned char* source,
+                                              int sourceWidth, int sourceHeight,
+                                              int components,
+                                              unsigned char* target,
+                                              int width, int height)
+{
+  if (components != 3 && components != 4)
+    {
+    vtkErrorMacro("Downscale: only RGB and RGBA images are supported");
+    return false;
+    }
+  AxisWeights& horizontal = this->Internal->Horizontal;
+  AxisWeights& vertical = this->Internal->Vertical;
+  computeWeights(sourceWidth, width, horizontal);
+  computeWeights(sourceHeight, height, vertical);
+
+  if (components == 4)
+    {
+    downscale<4>(source, sourceWidth, horizontal, vertical,
+                 this->Internal->Columns, this->Internal->Sums, target);
+    }
+  else
+    {
+    downscale<3>(source, sourceWidth, horizontal, vertical,
+                 this->Internal->Columns, this->Internal->Sums, target);
+    }
+  return true;
+}
@@ -0,0 +1,76 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// .NAME vtkSlicerCameraPathDownscaler - area averaging downscale of frames
+// .SECTION Description
+// Exported frames are rendered once at the largest output size and
+// downscaled for the smaller outputs. Each target pixel is the average of
+// the source pixels it covers, weighted by the covered area, which does not
+// alias like sampling does. The weights are computed in fixed point once
+// per size and reused for each frame. Source rows are accumulated with
+// their vertical weight, and the resampled rows of a block of target rows
+// are transposed so that their columns are accumulated with their
+// horizontal weight: both passes are loops over contiguous pixels that the
+// compiler vectorizes.
+
+#ifndef __vtkSlicerCameraPathDownscaler_h
+#define __vtkSlicerCameraPathDownscaler_h
+
+// VTK includes
+#include <vtkObject.h>
+
+#include "vtkSlicerCameraPathModuleLogicExport.h"
+
+class vtkImageData;
+
+/// \ingroup Slicer_QtModules_CameraPath
+class VTK_SLICER_CAMERAPATH_MODULE_LOGIC_EXPORT vtkSlicerCameraPathDownscaler :
+  public vtkObject
+{
+public:
+
+  static vtkSlicerCameraPathDownscaler *New();
+  vtkTypeMacro(vtkSlicerCameraPathDownscaler, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Downscale the unsigned char \a source into \a target of \a width by
+  /// \a height pixels, reusing the scalars of \a target if the size did not
+  /// change. The target size must not exceed the source size.
+  bool Downscale(vtkImageData* source, vtkImageData* target,
+                 int width, int height);
+
+  /// Downscale the rows of \a source, of \a components bytes per pixel, to
+  /// \a target. Used by Downscale(), the weights being cached between calls
+  /// with the same sizes.
+  bool Downscale(const unsigned char* source, int sourceWidth,
+                 int sourceHeight, int components, unsigned char* target,
+                 int width, int height);
+
+protected:
+  vtkSlicerCameraPathDownscaler();
+  virtual ~vtkSlicerCameraPathDownscaler();
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+
+  vtkSlicerCameraPathDownscaler(const vtkSlicerCameraPathDownscaler&); // Not implemented
+  void operator=(const vtkSlicerCameraPathDownscaler&); // Not implemented
+};
+
+#endif
@@ -0,0 +1,580 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathExporter.h"
+
+// VTK includes
+#include <vtkConditionVariable.h>
+#include <vtkErrorCode.h>
+#include <vtkImageData.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPNGWriter.h>
+#include <vtkPointData.h>
+#include <vtkRenderWindow.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtkUnsignedCharArray.h>
+
+// STD includes
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Pooled buffer of a frame, owned by the calling thread while it is free or
+// filled, then by a writer thread once queued
+struct Frame
+{
+  vtkSmartPointer<vtkImageData> Image;
+  std::string FileName;
+};
+
+//----------------------------------------------------------------------------
+const char* MANIFEST_HEADER = "# CameraPath export manifest";
+
+}
+
+//----------------------------------------------------------------------------
+class vtkSlicerCameraPathExporter::vtkInternal
+{
+public:
+  vtkInternal();
+  ~vtkInternal();
+
+  static VTK_THREAD_RETURN_TYPE WriteFrames(void* arg);
+
+  /// Take a free buffer, or allocate one until the queue is full, else wait
+  /// for a buffer to be freed by the writers
+  Frame* AcquireFrame(size_t queueSize);
+  void QueueFrame(Frame* frame, const char* fileName);
+
+  vtkSimpleMutexLock Lock;
+  vtkConditionVariable FrameQueued;
+  vtkConditionVariable FrameWritten;
+
+  std::vector<Frame*> Frames;
+  std::vector<Frame*> FreeFrames;
+  std::deque<Frame*> QueuedFrames;
+  bool Stopping;
+
+  int CompressionLevel;
+  int NumberOfFramesWritten;
+  int NumberOfErrors;
+  double WriteTime;
+
+  vtkNew<vtkMultiThreader> Threader;
+  std::vector<int> ThreadIds;
+
+  /// Settings given to SetExportSettings(), and "settings" line of the
+  /// manifest which also has the compression level
+  std::string ExportSettings;
+  std::string Settings;
+  /// Hash of the frames recorded in the manifest, by file name
+  std::map<std::string, std::string> WrittenFrames;
+  /// Appended by the writer threads, with the lock held
+  std::ofstream Manifest;
+};
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathExporter::vtkInternal::vtkInternal()
+  : Stopping(false)
+  , CompressionLevel(5)
+  , NumberOfFramesWritten(0)
+  , NumberOfErrors(0)
+  , WriteTime(0.0)
+{
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathExporter::vtkInternal::~vtkInternal()
+{
+  for (size_t i = 0; i < this->Frames.size(); ++i)
+    {
+    delete this->Frames[i];
+    }
+}
+
+//----------------------------------------------------------------------------
+Frame* vtkSlicerCameraPathExporter::vtkInternal::AcquireFrame(size_t queueSize)
+{
+  this->Lock.Lock();
+  while (this->FreeFrames.empty() && this->Frames.size() >= queueSize)
+    {
+    this->FrameWritten.Wait(this->Lock);
+    }
+  Frame* frame = 0;
+  if (!this->FreeFrames.empty())
+    {
+    frame = this->FreeFrames.back();
+    this->FreeFrames.pop_back();
+    }
+  else
+    {
+    frame = new Frame;
+    frame->Image = vtkSmartPointer<vtkImageData>::New();
+    this->Frames.push_back(frame);
+    }
+  this->Lock.Unlock();
+  return frame;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathExporter::vtkInternal::QueueFrame(Frame* frame,
+                                                          const char* fileName)
+{
+  frame->FileName = fileName;
+  this->Lock.Lock();
+  this->QueuedFrames.push_back(frame);
+  this->FrameQueued.Signal();
+  this->Lock.Unlock();
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkSlicerCameraPathExporter::vtkInternal::WriteFrames(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkInternal* internal = static_cast<vtkInternal*>(info->UserData);
+
+  // The PNG is encoded in memory so that its hash is computed without
+  // reading the file back
+  vtkNew<vtkPNGWriter> writer;
+  writer->SetCompressionLevel(internal->CompressionLevel);
+  writer->WriteToMemoryOn();
+
+  while (true)
+    {
+    internal->Lock.Lock();
+    while (internal->QueuedFrames.empty() && !internal->Stopping)
+      {
+      internal->FrameQueued.Wait(internal->Lock);
+      }
+    if (internal->QueuedFrames.empty())
+      {
+      internal->Lock.Unlock();
+      break;
+      }
+    Frame* frame = internal->QueuedFrames.front();
+    internal->QueuedFrames.pop_front();
+    internal->Lock.Unlock();
+
+    double start = vtkTimerLog::GetUniversalTime();
+#if (VTK_MAJOR_VERSION <= 5)
+    writer->SetInput(frame->Image);
+#else
+    writer->SetInputData(frame->Image);
+#endif
+    writer->Write();
+    vtkUnsignedCharArray* result = writer->GetResult();
+    bool success = writer->GetErrorCode() == vtkErrorCode::NoError && result;
+    std::string hash;
+    if (success)
+      {
+      size_t size = static_cast<size_t>(result->GetNumberOfTuples()) *
+        result->GetNumberOfComponents();
+      std::ofstream file(frame->FileName.c_str(),
+                         std::ios::out | std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char*>(result->GetPointer(0)), size);
+      file.close();
+      success = !file.fail();
+      hash = vtkSlicerCameraPathExporter::ComputeHash(result->GetPointer(0), size);
+      }
+#if (VTK_MAJOR_VERSION <= 5)
+    writer->SetInput(0);
+#else
+    writer->SetInputData(0);
+#endif
+    double writeTime = vtkTimerLog::GetUniversalTime() - start;
+
+    internal->Lock.Lock();
+    internal->FreeFrames.push_back(frame);
+    internal->WriteTime += writeTime;
+    if (success)
+      {
+      ++internal->NumberOfFramesWritten;
+      if (internal->Manifest.is_open())
+        {
+        internal->Manifest << "frame " << hash << " " << frame->FileName
+                           << std::endl;
+        }
+      }
+    else
+      {
+      ++internal->NumberOfErrors;
+      }
+    internal->FrameWritten.Signal();
+    internal->Lock.Unlock();
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerCameraPathExporter);
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathExporter::vtkSlicerCameraPathExporter()
+{
+  this->NumberOfThreads = 0;
+  this->QueueSize = 0;
+  this->CompressionLevel = 5;
+  this->ManifestFileName = 0;
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathExporter::~vtkSlicerCameraPathExporter()
+{
+  this->End();
+  this->SetManifestFileName(0);
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathExporter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "QueueSize: " << this->QueueSize << "\n";
+  os << indent << "CompressionLevel: " << this->CompressionLevel << "\n";
+  os << indent << "ManifestFileName: "
+     << (this->ManifestFileName ? this->ManifestFileName : "(none)") << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathExporter::SetExportSettings(const char* exportHash,
+                                                    int width, int height,
+                                                    double framerate)
+{
+  std::stringstream ss;
+  ss << "settings " << (exportHash ? exportHash : "") << " "
+     << width << " " << height << " " << framerate;
+  this->Internal->ExportSettings = ss.str();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathExporter::Start()
+{
+  if (!this->Internal->ThreadIds.empty())
+    {
+    vtkErrorMacro("Start: the exporter is already started");
+    return false;
+    }
+
+  this->Internal->Stopping = false;
+  this->Internal->CompressionLevel = this->CompressionLevel;
+  this->Internal->NumberOfFramesWritten = 0;
+  this->Internal->NumberOfErrors = 0;
+  this->Internal->WriteTime = 0.0;
+  this->Internal->WrittenFrames.clear();
+
+  if (this->ManifestFileName && this->ManifestFileName[0] != '\0')
+    {
+    // Files written at another compression level differ
+    std::stringstream settings;
+    settings << this->Internal->ExportSettings << " " << this->CompressionLevel;
+    this->Internal->Settings = settings.str();
+
+    // Keep the frames of a previous export with the same settings
+    std::ifstream previous(this->ManifestFileName);
+    std::string line;
+    bool sameSettings = false;
+    while (std::getline(previous, line))
+      {
+      if (line == this->Internal->Settings)
+        {
+        sameSettings = true;
+        }
+      else if (sameSettings && line.compare(0, 6, "frame ") == 0)
+        {
+        size_t separator = line.find(' ', 6);
+        if (separator != std::string::npos)
+          {
+          this->Internal->WrittenFrames[line.substr(separator + 1)] =
+            line.substr(6, separator - 6);
+          }
+        }
+      }
+    previous.close();
+
+    this->Internal->Manifest.open(this->ManifestFileName,
+                                  std::ios::out | std::ios::trunc);
+    if (!this->Internal->Manifest.is_open())
+      {
+      vtkErrorMacro("Start: unable to write manifest " << this->ManifestFileName);
+      return false;
+      }
+    this->Internal->Manifest << MANIFEST_HEADER << std::endl
+                             << this->Internal->Settings << std::endl;
+    std::map<std::string, std::string>::const_iterator it;
+    for (it = this->Internal->WrittenFrames.begin();
+         it != this->Internal->WrittenFrames.end(); ++it)
+      {
+      this->Internal->Manifest << "frame " << it->second << " " << it->first
+                               << std::endl;
+      }
+    }
+
+  int numberOfThreads = this->NumberOfThreads > 0 ?
+    this->NumberOfThreads : vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  for (int i = 0; i < numberOfThreads; ++i)
+    {
+    int threadId = this->Internal->Threader->SpawnThread(
+      vtkInternal::WriteFrames, this->Internal);
+    if (threadId < 0)
+      {
+      break;
+      }
+    this->Internal->ThreadIds.push_back(threadId);
+    }
+  if (this->Internal->ThreadIds.empty())
+    {
+    vtkErrorMacro("Start: unable to start the writer threads");
+    this->Internal->Manifest.close();
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathExporter::IsFrameWritten(const char* fileName)
+{
+  if (!fileName)
+    {
+    return false;
+    }
+  std::map<std::string, std::string>::const_iterator it =
+    this->Internal->WrittenFrames.find(fileName);
+  if (it == this->Internal->WrittenFrames.end())
+    {
+    return false;
+    }
+
+  // Check that the file was not truncated or modified since
+  std::ifstream file(fileName, std::ios::in | std::ios::binary);
+  if (!file.is_open())
+    {
+    return false;
+    }
+  std::vector<char> content((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+  return !content.empty() &&
+    ComputeHash(&content[0], content.size()) == it->second;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathExporter::AddFrame(vtkImageData* image, const char* fileName)
+{
+  if (!image || !fileName || !image->GetPointData()->GetScalars() ||
+      image->GetScalarType() != VTK_UNSIGNED_CHAR)
+    {
+    vtkErrorMacro("AddFrame: invalid frame");
+    return false;
+    }
+  if (this->Internal->ThreadIds.empty())
+    {
+    vtkErrorMacro("AddFrame: the exporter is not started");
+    return false;
+    }
+
+  size_t queueSize = this->QueueSize > 0 ?
+    this->QueueSize : 2 * this->Internal->ThreadIds.size();
+  Frame* frame = this->Internal->AcquireFrame(queueSize);
+
+  // The buffer is not shared until it is queued
+  CopyPixels(image, frame->Image);
+  this->Internal->QueueFrame(frame, fileName);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathExporter::AddFrame(vtkRenderWindow* renderWindow,
+                                           const char* fileName)
+{
+  if (!renderWindow || !fileName)
+    {
+    vtkErrorMacro("AddFrame: invalid frame");
+    return false;
+    }
+  if (this->Internal->ThreadIds.empty())
+    {
+    vtkErrorMacro("AddFrame: the exporter is not started");
+    return false;
+    }
+
+  size_t queueSize = this->QueueSize > 0 ?
+    this->QueueSize : 2 * this->Internal->ThreadIds.size();
+  Frame* frame = this->Internal->AcquireFrame(queueSize);
+
+  if (!ReadPixels(renderWindow, frame->Image))
+    {
+    // Give the buffer back
+    this->Internal->Lock.Lock();
+    this->Internal->FreeFrames.push_back(frame);
+    this->Internal->Lock.Unlock();
+    vtkErrorMacro("AddFrame: unable to read the pixels of the render window");
+    return false;
+    }
+  this->Internal->QueueFrame(frame, fileName);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathExporter::AllocatePixels(vtkImageData* target,
+                                                 const int dimensions[3],
+                                                 int components)
+{
+  int targetDimensions[3];
+  target->GetDimensions(targetDimensions);
+  if (vtkUnsignedCharArray::SafeDownCast(target->GetPointData()->GetScalars()) &&
+      targetDimensions[0] == dimensions[0] &&
+      targetDimensions[1] == dimensions[1] &&
+      targetDimensions[2] == dimensions[2] &&
+      target->GetNumberOfScalarComponents() == components)
+    {
+    return;
+    }
+  target->SetDimensions(const_cast<int*>(dimensions));
+#if (VTK_MAJOR_VERSION <= 5)
+  target->SetScalarTypeToUnsignedChar();
+  target->SetNumberOfScalarComponents(components);
+  target->AllocateScalars();
+#else
+  target->AllocateScalars(VTK_UNSIGNED_CHAR, components);
+#endif
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathExporter::CopyPixels(vtkImageData* source,
+                                             vtkImageData* target)
+{
+  int dimensions[3];
+  source->GetDimensions(dimensions);
+  int components = source->GetNumberOfScalarComponents();
+  AllocatePixels(target, dimensions, components);
+
+  size_t size = static_cast<size_t>(dimensions[0]) * dimensions[1] *
+    dimensions[2] * components;
+  memcpy(target->GetScalarPointer(), source->GetScalarPointer(), size);
+  target->Modified();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathExporter::ReadPixels(vtkRenderWindow* renderWindow,
+                                             vtkImageData* image)
+{
+  if (!renderWindow || !image)
+    {
+    return false;
+    }
+  int* size = renderWindow->GetSize();
+  int dimensions[3] = {size[0], size[1], 1};
+  if (dimensions[0] <= 0 || dimensions[1] <= 0)
+    {
+    return false;
+    }
+  AllocatePixels(image, dimensions, 3);
+
+  // Read the front buffer, where the last render was swapped, like
+  // vtkWindowToImageFilter does by default
+  vtkUnsignedCharArray* pixels =
+    vtkUnsignedCharArray::SafeDownCast(image->GetPointData()->GetScalars());
+  if (renderWindow->GetPixelData(0, 0, dimensions[0] - 1, dimensions[1] - 1,
+                                 1, pixels) == VTK_ERROR)
+    {
+    return false;
+    }
+  image->Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathExporter::End()
+{
+  if (this->Internal->ThreadIds.empty())
+    {
+    return this->Internal->NumberOfErrors == 0;
+    }
+
+  // Writers exit once the queue is empty
+  this->Internal->Lock.Lock();
+  this->Internal->Stopping = true;
+  this->Internal->FrameQueued.Broadcast();
+  this->Internal->Lock.Unlock();
+
+  for (size_t i = 0; i < this->Internal->ThreadIds.size(); ++i)
+    {
+    this->Internal->Threader->TerminateThread(this->Internal->ThreadIds[i]);
+    }
+  this->Internal->ThreadIds.clear();
+  this->Internal->Manifest.close();
+  return this->Internal->NumberOfErrors == 0;
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCameraPathExporter::GetNumberOfFramesWritten()
+{
+  this->Internal->Lock.Lock();
+  int numberOfFramesWritten = this->Internal->NumberOfFramesWritten;
+  this->Internal->Lock.Unlock();
+  return numberOfFramesWritten;
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCameraPathExporter::GetNumberOfErrors()
+{
+  this->Internal->Lock.Lock();
+  int numberOfErrors = this->Internal->NumberOfErrors;
+  this->Internal->Lock.Unlock();
+  return numberOfErrors;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerCameraPathExporter::GetWriteTime()
+{
+  this->Internal->Lock.Lock();
+  double writeTime = this->Internal->WriteTime;
+  this->Internal->Lock.Unlock();
+  return writeTime;
+}
+
+//----------------------------------------------------------------------------
+std::string vtkSlicerCameraPathExporter::ComputeHash(const void* data, size_t size)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  vtkTypeUInt64 hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < size; ++i)
+    {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+    }
+  std::stringstream ss;
+  ss << std::hex << std::setfill('0') << std::setw(16) << hash;
+  return ss.str();
+}
@@ -0,0 +1,141 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// .NAME vtkSlicerCameraPathExporter - pipelined writing of exported frames
+// .SECTION Description
+// Frames rendered and read back on the calling thread are copied into
+// pooled image buffers and queued. A pool of writer threads encodes them
+// as PNG and writes them, so that rendering the next frames overlaps the
+// compression of the previous ones. The queue is bounded: AddFrame() waits
+// for a free buffer when the writers fall behind.
+// The frames written can be recorded in a manifest, so that an interrupted
+// export only renders the missing frames when it is started again.
+
+#ifndef __vtkSlicerCameraPathExporter_h
+#define __vtkSlicerCameraPathExporter_h
+
+// VTK includes
+#include <vtkObject.h>
+
+#include "vtkSlicerCameraPathModuleLogicExport.h"
+
+// STD includes
+#include <string>
+
+class vtkImageData;
+class vtkRenderWindow;
+
+/// \ingroup Slicer_QtModules_CameraPath
+class VTK_SLICER_CAMERAPATH_MODULE_LOGIC_EXPORT vtkSlicerCameraPathExporter :
+  public vtkObject
+{
+public:
+
+  static vtkSlicerCameraPathExporter *New();
+  vtkTypeMacro(vtkSlicerCameraPathExporter, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Number of writer threads. 0 (default) uses the number of processors.
+  vtkSetMacro(NumberOfThreads, int);
+  vtkGetMacro(NumberOfThreads, int);
+
+  /// Maximum number of frames buffered, waiting or being written.
+  /// 0 (default) uses twice the number of writer threads.
+  vtkSetMacro(QueueSize, int);
+  vtkGetMacro(QueueSize, int);
+
+  /// PNG compression level, from 0 (none) to 9 (best), 5 by default
+  vtkSetClampMacro(CompressionLevel, int, 0, 9);
+  vtkGetMacro(CompressionLevel, int);
+
+  /// File recording the export settings and the frames written with the
+  /// hash of their content, so that an interrupted export can be resumed.
+  /// No manifest is written if empty (default).
+  vtkSetStringMacro(ManifestFileName);
+  vtkGetStringMacro(ManifestFileName);
+
+  /// Settings identifying the export in the manifest, along with the
+  /// compression level. Frames recorded with other settings are not resumed.
+  /// \sa vtkSlicerCameraPathLogic::GetExportHash()
+  void SetExportSettings(const char* exportHash, int width, int height,
+                         double framerate);
+
+  /// Start the writer threads. If a manifest with the same settings exists,
+  /// its frames are kept for IsFrameWritten().
+  bool Start();
+
+  /// Return true if \a fileName is recorded in the manifest and its content
+  /// still matches the recorded hash, so that the frame need not be
+  /// rendered again. Must be called after Start().
+  bool IsFrameWritten(const char* fileName);
+
+  /// Copy the pixels of \a image and queue them to be written to
+  /// \a fileName. Wait for a free buffer if the queue is full.
+  /// \a image must have unsigned char scalars.
+  bool AddFrame(vtkImageData* image, const char* fileName);
+
+  /// Read the pixels of the last render of \a renderWindow straight into a
+  /// pooled buffer and queue them to be written to \a fileName, without
+  /// going through an intermediate image. Wait for a free buffer if the
+  /// queue is full. Must be called from the thread rendering the window.
+  bool AddFrame(vtkRenderWindow* renderWindow, const char* fileName);
+
+  /// Wait for the queued frames to be written and stop the writer threads.
+  /// Return false if a frame could not be written.
+  bool End();
+
+  int GetNumberOfFramesWritten();
+  int GetNumberOfErrors();
+
+  /// Time spent by all the writer threads encoding and writing, in seconds
+  double GetWriteTime();
+
+  /// Allocate unsigned char scalars of \a dimensions and \a components in
+  /// \a target, unless it already has scalars of this size to reuse
+  static void AllocatePixels(vtkImageData* target, const int dimensions[3],
+                             int components);
+
+  /// Copy the unsigned char pixels of \a source into \a target, reusing
+  /// the scalars of \a target if the image size did not change
+  static void CopyPixels(vtkImageData* source, vtkImageData* target);
+
+  /// Read the RGB pixels of the last render of \a renderWindow into
+  /// \a image, reusing its scalars if the window size did not change
+  static bool ReadPixels(vtkRenderWindow* renderWindow, vtkImageData* image);
+
+  /// 64-bit FNV-1a hash of \a data, as 16 hexadecimal digits
+  static std::string ComputeHash(const void* data, size_t size);
+
+protected:
+  vtkSlicerCameraPathExporter();
+  virtual ~vtkSlicerCameraPathExporter();
+
+  int NumberOfThreads;
+  int QueueSize;
+  int CompressionLevel;
+  char* ManifestFileName;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+
+  vtkSlicerCameraPathExporter(const vtkSlicerCameraPathExporter&); // Not implemented
+  void operator=(const vtkSlicerCameraPathExporter&); // Not implemented
+};
+
+#endif
@@ -0,0 +1,118 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathFFMPEGEncoder.h"
+
+// VTK includes
+#include <vtkErrorCode.h>
+#include <vtkFFMPEGWriter.h>
+#include <vtkImageData.h>
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <cstring>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerCameraPathFFMPEGEncoder);
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathFFMPEGEncoder::vtkSlicerCameraPathFFMPEGEncoder()
+{
+  this->Codec = MPEG4;
+  this->Writer = vtkFFMPEGWriter::New();
+  this->FirstFrame = vtkImageData::New();
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathFFMPEGEncoder::~vtkSlicerCameraPathFFMPEGEncoder()
+{
+  this->End();
+  this->Writer->Delete();
+  this->FirstFrame->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathFFMPEGEncoder::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Quality: " << GetQuality(this->ConstantRateFactor) << "\n";
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCameraPathFFMPEGEncoder::GetQuality(int constantRateFactor)
+{
+  if (constantRateFactor <= 18)
+    {
+    return 2;
+    }
+  return constantRateFactor <= 28 ? 1 : 0;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathFFMPEGEncoder::StartEncoder(int width, int height)
+{
+  if (this->Codec != MPEG4)
+    {
+    vtkWarningMacro("StartEncoder: " << GetCodecName(this->Codec)
+                    << " is not available, encoding MPEG-4");
+    }
+
+  // The writer takes the size of the video from its input when starting
+  this->FirstFrame->SetDimensions(width, height, 1);
+#if (VTK_MAJOR_VERSION <= 5)
+  this->FirstFrame->SetScalarTypeToUnsignedChar();
+  this->FirstFrame->SetNumberOfScalarComponents(3);
+  this->FirstFrame->AllocateScalars();
+  this->Writer->SetInput(this->FirstFrame);
+#else
+  this->FirstFrame->AllocateScalars(VTK_UNSIGNED_CHAR, 3);
+  this->Writer->SetInputData(this->FirstFrame);
+#endif
+  memset(this->FirstFrame->GetScalarPointer(), 0,
+         static_cast<size_t>(width) * height * 3);
+
+  this->Writer->SetQuality(GetQuality(this->ConstantRateFactor));
+  this->Writer->SetFileName(this->FileName);
+  this->Writer->SetRate(this->Rate);
+  this->Writer->Start();
+  return this->Writer->GetErrorCode() == vtkErrorCode::NoError;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathFFMPEGEncoder::EncodeFrame(vtkImageData* image)
+{
+#if (VTK_MAJOR_VERSION <= 5)
+  this->Writer->SetInput(image);
+#else
+  this->Writer->SetInputData(image);
+#endif
+  this->Writer->Write();
+  return this->Writer->GetErrorCode() == vtkErrorCode::NoError;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathFFMPEGEncoder::EndEncoder()
+{
+  this->Writer->End();
+#if (VTK_MAJOR_VERSION <= 5)
+  this->Writer->SetInput(0);
+#else
+  this->Writer->SetInputData(0);
+#endif
+  return this->Writer->GetErrorCode() == vtkErrorCode::NoError;
+}
@@ -0,0 +1,67 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// .NAME vtkSlicerCameraPathFFMPEGEncoder - video encoder backend using VTK
+// .SECTION Description
+// Frames are encoded in the application by vtkFFMPEGWriter on the encoder
+// thread. The writer only encodes MPEG-4 with one of three qualities: the
+// codec, GOP and thread settings are ignored, and the quality is chosen
+// from the constant rate factor.
+
+#ifndef __vtkSlicerCameraPathFFMPEGEncoder_h
+#define __vtkSlicerCameraPathFFMPEGEncoder_h
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathVideoEncoder.h"
+
+#include "vtkSlicerCameraPathModuleLogicExport.h"
+
+class vtkFFMPEGWriter;
+
+/// \ingroup Slicer_QtModules_CameraPath
+class VTK_SLICER_CAMERAPATH_MODULE_LOGIC_EXPORT vtkSlicerCameraPathFFMPEGEncoder :
+  public vtkSlicerCameraPathVideoEncoder
+{
+public:
+
+  static vtkSlicerCameraPathFFMPEGEncoder *New();
+  vtkTypeMacro(vtkSlicerCameraPathFFMPEGEncoder, vtkSlicerCameraPathVideoEncoder);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Quality of vtkFFMPEGWriter, from 0 (low) to 2 (high), for a constant
+  /// rate factor. A bit rate gives the high quality.
+  static int GetQuality(int constantRateFactor);
+
+protected:
+  vtkSlicerCameraPathFFMPEGEncoder();
+  virtual ~vtkSlicerCameraPathFFMPEGEncoder();
+
+  virtual bool StartEncoder(int width, int height);
+  virtual bool EncodeFrame(vtkImageData* image);
+  virtual bool EndEncoder();
+
+  vtkFFMPEGWriter* Writer;
+  /// Input of the writer when it starts, giving the size of the video
+  vtkImageData* FirstFrame;
+
+private:
+
+  vtkSlicerCameraPathFFMPEGEncoder(const vtkSlicerCameraPathFFMPEGEncoder&); // Not implemented
+  void operator=(const vtkSlicerCameraPathFFMPEGEncoder&); // Not implemented
+};
+
+#endif
@@ -17,20 +17,256 @@
 
 // CameraPath Logic includes
 #include "vtkSlicerCameraPathLogic.h"
+#include "vtkSlicerCameraPathExporter.h"
 #include "vtkMRMLCameraPathNode.h"
+#include "vtkMRMLCameraPathParser.h"
 #include "vtkMRMLCameraPathStorageNode.h"
 #include "vtkMRMLPointSplineNode.h"
 
 // MRML includes
 #include <vtkMRMLScene.h>
+#include <vtkMRMLViewNode.h>
 
 // VTK includes
+#include <vtkCommand.h>
 #include <vtkIntArray.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtksys/Directory.hxx>
+#include <vtksys/SystemTools.hxx>
 
 // STD includes
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Index entry: modification times and lengths of the file and of its
+// journal, and the header. Modification times have a one second resolution
+// on some file systems, the lengths tell apart the journal entries appended
+// within the same second.
+struct IndexEntry
+{
+  IndexEntry()
+    : ModifiedTime(0), Length(0), JournalModifiedTime(0), JournalLength(0) {}
+
+  long int ModifiedTime;
+  unsigned long Length;
+  long int JournalModifiedTime;
+  unsigned long JournalLength;
+  CameraPathHeader Header;
+
+  bool IsSameFile(const IndexEntry& entry) const
+    {
+    return this->ModifiedTime == entry.ModifiedTime &&
+      this->Length == entry.Length &&
+      this->JournalModifiedTime == entry.JournalModifiedTime &&
+      this->JournalLength == entry.JournalLength;
+    }
+};
+typedef std::map<std::string, IndexEntry> Index;
+
+//----------------------------------------------------------------------------
+// Index lines are tab separated: file,mtime,length,journal mtime,
+// journal length,keyframes,tmin,tmax,xmin,xmax,ymin,ymax,zmin,zmax,name,
+// thumbnail. The journal mtime and length are 0 without a journal.
+const size_t INDEX_FIELDS = 16;
+
+//----------------------------------------------------------------------------
+// Modification times and lengths of the camera path file \a fullName and
+// of its journal
+IndexEntry GetIndexEntry(const std::string& fullName,
+                         const std::string& journalName)
+{
+  IndexEntry entry;
+  entry.ModifiedTime = vtksys::SystemTools::ModifiedTime(fullName.c_str());
+  entry.Length = vtksys::SystemTools::FileLength(fullName.c_str());
+  if (vtksys::SystemTools::FileExists(journalName.c_str(), true))
+    {
+    entry.JournalModifiedTime =
+      vtksys::SystemTools::ModifiedTime(journalName.c_str());
+    entry.JournalLength = vtksys::SystemTools::FileLength(journalName.c_str());
+    }
+  return entry;
+}
+
+//----------------------------------------------------------------------------
+void ReadIndex(const std::string& indexFileName, Index& index)
+{
+  std::ifstream ifs(indexFileName.c_str());
+  std::string line;
+  while (std::getline(ifs, line))
+    {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, '\t'))
+      {
+      fields.push_back(field);
+      }
+    // trailing empty thumbnail
+    if (fields.size() == INDEX_FIELDS - 1)
+      {
+      fields.push_back(std::string());
+      }
+    if (fields.size() != INDEX_FIELDS)
+      {
+      continue;
+      }
+
+    IndexEntry& entry = index[fields[0]];
+    entry.ModifiedTime = atol(fields[1].c_str());
+    entry.Length = strtoul(fields[2].c_str(), NULL, 10);
+    entry.JournalModifiedTime = atol(fields[3].c_str());
+    entry.JournalLength = strtoul(fields[4].c_str(), NULL, 10);
+    entry.Header.NumberOfKeyFrames = atoi(fields[5].c_str());
+    entry.Header.TimeRange[0] = atof(fields[6].c_str());
+    entry.Header.TimeRange[1] = atof(fields[7].c_str());
+    for (int i = 0; i < 6; ++i)
+      {
+      entry.Header.Bounds[i] = atof(fields[8 + i].c_str());
+      }
+    entry.Header.Name = fields[14];
+    entry.Header.Thumbnail = fields[15];
+    }
+}
+
+//----------------------------------------------------------------------------
+bool WriteIndex(const std::string& indexFileName, const Index& index)
+{
+  std::ofstream ofs(indexFileName.c_str());
+  if (!ofs.is_open())
+    {
+    return false;
+    }
+  ofs << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+  for (Index::const_iterator it = index.begin(); it != index.end(); ++it)
+    {
+    const IndexEntry& entry = it->second;
+    const CameraPathHeader& header = entry.Header;
+    ofs << it->first << "\t" << entry.ModifiedTime << "\t" << entry.Length
+        << "\t" << entry.JournalModifiedTime << "\t" << entry.JournalLength
+        << "\t" << header.NumberOfKeyFrames
+        << "\t" << header.TimeRange[0] << "\t" << header.TimeRange[1];
+    for (int i = 0; i < 6; ++i)
+      {
+      ofs << "\t" << header.Bounds[i];
+      }
+    ofs << "\t" << header.Name << "\t" << header.Thumbnail << "\n";
+    }
+  return ofs.good();
+}
+
+//----------------------------------------------------------------------------
+// Tasks shared by the worker threads: each worker takes the next task
+// until all of them are done.
+struct TaskQueue
+{
+  vtkMutexLock* Lock;
+  size_t NextTask;
+  size_t NumberOfTasks;
+  void (*Run)(void* data, size_t task);
+  void* Data;
+};
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE RunQueuedTasks(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  TaskQueue* queue = static_cast<TaskQueue*>(info->UserData);
+  while (true)
+    {
+    queue->Lock->Lock();
+    size_t task = queue->NextTask++;
+    queue->Lock->Unlock();
+    if (task >= queue->NumberOfTasks)
+      {
+      break;
+      }
+    queue->Run(queue->Data, task);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// Run the tasks on at most maximumNumberOfThreads threads and wait for them
+void RunTasks(size_t numberOfTasks, int maximumNumberOfThreads,
+              void (*run)(void* data, size_t task), void* data)
+{
+  if (numberOfTasks == 0)
+    {
+    return;
+    }
+  vtkNew<vtkMutexLock> lock;
+  TaskQueue queue;
+  queue.Lock = lock.GetPointer();
+  queue.NextTask = 0;
+  queue.NumberOfTasks = numberOfTasks;
+  queue.Run = run;
+  queue.Data = data;
+
+  int numberOfThreads = maximumNumberOfThreads > 0 ?
+    maximumNumberOfThreads : vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  if (static_cast<size_t>(numberOfThreads) > numberOfTasks)
+    {
+    numberOfThreads = static_cast<int>(numberOfTasks);
+    }
+
+  vtkNew<vtkMultiThreader> threader;
+  threader->SetNumberOfThreads(numberOfThreads);
+  threader->SetSingleMethod(RunQueuedTasks, &queue);
+  threader->SingleMethodExecute();
+}
+
+//----------------------------------------------------------------------------
+struct LoadTasks
+{
+  std::vector<std::string> FileNames;
+  std::vector<CameraPathData> Data;
+  std::vector<int> Success;
+};
+
+//----------------------------------------------------------------------------
+void RunLoadTask(void* data, size_t task)
+{
+  LoadTasks* tasks = static_cast<LoadTasks*>(data);
+  tasks->Success[task] = vtkSlicerCameraPathLogic::ReadCameraPathData(
+    tasks->FileNames[task].c_str(), tasks->Data[task]) ? 1 : 0;
+}
+
+//----------------------------------------------------------------------------
+struct SaveTasks
+{
+  std::vector<vtkSmartPointer<vtkMRMLCameraPathParser> > Parsers;
+  std::vector<CameraPathData> Data;
+  std::vector<int> Success;
+};
+
+//----------------------------------------------------------------------------
+void RunSaveTask(void* data, size_t task)
+{
+  SaveTasks* tasks = static_cast<SaveTasks*>(data);
+  if (tasks->Parsers[task])
+    {
+    tasks->Success[task] =
+      tasks->Parsers[task]->WritePathData(tasks->Data[task]);
+    }
+}
+
+} // end of anonymous namespace
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSlicerCameraPathLogic);
@@ -38,17 +274,21 @@ vtkStandardNewMacro(vtkSlicerCameraPathLogic);
 //----------------------------------------------------------------------------
 vtkSlicerCameraPathLogic::vtkSlicerCameraPathLogic()
 {
+  this->NumberOfThreads = 0;
+  this->Statistics = vtkSlicerCameraPathStatistics::New();
 }
 
 //----------------------------------------------------------------------------
 vtkSlicerCameraPathLogic::~vtkSlicerCameraPathLogic()
 {
+  this->Statistics->Delete();
 }
 
 //----------------------------------------------------------------------------
 void vtkSlicerCameraPathLogic::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
 }
 
 //---------------------------------------------------------------------------
@@ -91,7 +331,14 @@ void vtkSlicerCameraPathLogic::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
   {
     vtkDebugMacro("OnMRMLSceneNodeAdded: Have a vtkMRMLCameraPathNode node");
     vtkUnObserveMRMLNodeMacro(node); // remove any previous observation that might have been added
-    vtkObserveMRMLNodeMacro(node);
+    vtkNew<vtkIntArray> events;
+    events->InsertNextValue(vtkCommand::ModifiedEvent);
+    events->InsertNextValue(vtkMRMLCameraPathNode::KeyFrameAddedEvent);
+    events->InsertNextValue(vtkMRMLCameraPathNode::KeyFrameRemovedEvent);
+    events->InsertNextValue(vtkMRMLCameraPathNode::KeyFrameModifiedEvent);
+    events->InsertNextValue(vtkMRMLCameraPathNode::KeyFramesResetEvent);
+    vtkObserveMRMLNodeEventsMacro(node, events.GetPointer());
+    this->AddPointSplinesToScene(vtkMRMLCameraPathNode::SafeDownCast(node));
   }
   else if (node->IsA("vtkMRMLPointSplineNode"))
   {
@@ -122,11 +369,452 @@ void vtkSlicerCameraPathLogic::OnMRMLSceneNodeRemoved(vtkMRMLNode* node)
 }
 
 //---------------------------------------------------------------------------
-char* vtkSlicerCameraPathLogic::LoadCameraPath(const char *fileName, const char *nodeName)
+void vtkSlicerCameraPathLogic::ProcessMRMLNodesEvents(vtkObject* caller,
+                                                      unsigned long event,
+                                                      void* callData)
 {
-  char *nodeIDs = NULL;
-  std::string idList;
+  this->Superclass::ProcessMRMLNodesEvents(caller, event, callData);
+
+  vtkMRMLCameraPathNode* cameraPathNode =
+    vtkMRMLCameraPathNode::SafeDownCast(caller);
+  if (!cameraPathNode || event < vtkMRMLCameraPathNode::KeyFrameAddedEvent ||
+      event > vtkMRMLCameraPathNode::KeyFramesResetEvent)
+    {
+    return;
+    }
+
+  // keyframes set while loading or closing are not edits
+  vtkMRMLScene* scene = this->GetMRMLScene();
+  if (!scene || scene->IsBatchProcessing() || scene->IsImporting() ||
+      scene->IsRestoring() || scene->IsClosing())
+    {
+    return;
+    }
+
+  vtkMRMLCameraPathStorageNode* storageNode =
+    vtkMRMLCameraPathStorageNode::SafeDownCast(cameraPathNode->GetStorageNode());
+  if (!storageNode || !storageNode->GetJournalEnabled() ||
+      storageNode->GetJournalFileName().empty())
+    {
+    return;
+    }
+
+  std::vector<double> values;
+  switch (event)
+    {
+    case vtkMRMLCameraPathNode::KeyFrameAddedEvent:
+      {
+      double t = *reinterpret_cast<double*>(callData);
+      values.push_back(t);
+      if (this->GetKeyFramePose(cameraPathNode, t, values))
+        {
+        storageNode->AppendJournalEntry("add", &values[0], static_cast<int>(values.size()));
+        }
+      break;
+      }
+    case vtkMRMLCameraPathNode::KeyFrameRemovedEvent:
+      {
+      values.push_back(*reinterpret_cast<double*>(callData));
+      storageNode->AppendJournalEntry("remove", &values[0], static_cast<int>(values.size()));
+      break;
+      }
+    case vtkMRMLCameraPathNode::KeyFrameModifiedEvent:
+      {
+      double* times = reinterpret_cast<double*>(callData);
+      values.push_back(times[0]);
+      values.push_back(times[1]);
+      if (this->GetKeyFramePose(cameraPathNode, times[1], values))
+        {
+        storageNode->AppendJournalEntry("modify", &values[0], static_cast<int>(values.size()));
+        }
+      break;
+      }
+    case vtkMRMLCameraPathNode::KeyFramesResetEvent:
+      {
+      // the previous entries no longer matter, the journal is compacted
+      CameraPathData data;
+      for (vtkIdType i = 0; i < cameraPathNode->GetNumberOfKeyFrames(); ++i)
+        {
+        double t = cameraPathNode->GetKeyFrameTime(i);
+        if (this->GetKeyFramePose(cameraPathNode, t, data.Poses))
+          {
+          data.Times.push_back(t);
+          }
+        }
+      storageNode->ResetJournal(data);
+      break;
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerCameraPathLogic::GetKeyFramePose(vtkMRMLCameraPathNode* cameraPathNode,
+                                               double t, std::vector<double>& values)
+{
+  vtkIdType index = cameraPathNode->KeyFrameIndexAt(t);
+  if (index == -1)
+    {
+    return false;
+    }
+  double pose[9];
+  cameraPathNode->GetKeyFramePosition(index, pose);
+  cameraPathNode->GetKeyFrameFocalPoint(index, pose + 3);
+  cameraPathNode->GetKeyFrameViewUp(index, pose + 6);
+  values.insert(values.end(), pose, pose + 9);
+  return true;
+}
+
+//---------------------------------------------------------------------------
+int vtkSlicerCameraPathLogic::GetNumberOfFrames(double tmin, double tmax,
+                                                double framerate)
+{
+  if (tmax < tmin || framerate <= 0.0)
+    {
+    return 0;
+    }
+  return GetFrameAt(tmin, tmax, framerate) + 1;
+}
+
+//---------------------------------------------------------------------------
+double vtkSlicerCameraPathLogic::GetFrameTime(double tmin, int frame,
+                                             double framerate)
+{
+  return framerate > 0.0 ? tmin + frame / framerate : tmin;
+}
+
+//---------------------------------------------------------------------------
+int vtkSlicerCameraPathLogic::GetFrameAt(double tmin, double t, double framerate)
+{
+  if (framerate <= 0.0)
+    {
+    return 0;
+    }
+  // tolerate the rounding of times computed from frames
+  return static_cast<int>(floor((t - tmin) * framerate + 1e-6));
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerCameraPathLogic::GetShardFrameRange(int firstFrame, int lastFrame,
+                                                  int shardIndex, int shardCount,
+                                                  int& shardFirstFrame,
+                                                  int& shardLastFrame)
+{
+  if (lastFrame < firstFrame || shardCount < 1 ||
+      shardIndex < 0 || shardIndex >= shardCount)
+    {
+    return false;
+    }
+  // the first shards get one more frame when the range does not divide
+  int numberOfFrames = lastFrame - firstFrame + 1;
+  int size = numberOfFrames / shardCount;
+  int remainder = numberOfFrames % shardCount;
+  shardFirstFrame = firstFrame + shardIndex * size + std::min(shardIndex, remainder);
+  shardLastFrame = shardFirstFrame + size - (shardIndex < remainder ? 0 : 1);
+  return shardLastFrame >= shardFirstFrame;
+}
+
+//---------------------------------------------------------------------------
+std::string vtkSlicerCameraPathLogic::GetFrameFileName(const std::string& directory,
+                                                       const std::string& baseName,
+                                                       int frame,
+                                                       const std::string& extension)
+{
+  std::stringstream ss;
+  ss << directory << "/" << baseName << "_"
+     << std::setfill('0') << std::setw(5) << frame
+     << "." << extension;
+  return ss.str();
+}
+
+//---------------------------------------------------------------------------
+std::string vtkSlicerCameraPathLogic::GetManifestFileName(const std::string& directory,
+                                                          const std::string& baseName,
+                                                          int firstFrame, int lastFrame)
+{
+  std::stringstream ss;
+  ss << directory << "/" << baseName << "_"
+     << std::setfill('0') << std::setw(5) << firstFrame << "-"
+     << std::setfill('0') << std::setw(5) << lastFrame
+     << ".manifest";
+  return ss.str();
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerCameraPathLogic::ParseExportOutputs(const std::string& text,
+                                                  std::vector<ExportOutput>& outputs)
+{
+  outputs.clear();
+  std::string list = text;
+  std::replace(list.begin(), list.end(), ',', ' ');
+  std::stringstream ss(list);
+  std::string token;
+  while (ss >> token)
+    {
+    ExportOutput output;
+    std::string::size_type dot = token.find('.');
+    if (dot != std::string::npos)
+      {
+      output.Extension = token.substr(dot + 1);
+      token = token.substr(0, dot);
+      if (output.Extension.empty())
+        {
+        return false;
+        }
+      }
+    std::string::size_type separator = token.find_first_of("xX");
+    if (separator == std::string::npos)
+      {
+      return false;
+      }
+    std::string width = token.substr(0, separator);
+    std::string height = token.substr(separator + 1);
+    char* end = 0;
+    output.Width = static_cast<int>(strtol(width.c_str(), &end, 10));
+    if (width.empty() || *end != '\0')
+      {
+      return false;
+      }
+    output.Height = static_cast<int>(strtol(height.c_str(), &end, 10));
+    if (height.empty() || *end != '\0' || output.Width <= 0 || output.Height <= 0)
+      {
+      return false;
+      }
+    outputs.push_back(output);
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerCameraPathLogic::HasFrameAspectRatio(const ExportOutput& output,
+                                                   int width, int height)
+{
+  if (width <= 0 || height <= 0)
+    {
+    return false;
+    }
+  // The output height is at most half a pixel away from the frame height
+  // scaled to the output width, or the width from the scaled frame width
+  double difference = fabs(static_cast<double>(output.Height) * width -
+                           static_cast<double>(output.Width) * height);
+  return 2.0 * difference <= std::max(width, height);
+}
+
+//---------------------------------------------------------------------------
+std::string vtkSlicerCameraPathLogic::GetExportOutputBaseName(const std::string& baseName,
+                                                              const ExportOutput& output)
+{
+  std::stringstream ss;
+  ss << baseName << "_" << output.Width << "x" << output.Height;
+  return ss.str();
+}
+
+//---------------------------------------------------------------------------
+std::string vtkSlicerCameraPathLogic::GetCameraPathHash(vtkMRMLCameraPathNode* cameraPathNode)
+{
+  std::vector<double> values;
+  if (cameraPathNode)
+    {
+    for (vtkIdType i = 0; i < cameraPathNode->GetNumberOfKeyFrames(); ++i)
+      {
+      values.push_back(cameraPathNode->GetKeyFrameTime(i));
+      double pose[9];
+      cameraPathNode->GetKeyFramePosition(i, pose);
+      cameraPathNode->GetKeyFrameFocalPoint(i, pose + 3);
+      cameraPathNode->GetKeyFrameViewUp(i, pose + 6);
+      values.insert(values.end(), pose, pose + 9);
+      }
+    vtkNew<vtkMatrix4x4> transform;
+    for (int i = 0; i < cameraPathNode->GetNumberOfRigCameras(); ++i)
+      {
+      cameraPathNode->GetRigCameraTransform(i, transform.GetPointer());
+      values.insert(values.end(), &transform->Element[0][0],
+                    &transform->Element[0][0] + 16);
+      }
+    }
+  return vtkSlicerCameraPathExporter::ComputeHash(
+    values.empty() ? 0 : &values[0], values.size() * sizeof(double));
+}
+
+//---------------------------------------------------------------------------
+std::string vtkSlicerCameraPathLogic::GetExportHash(vtkMRMLCameraPathNode* cameraPathNode,
+                                                    vtkMRMLViewNode* viewNode)
+{
+  std::stringstream ss;
+  ss << GetCameraPathHash(cameraPathNode);
+
+  // the camera nodes are moved by the export, the other nodes changing
+  // the rendered frames are their display and transform nodes
+  vtkMRMLScene* scene = viewNode ? viewNode->GetScene() : 0;
+  if (scene)
+    {
+    viewNode->WriteXML(ss, 0);
+    const char* classNames[2] = {"vtkMRMLDisplayNode", "vtkMRMLTransformNode"};
+    for (int c = 0; c < 2; ++c)
+      {
+      std::vector<vtkMRMLNode*> nodes;
+      scene->GetNodesByClass(classNames[c], nodes);
+      for (size_t i = 0; i < nodes.size(); ++i)
+        {
+        nodes[i]->WriteXML(ss, 0);
+        }
+      }
+    }
+
+  std::string state = ss.str();
+  return vtkSlicerCameraPathExporter::ComputeHash(state.c_str(), state.size());
+}
+
+//---------------------------------------------------------------------------
+double vtkSlicerCameraPathLogic::GetPlaybackFrameTime(vtkMRMLViewNode* viewNode)
+{
+  const char* frameTime = viewNode ?
+    viewNode->GetAttribute(GetPlaybackFrameTimeAttributeName()) : NULL;
+  if (!frameTime)
+    {
+    return 0.0;
+    }
+  return std::max(0.0, atof(frameTime));
+}
 
+//---------------------------------------------------------------------------
+void vtkSlicerCameraPathLogic::SetPlaybackFrameTime(vtkMRMLViewNode* viewNode,
+                                                    double frameTime)
+{
+  if (!viewNode)
+    {
+    return;
+    }
+  if (frameTime <= 0.0)
+    {
+    viewNode->RemoveAttribute(GetPlaybackFrameTimeAttributeName());
+    return;
+    }
+  std::stringstream ss;
+  ss << frameTime;
+  viewNode->SetAttribute(GetPlaybackFrameTimeAttributeName(), ss.str().c_str());
+}
+
+//---------------------------------------------------------------------------
+double vtkSlicerCameraPathLogic::GetCameraTimeOffset(vtkMRMLCameraNode* cameraNode)
+{
+  const char* offset = cameraNode ?
+    cameraNode->GetAttribute(GetCameraTimeOffsetAttributeName()) : NULL;
+  return offset ? atof(offset) : 0.0;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerCameraPathLogic::SetCameraTimeOffset(vtkMRMLCameraNode* cameraNode,
+                                                   double offset)
+{
+  if (!cameraNode)
+    {
+    return;
+    }
+  if (offset == 0.0)
+    {
+    cameraNode->RemoveAttribute(GetCameraTimeOffsetAttributeName());
+    return;
+    }
+  std::stringstream ss;
+  ss << offset;
+  cameraNode->SetAttribute(GetCameraTimeOffsetAttributeName(), ss.str().c_str());
+}
+
+//---------------------------------------------------------------------------
+int vtkSlicerCameraPathLogic::GetCameraRigIndex(vtkMRMLCameraNode* cameraNode)
+{
+  const char* index = cameraNode ?
+    cameraNode->GetAttribute(GetCameraRigIndexAttributeName()) : NULL;
+  return index ? atoi(index) : -1;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerCameraPathLogic::SetCameraRigIndex(vtkMRMLCameraNode* cameraNode,
+                                                 int index)
+{
+  if (!cameraNode)
+    {
+    return;
+    }
+  if (index < 0)
+    {
+    cameraNode->RemoveAttribute(GetCameraRigIndexAttributeName());
+    return;
+    }
+  std::stringstream ss;
+  ss << index;
+  cameraNode->SetAttribute(GetCameraRigIndexAttributeName(), ss.str().c_str());
+}
+
+//---------------------------------------------------------------------------
+double vtkSlicerCameraPathLogic::ComputeDesiredUpdateRate(double currentRate,
+                                                          double renderTime,
+                                                          double frameTime,
+                                                          double stillRate)
+{
+  if (renderTime <= 0.0 || frameTime <= 0.0)
+    {
+    return currentRate;
+    }
+  const double maximumRate = 1000.0;
+
+  // a slow frame rendered at a rate below the frame rate, e.g. at still
+  // quality, first allocates the frame time so that it recovers in one step
+  double rate = std::max(currentRate, stillRate);
+  if (renderTime > frameTime)
+    {
+    rate = std::max(rate, 1.0 / frameTime);
+    }
+
+  // the time allocated is proportional to 1/rate, scale it by the error,
+  // by at most a factor 2 per frame so a single slow frame does not drop
+  // the quality down. Frames with time left go down to the still rate.
+  double ratio = std::min(2.0, std::max(0.5, renderTime / frameTime));
+  rate *= ratio;
+  return std::min(maximumRate, std::max(stillRate, rate));
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerCameraPathLogic::AddPointSplinesToScene(vtkMRMLCameraPathNode* cameraPathNode)
+{
+  if (!cameraPathNode || !cameraPathNode->GetScene())
+    {
+    return;
+    }
+  vtkMRMLScene* scene = cameraPathNode->GetScene();
+
+  vtkMRMLPointSplineNode* splines[3] =
+    {
+    cameraPathNode->GetPositionSplines(),
+    cameraPathNode->GetFocalPointSplines(),
+    cameraPathNode->GetViewUpSplines()
+    };
+  const char* suffixes[3] = {"_PositionSpline", "_FocalPointSpline", "_ViewUpSpline"};
+
+  for (int i = 0; i < 3; ++i)
+    {
+    if (scene->IsNodePresent(splines[i]))
+      {
+      continue;
+      }
+    if (cameraPathNode->GetName())
+      {
+      std::string name = std::string(cameraPathNode->GetName()) + suffixes[i];
+      splines[i]->SetName(name.c_str());
+      }
+    scene->AddNode(splines[i]);
+
+    // path may have been read before the spline was in the scene
+    if (splines[i]->GetPolyData())
+      {
+      splines[i]->CreateDefaultDisplayNodes();
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+char* vtkSlicerCameraPathLogic::LoadCameraPath(const char *fileName, const char *nodeName)
+{
   if (!fileName)
     {
     vtkErrorMacro("LoadCameraPath: null file name, cannot load");
@@ -143,12 +831,247 @@ char* vtkSlicerCameraPathLogic::LoadCameraPath(const char *fileName, const char
     return NULL;
     }
 
+  // read the file
+  CameraPathData data;
+  if (!vtkSlicerCameraPathLogic::ReadCameraPathData(fileName, data))
+    {
+    vtkErrorMacro("LoadCameraPath: could not read data");
+    return NULL;
+    }
+
   // turn on batch processing
   this->GetMRMLScene()->StartState(vtkMRMLScene::BatchProcessState);
 
-  // storage node
+  char* nodeIDs = this->AddCameraPathToScene(data, nodeName);
+
+  // turn off batch processing
+  this->GetMRMLScene()->EndState(vtkMRMLScene::BatchProcessState);
+
+  return nodeIDs;
+}
+
+//---------------------------------------------------------------------------
+char* vtkSlicerCameraPathLogic::LoadCameraPaths(const std::vector<std::string>& fileNames)
+{
+  if (!this->GetMRMLScene())
+    {
+    vtkErrorMacro("LoadCameraPaths: no MRML scene, cannot load");
+    return NULL;
+    }
+
+  // read the files
+  LoadTasks tasks;
+  tasks.FileNames = fileNames;
+  tasks.Data.resize(fileNames.size());
+  tasks.Success.resize(fileNames.size(), 0);
+  RunTasks(fileNames.size(), this->NumberOfThreads, RunLoadTask, &tasks);
+
+  // add the nodes
+  std::string idList;
+  this->GetMRMLScene()->StartState(vtkMRMLScene::BatchProcessState);
+  for (size_t i = 0; i < fileNames.size(); ++i)
+    {
+    if (!tasks.Success[i])
+      {
+      vtkErrorMacro("LoadCameraPaths: could not read " << fileNames[i].c_str());
+      continue;
+      }
+    std::string nodeName =
+      vtksys::SystemTools::GetFilenameWithoutLastExtension(fileNames[i]);
+    char* nodeIDs = this->AddCameraPathToScene(tasks.Data[i], nodeName.c_str());
+    if (nodeIDs)
+      {
+      if (!idList.empty())
+        {
+        idList += std::string(",");
+        }
+      idList += std::string(nodeIDs);
+      free(nodeIDs);
+      }
+    }
+  this->GetMRMLScene()->EndState(vtkMRMLScene::BatchProcessState);
+
+  // return IDs
+  char *nodeIDs = NULL;
+  if (idList.length())
+    {
+    nodeIDs = (char *)malloc(sizeof(char) * (idList.length() + 1));
+    strcpy(nodeIDs, idList.c_str());
+    }
+  return nodeIDs;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerCameraPathLogic::SaveCameraPaths(
+  const std::vector<vtkMRMLCameraPathNode*>& nodes,
+  const std::vector<std::string>& fileNames)
+{
+  if (nodes.size() != fileNames.size())
+    {
+    vtkErrorMacro("SaveCameraPaths: " << nodes.size() << " nodes for "
+                  << fileNames.size() << " file names");
+    return false;
+    }
+
+  // copy the node contents on this thread, the worker threads only use
+  // parsers that hold no MRML node
+  SaveTasks tasks;
+  tasks.Data.resize(nodes.size());
+  tasks.Success.resize(nodes.size(), 0);
   vtkNew<vtkMRMLCameraPathStorageNode> storageNode;
-  storageNode->SetFileName(fileName);
+  for (size_t i = 0; i < nodes.size(); ++i)
+    {
+    if (!nodes[i])
+      {
+      tasks.Parsers.push_back(NULL);
+      continue;
+      }
+    vtkMRMLCameraPathStorageNode* nodeStorageNode =
+      vtkMRMLCameraPathStorageNode::SafeDownCast(nodes[i]->GetStorageNode());
+    storageNode->SetEmbedPathCache(
+      nodeStorageNode ? nodeStorageNode->GetEmbedPathCache() : 0);
+    storageNode->GetPathData(nodes[i], tasks.Data[i]);
+
+    vtkSmartPointer<vtkMRMLCameraPathParser> parser =
+      vtkSmartPointer<vtkMRMLCameraPathParser>::New();
+    parser->SetFileName(fileNames[i].c_str());
+    tasks.Parsers.push_back(parser);
+    }
+
+  // write the files
+  RunTasks(nodes.size(), this->NumberOfThreads, RunSaveTask, &tasks);
+
+  bool success = true;
+  for (size_t i = 0; i < nodes.size(); ++i)
+    {
+    if (!tasks.Success[i])
+      {
+      vtkErrorMacro("SaveCameraPaths: could not write " << fileNames[i].c_str());
+      success = false;
+      continue;
+      }
+
+    // the node is now stored in that file, as if saved with the scene
+    vtkMRMLCameraPathStorageNode* nodeStorageNode =
+      vtkMRMLCameraPathStorageNode::SafeDownCast(nodes[i]->GetStorageNode());
+    if (!nodeStorageNode && nodes[i]->GetScene())
+      {
+      vtkMRMLStorageNode* defaultStorageNode = nodes[i]->CreateDefaultStorageNode();
+      nodes[i]->GetScene()->AddNode(defaultStorageNode);
+      nodes[i]->SetAndObserveStorageNodeID(defaultStorageNode->GetID());
+      defaultStorageNode->Delete();
+      nodeStorageNode =
+        vtkMRMLCameraPathStorageNode::SafeDownCast(nodes[i]->GetStorageNode());
+      }
+    if (nodeStorageNode)
+      {
+      nodeStorageNode->SetFileName(fileNames[i].c_str());
+      nodeStorageNode->StoredTimeModified();
+      }
+    }
+  return success;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerCameraPathLogic::ReadCameraPathData(const char* fileName,
+                                                  CameraPathData& data)
+{
+  if (!fileName || fileName[0] == '\0')
+    {
+    return false;
+    }
+
+  // no MRML node is used so that the read is thread safe
+  vtkNew<vtkMRMLCameraPathParser> parser;
+  parser->SetFileName(fileName);
+  return parser->ReadPathData(data) != 0;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerCameraPathLogic::ReadCameraPathHeaders(const char* directory,
+                                                     std::vector<CameraPathHeader>& headers,
+                                                     bool useIndex)
+{
+  headers.clear();
+
+  vtksys::Directory dir;
+  if (!directory || !dir.Load(directory))
+    {
+    return false;
+    }
+
+  // list the camera path files
+  std::vector<std::string> fileNames;
+  for (unsigned long i = 0; i < dir.GetNumberOfFiles(); ++i)
+    {
+    std::string fileName = dir.GetFile(i);
+    if (vtksys::SystemTools::GetFilenameLastExtension(fileName) == ".kcsv")
+      {
+      fileNames.push_back(fileName);
+      }
+    }
+  std::sort(fileNames.begin(), fileNames.end());
+
+  std::string indexFileName =
+    std::string(directory) + "/" + vtkSlicerCameraPathLogic::GetIndexFileName();
+  Index index;
+  if (useIndex)
+    {
+    ReadIndex(indexFileName, index);
+    }
+
+  // reuse the index entries of the files that were not modified
+  Index updatedIndex;
+  bool indexModified = (index.size() != fileNames.size());
+  for (std::vector<std::string>::const_iterator it = fileNames.begin();
+       it != fileNames.end(); ++it)
+    {
+    std::string fullName = std::string(directory) + "/" + *it;
+    vtkNew<vtkMRMLCameraPathParser> parser;
+    parser->SetFileName(fullName.c_str());
+    IndexEntry fileEntry = GetIndexEntry(fullName, parser->GetJournalFileName());
+
+    // a file edited since it was indexed has a new or longer journal
+    Index::const_iterator entry = index.find(*it);
+    if (entry != index.end() && entry->second.IsSameFile(fileEntry))
+      {
+      updatedIndex[*it] = entry->second;
+      }
+    else
+      {
+      if (!parser->ReadHeader(fileEntry.Header))
+        {
+        continue;
+        }
+      updatedIndex[*it] = fileEntry;
+      indexModified = true;
+      }
+
+    headers.push_back(updatedIndex[*it].Header);
+    headers.back().FileName = fullName;
+    }
+
+  // the index is only a cache, the directory may be read-only
+  if (useIndex && indexModified)
+    {
+    WriteIndex(indexFileName, updatedIndex);
+    }
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+char* vtkSlicerCameraPathLogic::AddCameraPathToScene(const CameraPathData& data,
+                                                     const char* nodeName)
+{
+  char *nodeIDs = NULL;
+  std::string idList;
+
+  if (!this->GetMRMLScene())
+    {
+    vtkErrorMacro("AddCameraPathToScene: no MRML scene, cannot add");
+    return NULL;
+    }
 
   // camera path node
   vtkNew<vtkMRMLCameraPathNode> cameraPathNode;
@@ -157,29 +1080,25 @@ char* vtkSlicerCameraPathLogic::LoadCameraPath(const char *fileName, const char
   // Disable modified event
   cameraPathNode->DisableModifiedEventOn();
 
-  // adding nodes to scene
-  this->GetMRMLScene()->AddNode(storageNode.GetPointer());
+  // adding node to scene, point splines are added with the camera path
   this->GetMRMLScene()->AddNode(cameraPathNode.GetPointer());
   idList += std::string(cameraPathNode->GetID());
 
-  this->GetMRMLScene()->AddNode(cameraPathNode->GetPositionSplines());
   idList += std::string(",");
   idList += std::string(cameraPathNode->GetPositionSplines()->GetID());
 
-  this->GetMRMLScene()->AddNode(cameraPathNode->GetFocalPointSplines());
   idList += std::string(",");
   idList += std::string(cameraPathNode->GetFocalPointSplines()->GetID());
 
-  this->GetMRMLScene()->AddNode(cameraPathNode->GetViewUpSplines());
   idList += std::string(",");
   idList += std::string(cameraPathNode->GetViewUpSplines()->GetID());
 
-  // read the file
-  if (!storageNode->ReadData(cameraPathNode.GetPointer()))
+  // set keyframes and path
+  vtkNew<vtkMRMLCameraPathStorageNode> storageNode;
+  if (!storageNode->ApplyPathData(data, cameraPathNode.GetPointer()))
     {
-    vtkErrorMacro("LoadCameraPath: coud not read data");
+    vtkErrorMacro("AddCameraPathToScene: could not set keyframes");
     this->GetMRMLScene()->RemoveNode(cameraPathNode.GetPointer());
-    this->GetMRMLScene()->RemoveNode(storageNode.GetPointer());
     return NULL;
     }
 
@@ -197,13 +1116,6 @@ char* vtkSlicerCameraPathLogic::LoadCameraPath(const char *fileName, const char
   cameraPathNode->DisableModifiedEventOff();
   cameraPathNode->Modified();
 
-  // removing storage node
-  this->GetMRMLScene()->RemoveNode(storageNode.GetPointer());
-
-  // turn off batch processing
-  this->GetMRMLScene()->EndState(vtkMRMLScene::BatchProcessState);
-
-
   // return IDs
   if (idList.length())
     {
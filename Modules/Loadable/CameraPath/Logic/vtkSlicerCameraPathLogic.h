@@ -29,12 +29,33 @@
 
 // MRML includes
 #include "vtkMRMLCameraPathNode.h"
+#include "vtkMRMLCameraPathParser.h"
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathStatistics.h"
 
 // STD includes
 #include <cstdlib>
+#include <string>
+#include <vector>
 
 #include "vtkSlicerCameraPathModuleLogicExport.h"
 
+class vtkMRMLViewNode;
+
+/// Additional output of an export, downscaled from the rendered frames so
+/// that all the outputs are rendered once.
+/// \sa vtkSlicerCameraPathLogic::ParseExportOutputs()
+struct ExportOutput
+{
+  int Width;
+  int Height;
+  /// Extension of the output files without the dot, empty to use the
+  /// extension of the export
+  std::string Extension;
+
+  ExportOutput() : Width(0), Height(0) {}
+};
 
 /// \ingroup Slicer_QtModules_ExtensionTemplate
 class VTK_SLICER_CAMERAPATH_MODULE_LOGIC_EXPORT vtkSlicerCameraPathLogic :
@@ -48,6 +69,156 @@ public:
 
   char* LoadCameraPath(const char *fileName, const char *nodeName);
 
+  /// Load several camera path files, named after their file base names.
+  /// Files are read and their paths computed concurrently by at most
+  /// NumberOfThreads workers, then all the nodes are added to the scene in
+  /// a single batch process.
+  /// Return a comma separated list of the added node IDs, to be freed by
+  /// the caller, or NULL if no file could be loaded.
+  char* LoadCameraPaths(const std::vector<std::string>& fileNames);
+
+  /// Save each camera path node to the file of the same index.
+  /// Node contents are copied on the calling thread, the files are then
+  /// formatted and written concurrently by at most NumberOfThreads workers.
+  /// The storage node of each saved node, created if needed, is then set to
+  /// its file and marked as stored.
+  /// Return true if all the files were written.
+  bool SaveCameraPaths(const std::vector<vtkMRMLCameraPathNode*>& nodes,
+                       const std::vector<std::string>& fileNames);
+
+  /// Maximum number of worker threads used by LoadCameraPaths() and
+  /// SaveCameraPaths(). 0 (default) uses the number of processors.
+  vtkSetMacro(NumberOfThreads, int);
+  vtkGetMacro(NumberOfThreads, int);
+
+  /// Per-frame timings of the last playback or export
+  vtkGetObjectMacro(Statistics, vtkSlicerCameraPathStatistics);
+
+  /// Read a camera path file and compute its path with a parser that holds
+  /// no MRML node. It can be called from a worker thread, the result being
+  /// added to the scene on the main thread with AddCameraPathToScene().
+  static bool ReadCameraPathData(const char* fileName, CameraPathData& data);
+
+  /// Create a camera path node named \a nodeName from \a data and add it
+  /// to the scene with its point splines and keyframe cameras.
+  /// Return a comma separated list of the added node IDs, to be freed by
+  /// the caller, or NULL on failure. Callers adding several paths should
+  /// wrap the calls in a scene batch process.
+  char* AddCameraPathToScene(const CameraPathData& data, const char* nodeName);
+
+  /// Read the header of every camera path file (.kcsv) in \a directory,
+  /// sorted by file name, without parsing their keyframes.
+  /// If \a useIndex is true, headers are cached in an index file in the
+  /// directory (see GetIndexFileName()) and only the files modified since
+  /// the last scan are read. Return false if the directory can't be listed.
+  static bool ReadCameraPathHeaders(const char* directory,
+                                    std::vector<CameraPathHeader>& headers,
+                                    bool useIndex = true);
+
+  /// Name of the header index file written by ReadCameraPathHeaders()
+  static const char* GetIndexFileName() {return ".kcsvindex";};
+
+  /// Frames of a path played at \a framerate: frame i is at time
+  /// tmin + i / framerate, the last frame being at or before \a tmax.
+  /// Paths are evaluated at continuous times, frames only sample them for
+  /// playback and export.
+  static int GetNumberOfFrames(double tmin, double tmax, double framerate);
+  static double GetFrameTime(double tmin, int frame, double framerate);
+  /// Last frame at or before time \a t
+  static int GetFrameAt(double tmin, double t, double framerate);
+
+  /// Split the frames \a firstFrame to \a lastFrame in \a shardCount
+  /// contiguous blocks of nearly equal sizes, and return in \a shardFirstFrame
+  /// and \a shardLastFrame the block of shard \a shardIndex (from 0).
+  /// Independent processes can each export a shard, frames keeping their
+  /// index in the whole path. Return false if the shard has no frame.
+  static bool GetShardFrameRange(int firstFrame, int lastFrame,
+                                 int shardIndex, int shardCount,
+                                 int& shardFirstFrame, int& shardLastFrame);
+
+  /// File of an exported frame: <directory>/<baseName>_<frame>.<extension>,
+  /// the frame index being padded to 5 digits so that files sort in order
+  static std::string GetFrameFileName(const std::string& directory,
+                                      const std::string& baseName,
+                                      int frame, const std::string& extension);
+
+  /// Manifest of the export of frames \a firstFrame to \a lastFrame:
+  /// <directory>/<baseName>_<firstFrame>-<lastFrame>.manifest, so that each
+  /// shard of an export is resumed from its own manifest.
+  /// \sa vtkSlicerCameraPathExporter::SetManifestFileName()
+  static std::string GetManifestFileName(const std::string& directory,
+                                         const std::string& baseName,
+                                         int firstFrame, int lastFrame);
+
+  /// Parse a list of export outputs separated by commas or spaces, each
+  /// written <width>x<height>[.<extension>], e.g. "1280x720, 640x360.png".
+  /// Return false if an output is invalid.
+  static bool ParseExportOutputs(const std::string& text,
+                                 std::vector<ExportOutput>& outputs);
+
+  /// Whether \a output has the aspect ratio of frames of \a width by
+  /// \a height, up to the rounding of its width or height to the nearest
+  /// pixel. Outputs of another aspect ratio would be stretched by the
+  /// downscale and are rejected.
+  static bool HasFrameAspectRatio(const ExportOutput& output,
+                                  int width, int height);
+
+  /// Base name of the files of an export output: <baseName>_<width>x<height>
+  static std::string GetExportOutputBaseName(const std::string& baseName,
+                                             const ExportOutput& output);
+
+  /// Hash of the keyframes and rig cameras of a camera path, identifying
+  /// the frames of its exports
+  static std::string GetCameraPathHash(vtkMRMLCameraPathNode* cameraPathNode);
+
+  /// Hash identifying the frames of an export of \a cameraPathNode in
+  /// \a viewNode: the camera path hash, and the view node, display nodes
+  /// and transform nodes of the scene as written in the scene file, so that
+  /// frames rendered with another display state are not resumed.
+  static std::string GetExportHash(vtkMRMLCameraPathNode* cameraPathNode,
+                                   vtkMRMLViewNode* viewNode);
+
+  /// Render time per frame aimed at when playing a path in \a viewNode, in
+  /// seconds. It is saved with the view node as the attribute named by
+  /// GetPlaybackFrameTimeAttributeName(). 0 (default) follows the playback
+  /// framerate.
+  static double GetPlaybackFrameTime(vtkMRMLViewNode* viewNode);
+  static void SetPlaybackFrameTime(vtkMRMLViewNode* viewNode, double frameTime);
+  static const char* GetPlaybackFrameTimeAttributeName()
+    {return "CameraPath.PlaybackFrameTime";};
+
+  /// Time offset, in seconds, of a camera linked to the path played in
+  /// another camera: it shows the path at the playback time plus its
+  /// offset. It is saved with the camera node as the attribute named by
+  /// GetCameraTimeOffsetAttributeName().
+  static double GetCameraTimeOffset(vtkMRMLCameraNode* cameraNode);
+  static void SetCameraTimeOffset(vtkMRMLCameraNode* cameraNode, double offset);
+  static const char* GetCameraTimeOffsetAttributeName()
+    {return "CameraPath.TimeOffset";};
+
+  /// Rig camera whose pose a camera linked to the path played in another
+  /// camera takes, -1 (default) for the pose of the path camera. It is saved
+  /// with the camera node as the attribute named by
+  /// GetCameraRigIndexAttributeName().
+  static int GetCameraRigIndex(vtkMRMLCameraNode* cameraNode);
+  static void SetCameraRigIndex(vtkMRMLCameraNode* cameraNode, int index);
+  static const char* GetCameraRigIndexAttributeName()
+    {return "CameraPath.RigCamera";};
+
+  /// Desired update rate of a render window for its next frame during
+  /// playback, given the rate \a currentRate of the last frame which took
+  /// \a renderTime seconds to render instead of \a frameTime.
+  /// The rate, which sets the time allocated to the levels of detail and
+  /// volume mappers, is raised when the frame was too slow and lowered down
+  /// to \a stillRate when there was time left.
+  static double ComputeDesiredUpdateRate(double currentRate, double renderTime,
+                                         double frameTime, double stillRate);
+
+  /// Add the point splines of a camera path node to its scene.
+  /// The splines are derived from the keyframes and are not saved with the
+  /// scene, so they are added back each time a camera path node is added.
+  void AddPointSplinesToScene(vtkMRMLCameraPathNode* cameraPathNode);
+
 protected:
   vtkSlicerCameraPathLogic();
   virtual ~vtkSlicerCameraPathLogic();
@@ -58,6 +229,20 @@ protected:
   virtual void UpdateFromMRMLScene();
   virtual void OnMRMLSceneNodeAdded(vtkMRMLNode* node);
   virtual void OnMRMLSceneNodeRemoved(vtkMRMLNode* node);
+
+  /// Record keyframe operations in the journal of the camera path storage
+  /// node, \sa vtkMRMLCameraPathStorageNode::SetJournalEnabled()
+  virtual void ProcessMRMLNodesEvents(vtkObject* caller,
+                                      unsigned long event,
+                                      void* callData);
+
+  /// Append the pose of the keyframe at time \a t to \a values
+  static bool GetKeyFramePose(vtkMRMLCameraPathNode* cameraPathNode,
+                              double t, std::vector<double>& values);
+
+  int NumberOfThreads;
+  vtkSlicerCameraPathStatistics* Statistics;
+
 private:
 
   vtkSlicerCameraPathLogic(const vtkSlicerCameraPathLogic&); // Not implemented
@@ -0,0 +1,177 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathOffscreenView.h"
+
+// VTK includes
+#include <vtkLight.h>
+#include <vtkLightCollection.h>
+#include <vtkObjectFactory.h>
+#include <vtkPropCollection.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkRendererCollection.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <vector>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerCameraPathOffscreenView);
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathOffscreenView::vtkSlicerCameraPathOffscreenView()
+{
+  this->RenderWindow = vtkRenderWindow::New();
+  this->RenderWindow->SetOffScreenRendering(1);
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathOffscreenView::~vtkSlicerCameraPathOffscreenView()
+{
+  this->RemoveViewProps();
+  this->RenderWindow->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathOffscreenView::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "RenderWindow: " << this->RenderWindow << "\n";
+}
+
+//----------------------------------------------------------------------------
+vtkRenderWindow* vtkSlicerCameraPathOffscreenView::GetRenderWindow()
+{
+  return this->RenderWindow;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathOffscreenView::Update(vtkRenderWindow* viewWindow,
+                                              int width, int height)
+{
+  if (!viewWindow || width <= 0 || height <= 0)
+    {
+    vtkErrorMacro("Update: invalid view or size");
+    return false;
+    }
+
+  // The buffers are only reallocated if the size changed
+  int* size = this->RenderWindow->GetSize();
+  if (size[0] != width || size[1] != height)
+    {
+    this->RenderWindow->SetSize(width, height);
+    }
+  this->RenderWindow->SetNumberOfLayers(viewWindow->GetNumberOfLayers());
+  this->RenderWindow->SetMultiSamples(viewWindow->GetMultiSamples());
+  this->RenderWindow->SetAlphaBitPlanes(viewWindow->GetAlphaBitPlanes());
+
+  std::vector<vtkRenderer*> viewRenderers;
+  vtkRendererCollection* renderers = viewWindow->GetRenderers();
+  renderers->InitTraversal();
+  while (vtkRenderer* renderer = renderers->GetNextItem())
+    {
+    viewRenderers.push_back(renderer);
+    }
+
+  // Renderers are kept between exports, only added or removed when the
+  // number of renderers of the view changes
+  std::vector<vtkRenderer*> offscreenRenderers;
+  renderers = this->RenderWindow->GetRenderers();
+  renderers->InitTraversal();
+  while (vtkRenderer* renderer = renderers->GetNextItem())
+    {
+    offscreenRenderers.push_back(renderer);
+    }
+  while (offscreenRenderers.size() > viewRenderers.size())
+    {
+    this->RenderWindow->RemoveRenderer(offscreenRenderers.back());
+    offscreenRenderers.pop_back();
+    }
+  while (offscreenRenderers.size() < viewRenderers.size())
+    {
+    vtkSmartPointer<vtkRenderer> renderer = vtkSmartPointer<vtkRenderer>::New();
+    this->RenderWindow->AddRenderer(renderer);
+    offscreenRenderers.push_back(renderer);
+    }
+
+  // The contexts of the view and of the offscreen window are not shared:
+  // the display lists, buffers and textures of the props (e.g. the volume
+  // textures of the volume mappers) are released in the context of the view
+  // and created again in the offscreen context by the first frame
+  viewWindow->MakeCurrent();
+  for (size_t i = 0; i < viewRenderers.size(); ++i)
+    {
+    vtkRenderer* viewRenderer = viewRenderers[i];
+    vtkRenderer* renderer = offscreenRenderers[i];
+    renderer->SetLayer(viewRenderer->GetLayer());
+    renderer->SetViewport(viewRenderer->GetViewport());
+    renderer->SetInteractive(0);
+    renderer->SetPreserveDepthBuffer(viewRenderer->GetPreserveDepthBuffer());
+    renderer->SetBackground(viewRenderer->GetBackground());
+    renderer->SetBackground2(viewRenderer->GetBackground2());
+    renderer->SetGradientBackground(viewRenderer->GetGradientBackground());
+    renderer->SetUseDepthPeeling(viewRenderer->GetUseDepthPeeling());
+    renderer->SetMaximumNumberOfPeels(viewRenderer->GetMaximumNumberOfPeels());
+    renderer->SetOcclusionRatio(viewRenderer->GetOcclusionRatio());
+    renderer->SetActiveCamera(viewRenderer->GetActiveCamera());
+
+    // Lights are shared, the automatic light of a view without lights is
+    // created by the offscreen renderer itself
+    renderer->RemoveAllLights();
+    renderer->SetLightFollowCamera(viewRenderer->GetLightFollowCamera());
+    renderer->SetAutomaticLightCreation(viewRenderer->GetAutomaticLightCreation());
+    vtkLightCollection* lights = viewRenderer->GetLights();
+    lights->InitTraversal();
+    while (vtkLight* light = lights->GetNextItem())
+      {
+      renderer->AddLight(light);
+      }
+
+    renderer->RemoveAllViewProps();
+    vtkPropCollection* props = viewRenderer->GetViewProps();
+    props->InitTraversal();
+    while (vtkProp* prop = props->GetNextProp())
+      {
+      prop->ReleaseGraphicsResources(viewWindow);
+      renderer->AddViewProp(prop);
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathOffscreenView::RemoveViewProps()
+{
+  // Resources of the props are released in the offscreen context, the view
+  // creating its own when it renders again
+  this->RenderWindow->MakeCurrent();
+  vtkRendererCollection* renderers = this->RenderWindow->GetRenderers();
+  renderers->InitTraversal();
+  while (vtkRenderer* renderer = renderers->GetNextItem())
+    {
+    vtkPropCollection* props = renderer->GetViewProps();
+    props->InitTraversal();
+    while (vtkProp* prop = props->GetNextProp())
+      {
+      prop->ReleaseGraphicsResources(this->RenderWindow);
+      }
+    renderer->RemoveAllViewProps();
+    renderer->RemoveAllLights();
+    }
+}
@@ -0,0 +1,81 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// .NAME vtkSlicerCameraPathOffscreenView - offscreen copy of a view to export
+// .SECTION Description
+// Persistent offscreen render window mirroring the renderers of a view:
+// each renderer of the view has a renderer in the offscreen window with the
+// same layer, viewport, background and lights, sharing its camera and its
+// props. Frames are exported from the offscreen window at their own size,
+// while the view keeps its size and stays on screen. The window and its
+// renderers are kept between exports, so that its framebuffer is only
+// reallocated when the size changes.
+// The offscreen context is not shared with the view, VTK render windows
+// having no shared contexts: the graphics resources of the props are
+// released from the view context by Update() and from the offscreen
+// context by RemoveViewProps(), and the view must not render in between,
+// e.g. by disabling the rendering of its ctkVTKAbstractView. The textures,
+// buffers and volume textures of the props are therefore not kept between
+// exports: each export uploads them to the offscreen context, then the view
+// uploads them again to its own context.
+
+#ifndef __vtkSlicerCameraPathOffscreenView_h
+#define __vtkSlicerCameraPathOffscreenView_h
+
+// VTK includes
+#include <vtkObject.h>
+
+#include "vtkSlicerCameraPathModuleLogicExport.h"
+
+class vtkRenderWindow;
+
+/// \ingroup Slicer_QtModules_CameraPath
+class VTK_SLICER_CAMERAPATH_MODULE_LOGIC_EXPORT vtkSlicerCameraPathOffscreenView :
+  public vtkObject
+{
+public:
+
+  static vtkSlicerCameraPathOffscreenView *New();
+  vtkTypeMacro(vtkSlicerCameraPathOffscreenView, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Offscreen render window the frames are rendered in
+  vtkRenderWindow* GetRenderWindow();
+
+  /// Mirror the renderers, cameras, lights and props of \a viewWindow,
+  /// rendering at \a width by \a height pixels. The graphics resources of
+  /// the props are released in the context of \a viewWindow.
+  bool Update(vtkRenderWindow* viewWindow, int width, int height);
+
+  /// Release the graphics resources of the props of the view in the
+  /// offscreen context and remove them from the offscreen renderers once
+  /// the export is done, keeping the window and its buffers for the next one
+  void RemoveViewProps();
+
+protected:
+  vtkSlicerCameraPathOffscreenView();
+  virtual ~vtkSlicerCameraPathOffscreenView();
+
+  vtkRenderWindow* RenderWindow;
+
+private:
+
+  vtkSlicerCameraPathOffscreenView(const vtkSlicerCameraPathOffscreenView&); // Not implemented
+  void operator=(const vtkSlicerCameraPathOffscreenView&); // Not implemented
+};
+
+#endif
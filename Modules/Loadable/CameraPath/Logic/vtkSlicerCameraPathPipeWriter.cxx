@@ -0,0 +1,375 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathPipeWriter.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <csignal>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+# define popen _popen
+# define pclose _pclose
+# define PIPE_WRITE_MODE "wb"
+#else
+# define PIPE_WRITE_MODE "w"
+#endif
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+inline unsigned char clampByte(int value)
+{
+  return static_cast<unsigned char>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+//----------------------------------------------------------------------------
+// Luma of a row, the number of components being a constant so that the
+// loop is vectorized by the compiler
+template <int Components>
+void convertLumaRow(const unsigned char* rgb, int width, unsigned char* y)
+{
+  for (int i = 0; i < width; ++i)
+    {
+    const unsigned char* pixel = rgb + i * Components;
+    y[i] = static_cast<unsigned char>(
+      (77 * pixel[0] + 150 * pixel[1] + 29 * pixel[2] + 128) >> 8);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Sum a pair of rows into R, G and B planes, which have one more pixel
+// repeating the last one for odd widths
+template <int Components>
+void sumRows(const unsigned char* rgb0, const unsigned char* rgb1, int width,
+             unsigned short* r, unsigned short* g, unsigned short* b)
+{
+  for (int i = 0; i < width; ++i)
+    {
+    const unsigned char* pixel0 = rgb0 + i * Components;
+    const unsigned char* pixel1 = rgb1 + i * Components;
+    r[i] = static_cast<unsigned short>(pixel0[0] + pixel1[0]);
+    g[i] = static_cast<unsigned short>(pixel0[1] + pixel1[1]);
+    b[i] = static_cast<unsigned short>(pixel0[2] + pixel1[2]);
+    }
+  r[width] = r[width - 1];
+  g[width] = g[width - 1];
+  b[width] = b[width - 1];
+}
+
+//----------------------------------------------------------------------------
+// Chroma of a row pair from its summed planes, each chroma sample averaging
+// a 2x2 block of pixels. The planes being contiguous, the loop is
+// vectorized by the compiler.
+void convertChromaRow(const unsigned short* r, const unsigned short* g,
+                      const unsigned short* b, int chromaWidth,
+                      unsigned char* u, unsigned char* v)
+{
+  for (int x = 0; x < chromaWidth; ++x)
+    {
+    int red = r[2 * x] + r[2 * x + 1];
+    int green = g[2 * x] + g[2 * x + 1];
+    int blue = b[2 * x] + b[2 * x + 1];
+    u[x] = clampByte(((-43 * red - 85 * green + 128 * blue + 512) >> 10) + 128);
+    v[x] = clampByte(((128 * red - 107 * green - 21 * blue + 512) >> 10) + 128);
+    }
+}
+
+//----------------------------------------------------------------------------
+template <int Components>
+void convertRGBToYUV420(const unsigned char* rgb, int width, int height,
+                        unsigned char* y, unsigned char* u, unsigned char* v)
+{
+  const size_t rowSize = static_cast<size_t>(width) * Components;
+  const int chromaWidth = (width + 1) / 2;
+  std::vector<unsigned short> sums(3 * static_cast<size_t>(width + 1));
+  unsigned short* r = &sums[0];
+  unsigned short* g = r + width + 1;
+  unsigned short* b = g + width + 1;
+  for (int row = 0; row < height; row += 2)
+    {
+    // VTK images start with the bottom row, video frames with the top row
+    const unsigned char* rgb0 = rgb + (height - 1 - row) * rowSize;
+    const unsigned char* rgb1 = (row + 1 < height ? rgb0 - rowSize : rgb0);
+    convertLumaRow<Components>(rgb0, width, y + static_cast<size_t>(row) * width);
+    if (row + 1 < height)
+      {
+      convertLumaRow<Components>(rgb1, width,
+                                 y + static_cast<size_t>(row + 1) * width);
+      }
+    sumRows<Components>(rgb0, rgb1, width, r, g, b);
+    convertChromaRow(r, g, b, chromaWidth,
+                     u + static_cast<size_t>(row / 2) * chromaWidth,
+                     v + static_cast<size_t>(row / 2) * chromaWidth);
+    }
+}
+}
+
+//----------------------------------------------------------------------------
+class vtkSlicerCameraPathPipeWriter::vtkInternal
+{
+public:
+  vtkInternal();
+
+  FILE* Pipe;
+  int Width;
+  int Height;
+  bool Failed;
+  /// Y, U and V planes of a frame, reused for each frame
+  std::vector<unsigned char> Planes;
+
+#ifndef _WIN32
+  /// A closed encoder must not terminate the application
+  void (*PreviousPipeHandler)(int);
+#endif
+};
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathPipeWriter::vtkInternal::vtkInternal()
+  : Pipe(0)
+  , Width(0)
+  , Height(0)
+  , Failed(false)
+{
+#ifndef _WIN32
+  this->PreviousPipeHandler = SIG_DFL;
+#endif
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerCameraPathPipeWriter);
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathPipeWriter::vtkSlicerCameraPathPipeWriter()
+{
+  this->Command = 0;
+  this->FileName = 0;
+  this->Rate = 30;
+  this->Internal = new vtkInternal;
+  this->SetCommand(GetDefaultCommand());
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathPipeWriter::~vtkSlicerCameraPathPipeWriter()
+{
+  this->End();
+  this->SetCommand(0);
+  this->SetFileName(0);
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathPipeWriter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Command: " << (this->Command ? this->Command : "(none)") << "\n";
+  os << indent << "FileName: " << (this->FileName ? this->FileName : "(none)") << "\n";
+  os << indent << "Rate: " << this->Rate << "\n";
+}
+
+//----------------------------------------------------------------------------
+std::string vtkSlicerCameraPathPipeWriter::GetCommandLine()
+{
+  std::string commandLine(this->Command ? this->Command : "");
+  std::string fileName = QuoteArgument(this->FileName ? this->FileName : "");
+  size_t position = commandLine.find("%o");
+  while (position != std::string::npos)
+    {
+    // quotes around %o are replaced too, the file name being quoted
+    size_t size = 2;
+    if (position > 0 && position + 2 < commandLine.size() &&
+        (commandLine[position - 1] == '"' || commandLine[position - 1] == '\'') &&
+        commandLine[position + 2] == commandLine[position - 1])
+      {
+      --position;
+      size = 4;
+      }
+    commandLine.replace(position, size, fileName);
+    position = commandLine.find("%o", position + fileName.size());
+    }
+  return commandLine;
+}
+
+//----------------------------------------------------------------------------
+std::string vtkSlicerCameraPathPipeWriter::QuoteArgument(const std::string& argument)
+{
+#ifdef _WIN32
+  // cmd.exe: file names cannot contain double quotes
+  return "\"" + argument + "\"";
+#else
+  // POSIX shells do not interpret anything between single quotes, a single
+  // quote is written by closing the quotes, escaping it and reopening them
+  std::string quoted("'");
+  for (size_t i = 0; i < argument.size(); ++i)
+    {
+    if (argument[i] == '\'')
+      {
+      quoted += "'\\''";
+      }
+    else
+      {
+      quoted += argument[i];
+      }
+    }
+  quoted += "'";
+  return quoted;
+#endif
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathPipeWriter::Start(int width, int height)
+{
+  if (this->Internal->Pipe)
+    {
+    vtkErrorMacro("Start: the encoder is already started");
+    return false;
+    }
+  if (width <= 0 || height <= 0 || this->Rate <= 0)
+    {
+    vtkErrorMacro("Start: invalid frame size or rate");
+    return false;
+    }
+  std::string commandLine = this->GetCommandLine();
+  if (commandLine.empty())
+    {
+    vtkErrorMacro("Start: no encoder command");
+    return false;
+    }
+
+#ifndef _WIN32
+  this->Internal->PreviousPipeHandler = signal(SIGPIPE, SIG_IGN);
+#endif
+  this->Internal->Pipe = popen(commandLine.c_str(), PIPE_WRITE_MODE);
+  if (!this->Internal->Pipe)
+    {
+    vtkErrorMacro("Start: unable to run " << commandLine);
+#ifndef _WIN32
+    signal(SIGPIPE, this->Internal->PreviousPipeHandler);
+#endif
+    return false;
+    }
+  this->Internal->Width = width;
+  this->Internal->Height = height;
+  this->Internal->Failed = false;
+  size_t chromaSize = static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+  this->Internal->Planes.resize(static_cast<size_t>(width) * height + 2 * chromaSize);
+
+  // C420jpeg: 4:2:0 with chroma samples centered between the luma samples,
+  // as averaged from 2x2 blocks. It does not set the range: the full range
+  // values are tagged with XCOLORRANGE, otherwise encoders read them as
+  // limited range and clip the blacks and whites
+  std::stringstream header;
+  header << "YUV4MPEG2 W" << width << " H" << height
+         << " F" << this->Rate << ":1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+  const std::string headerString = header.str();
+  if (fwrite(headerString.c_str(), 1, headerString.size(), this->Internal->Pipe)
+      != headerString.size())
+    {
+    this->Internal->Failed = true;
+    }
+  return !this->Internal->Failed;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathPipeWriter::WriteFrame(vtkImageData* image)
+{
+  if (!this->Internal->Pipe || this->Internal->Failed)
+    {
+    return false;
+    }
+  int dimensions[3];
+  if (image)
+    {
+    image->GetDimensions(dimensions);
+    }
+  int components = image ? image->GetNumberOfScalarComponents() : 0;
+  if (!image || image->GetScalarType() != VTK_UNSIGNED_CHAR ||
+      (components != 3 && components != 4) ||
+      dimensions[0] != this->Internal->Width ||
+      dimensions[1] != this->Internal->Height)
+    {
+    vtkErrorMacro("WriteFrame: the frame must be an RGB image of "
+                  << this->Internal->Width << "x" << this->Internal->Height);
+    return false;
+    }
+
+  int width = this->Internal->Width;
+  int height = this->Internal->Height;
+  unsigned char* y = &this->Internal->Planes[0];
+  unsigned char* u = y + static_cast<size_t>(width) * height;
+  unsigned char* v = u + static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+  ConvertRGBToYUV420(static_cast<unsigned char*>(image->GetScalarPointer()),
+                     width, height, components, y, u, v);
+
+  static const char frameHeader[] = "FRAME\n";
+  if (fwrite(frameHeader, 1, sizeof(frameHeader) - 1, this->Internal->Pipe)
+        != sizeof(frameHeader) - 1 ||
+      fwrite(&this->Internal->Planes[0], 1, this->Internal->Planes.size(),
+             this->Internal->Pipe) != this->Internal->Planes.size())
+    {
+    vtkErrorMacro("WriteFrame: the encoder stopped reading frames");
+    this->Internal->Failed = true;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathPipeWriter::End()
+{
+  if (!this->Internal->Pipe)
+    {
+    return false;
+    }
+  int status = pclose(this->Internal->Pipe);
+  this->Internal->Pipe = 0;
+#ifndef _WIN32
+  signal(SIGPIPE, this->Internal->PreviousPipeHandler);
+#endif
+  if (status != 0)
+    {
+    vtkErrorMacro("End: the encoder failed with status " << status);
+    return false;
+    }
+  return !this->Internal->Failed;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathPipeWriter::ConvertRGBToYUV420(const unsigned char* rgb,
+                                                       int width, int height,
+                                                       int components,
+                                                       unsigned char* y,
+                                                       unsigned char* u,
+                                                       unsigned char* v)
+{
+  if (components == 4)
+    {
+    convertRGBToYUV420<4>(rgb, width, height, y, u, v);
+    }
+  else
+    {
+    convertRGBToYUV420<3>(rgb, width, height, y, u, v);
+    }
+}
@@ -0,0 +1,114 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// .NAME vtkSlicerCameraPathPipeWriter - stream frames to an encoder command
+// .SECTION Description
+// Frames are converted from RGB to YUV 4:2:0 and written as a YUV4MPEG2
+// stream to the standard input of an external encoder process, e.g.
+//   ffmpeg -y -f yuv4mpegpipe -i - -c:v libx264 -crf 18 %o
+// The encoder runs concurrently with rendering, and its codec, bitrate and
+// threading are set by the command line, the module not linking to any
+// codec.
+
+#ifndef __vtkSlicerCameraPathPipeWriter_h
+#define __vtkSlicerCameraPathPipeWriter_h
+
+// VTK includes
+#include <vtkObject.h>
+
+#include "vtkSlicerCameraPathModuleLogicExport.h"
+
+// STD includes
+#include <string>
+
+class vtkImageData;
+
+/// \ingroup Slicer_QtModules_CameraPath
+class VTK_SLICER_CAMERAPATH_MODULE_LOGIC_EXPORT vtkSlicerCameraPathPipeWriter :
+  public vtkObject
+{
+public:
+
+  static vtkSlicerCameraPathPipeWriter *New();
+  vtkTypeMacro(vtkSlicerCameraPathPipeWriter, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Encoder command line, run by the shell. It reads the YUV4MPEG2 stream
+  /// on its standard input. "%o" is replaced by FileName, quoted for the
+  /// shell: it must not be quoted in the command, quotes right around it
+  /// are dropped.
+  vtkSetStringMacro(Command);
+  vtkGetStringMacro(Command);
+
+  /// Output file of the encoder, substituted for "%o" in the command
+  vtkSetStringMacro(FileName);
+  vtkGetStringMacro(FileName);
+
+  /// Number of frames per second, 30 by default
+  vtkSetMacro(Rate, int);
+  vtkGetMacro(Rate, int);
+
+  /// Default encoder command, using ffmpeg and H.264
+  static const char* GetDefaultCommand()
+    {return "ffmpeg -y -loglevel error -f yuv4mpegpipe -i - "
+            "-c:v libx264 -preset medium -crf 18 -pix_fmt yuv420p %o";};
+
+  /// Start the encoder for frames of \a width by \a height pixels
+  bool Start(int width, int height);
+
+  /// Convert the RGB or RGBA unsigned char \a image to YUV and write it to
+  /// the encoder. The image must have the size given to Start().
+  bool WriteFrame(vtkImageData* image);
+
+  /// Close the stream and wait for the encoder to finish.
+  /// Return false if a frame could not be written or the encoder failed.
+  bool End();
+
+  /// Command run by Start(), with the file name substituted
+  std::string GetCommandLine();
+
+  /// Quote \a argument so that the shell passes it unchanged to the command
+  static std::string QuoteArgument(const std::string& argument);
+
+  /// Convert the rows of \a rgb, bottom row first, to top-down Y, U and V
+  /// planes with 4:2:0 subsampling, using full range BT.601 coefficients in
+  /// fixed point. Rows are converted in passes over contiguous planes that
+  /// the compiler vectorizes. \a rgb has \a components (3 or 4) bytes per pixel, the U
+  /// and V planes have ((width + 1) / 2) * ((height + 1) / 2) pixels.
+  static void ConvertRGBToYUV420(const unsigned char* rgb, int width,
+                                 int height, int components,
+                                 unsigned char* y, unsigned char* u,
+                                 unsigned char* v);
+
+protected:
+  vtkSlicerCameraPathPipeWriter();
+  virtual ~vtkSlicerCameraPathPipeWriter();
+
+  char* Command;
+  char* FileName;
+  int Rate;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+
+  vtkSlicerCameraPathPipeWriter(const vtkSlicerCameraPathPipeWriter&); // Not implemented
+  void operator=(const vtkSlicerCameraPathPipeWriter&); // Not implemented
+};
+
+#endif
@@ -0,0 +1,273 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathStatistics.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <fstream>
+#include <vector>
+
+namespace
+{
+
+const char* const STAGE_NAMES[vtkSlicerCameraPathStatistics::NumberOfStages] =
+  {"evaluation", "apply", "render", "readback", "resize", "encode", "write"};
+
+//----------------------------------------------------------------------------
+struct FrameTimes
+{
+  int Frame;
+  int DroppedFrames;
+  double Start;
+  double End;
+  double StageTimes[vtkSlicerCameraPathStatistics::NumberOfStages];
+};
+
+}
+
+//----------------------------------------------------------------------------
+class vtkSlicerCameraPathStatistics::vtkInternal
+{
+public:
+  vtkInternal() : InFrame(false) {}
+
+  std::vector<FrameTimes> Frames;
+  FrameTimes Current;
+  bool InFrame;
+};
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerCameraPathStatistics);
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathStatistics::vtkSlicerCameraPathStatistics()
+{
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathStatistics::~vtkSlicerCameraPathStatistics()
+{
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathStatistics::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfFrames: " << this->GetNumberOfFrames() << "\n";
+  os << indent << "NumberOfDroppedFrames: " << this->GetNumberOfDroppedFrames() << "\n";
+  os << indent << "AchievedFrameRate: " << this->GetAchievedFrameRate() << "\n";
+}
+
+//----------------------------------------------------------------------------
+const char* vtkSlicerCameraPathStatistics::GetStageName(int stage)
+{
+  if (stage < 0 || stage >= NumberOfStages)
+    {
+    return "";
+    }
+  return STAGE_NAMES[stage];
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerCameraPathStatistics::GetTime()
+{
+  return vtkTimerLog::GetUniversalTime();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathStatistics::Reset()
+{
+  this->Internal->Frames.clear();
+  this->Internal->InFrame = false;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathStatistics::StartFrame(int frame, int droppedFrames)
+{
+  FrameTimes& current = this->Internal->Current;
+  current.Frame = frame;
+  current.DroppedFrames = droppedFrames;
+  current.Start = this->GetTime();
+  current.End = current.Start;
+  for (int stage = 0; stage < NumberOfStages; ++stage)
+    {
+    current.StageTimes[stage] = 0.0;
+    }
+  this->Internal->InFrame = true;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathStatistics::AddStageTime(int stage, double seconds)
+{
+  if (!this->Internal->InFrame || stage < 0 || stage >= NumberOfStages)
+    {
+    return;
+    }
+  this->Internal->Current.StageTimes[stage] += seconds;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathStatistics::EndFrame()
+{
+  if (!this->Internal->InFrame)
+    {
+    return;
+    }
+  this->Internal->Current.End = this->GetTime();
+  this->Internal->Frames.push_back(this->Internal->Current);
+  this->Internal->InFrame = false;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCameraPathStatistics::GetNumberOfFrames()
+{
+  return static_cast<int>(this->Internal->Frames.size());
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCameraPathStatistics::GetNumberOfDroppedFrames()
+{
+  int droppedFrames = 0;
+  for (size_t i = 0; i < this->Internal->Frames.size(); ++i)
+    {
+    droppedFrames += this->Internal->Frames[i].DroppedFrames;
+    }
+  return droppedFrames;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerCameraPathStatistics::GetAchievedFrameRate()
+{
+  const std::vector<FrameTimes>& frames = this->Internal->Frames;
+  if (frames.empty())
+    {
+    return 0.0;
+    }
+  double duration = frames.back().End - frames.front().Start;
+  return duration > 0.0 ? frames.size() / duration : 0.0;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerCameraPathStatistics::GetMeanStageTime(int stage)
+{
+  const std::vector<FrameTimes>& frames = this->Internal->Frames;
+  if (frames.empty() || stage < 0 || stage >= NumberOfStages)
+    {
+    return 0.0;
+    }
+  double total = 0.0;
+  for (size_t i = 0; i < frames.size(); ++i)
+    {
+    total += frames[i].StageTimes[stage];
+    }
+  return total / frames.size();
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerCameraPathStatistics::GetMeanFrameTime()
+{
+  const std::vector<FrameTimes>& frames = this->Internal->Frames;
+  if (frames.empty())
+    {
+    return 0.0;
+    }
+  double total = 0.0;
+  for (size_t i = 0; i < frames.size(); ++i)
+    {
+    total += frames[i].End - frames[i].Start;
+    }
+  return total / frames.size();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathStatistics::WriteCSV(const char* fileName)
+{
+  std::ofstream of(fileName);
+  if (!of.is_open())
+    {
+    vtkErrorMacro("WriteCSV: unable to open file " << fileName << " for writing");
+    return false;
+    }
+
+  of << "frame,dropped";
+  for (int stage = 0; stage < NumberOfStages; ++stage)
+    {
+    of << "," << STAGE_NAMES[stage];
+    }
+  of << ",total" << std::endl;
+
+  const std::vector<FrameTimes>& frames = this->Internal->Frames;
+  for (size_t i = 0; i < frames.size(); ++i)
+    {
+    of << frames[i].Frame << "," << frames[i].DroppedFrames;
+    for (int stage = 0; stage < NumberOfStages; ++stage)
+      {
+      of << "," << 1000.0 * frames[i].StageTimes[stage];
+      }
+    of << "," << 1000.0 * (frames[i].End - frames[i].Start) << std::endl;
+    }
+  return of.good();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathStatistics::WriteJSON(const char* fileName)
+{
+  std::ofstream of(fileName);
+  if (!of.is_open())
+    {
+    vtkErrorMacro("WriteJSON: unable to open file " << fileName << " for writing");
+    return false;
+    }
+
+  of << "{" << std::endl;
+  of << "  \"frames\": " << this->GetNumberOfFrames() << "," << std::endl;
+  of << "  \"droppedFrames\": " << this->GetNumberOfDroppedFrames() << "," << std::endl;
+  of << "  \"achievedFps\": " << this->GetAchievedFrameRate() << "," << std::endl;
+  of << "  \"meanMs\": {";
+  for (int stage = 0; stage < NumberOfStages; ++stage)
+    {
+    of << "\"" << STAGE_NAMES[stage] << "\": "
+       << 1000.0 * this->GetMeanStageTime(stage) << ", ";
+    }
+  of << "\"total\": " << 1000.0 * this->GetMeanFrameTime() << "}," << std::endl;
+
+  of << "  \"timingsMs\": [";
+  const std::vector<FrameTimes>& frames = this->Internal->Frames;
+  for (size_t i = 0; i < frames.size(); ++i)
+    {
+    of << (i == 0 ? "" : ",") << std::endl
+       << "    {\"frame\": " << frames[i].Frame
+       << ", \"dropped\": " << frames[i].DroppedFrames;
+    for (int stage = 0; stage < NumberOfStages; ++stage)
+      {
+      of << ", \"" << STAGE_NAMES[stage] << "\": "
+         << 1000.0 * frames[i].StageTimes[stage];
+      }
+    of << ", \"total\": " << 1000.0 * (frames[i].End - frames[i].Start) << "}";
+    }
+  of << std::endl << "  ]" << std::endl << "}" << std::endl;
+  return of.good();
+}
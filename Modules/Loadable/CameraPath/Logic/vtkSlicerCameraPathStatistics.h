@@ -0,0 +1,109 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// .NAME vtkSlicerCameraPathStatistics - per-frame timings of playback and export
+// .SECTION Description
+// Collects the time spent in each stage of a frame (path evaluation, pose
+// application, rendering, image readback, resizing, encoding and writing),
+// the achieved frame rate and the number of dropped frames, and writes the
+// raw timings as CSV or JSON.
+
+#ifndef __vtkSlicerCameraPathStatistics_h
+#define __vtkSlicerCameraPathStatistics_h
+
+// VTK includes
+#include <vtkObject.h>
+
+#include "vtkSlicerCameraPathModuleLogicExport.h"
+
+/// \ingroup Slicer_QtModules_CameraPath
+class VTK_SLICER_CAMERAPATH_MODULE_LOGIC_EXPORT vtkSlicerCameraPathStatistics :
+  public vtkObject
+{
+public:
+
+  static vtkSlicerCameraPathStatistics *New();
+  vtkTypeMacro(vtkSlicerCameraPathStatistics, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  enum Stage
+    {
+    Evaluation = 0,
+    /// Applying the poses to the cameras and updating the widgets, renders
+    /// excluded
+    Apply,
+    Render,
+    Readback,
+    Resize,
+    Encode,
+    Write,
+    NumberOfStages
+    };
+
+  /// Name of a stage, as used in the CSV and JSON files
+  static const char* GetStageName(int stage);
+
+  /// Current time in seconds, to measure the stages
+  static double GetTime();
+
+  /// Remove all the frames
+  void Reset();
+
+  /// Start recording \a frame. \a droppedFrames is the number of frames
+  /// skipped since the previous one.
+  void StartFrame(int frame, int droppedFrames = 0);
+
+  /// Add \a seconds to the time of \a stage in the current frame
+  void AddStageTime(int stage, double seconds);
+
+  /// Record the current frame
+  void EndFrame();
+
+  int GetNumberOfFrames();
+  int GetNumberOfDroppedFrames();
+
+  /// Frames recorded per second, from the start of the first frame to the
+  /// end of the last one
+  double GetAchievedFrameRate();
+
+  /// Mean time of \a stage over the recorded frames, in seconds
+  double GetMeanStageTime(int stage);
+
+  /// Mean total time of the frames, in seconds
+  double GetMeanFrameTime();
+
+  /// Write one line per frame: frame, dropped frames, then the stage and
+  /// total times in milliseconds
+  bool WriteCSV(const char* fileName);
+
+  /// Write the summary and the per-frame times in milliseconds
+  bool WriteJSON(const char* fileName);
+
+protected:
+  vtkSlicerCameraPathStatistics();
+  virtual ~vtkSlicerCameraPathStatistics();
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+
+  vtkSlicerCameraPathStatistics(const vtkSlicerCameraPathStatistics&); // Not implemented
+  void operator=(const vtkSlicerCameraPathStatistics&); // Not implemented
+};
+
+#endif
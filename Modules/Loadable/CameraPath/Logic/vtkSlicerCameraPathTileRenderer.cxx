@@ -0,0 +1,239 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathExporter.h"
+#include "vtkSlicerCameraPathTileRenderer.h"
+
+// VTK includes
+#include <vtkActor2D.h>
+#include <vtkActor2DCollection.h>
+#include <vtkCamera.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkRendererCollection.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// View of a camera before tiling
+struct CameraView
+{
+  vtkCamera* Camera;
+  double ViewAngle;
+  double ParallelScale;
+  double WindowCenter[2];
+};
+
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerCameraPathTileRenderer);
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathTileRenderer::vtkSlicerCameraPathTileRenderer()
+{
+  this->Size[0] = 0;
+  this->Size[1] = 0;
+  this->Tile = vtkImageData::New();
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathTileRenderer::~vtkSlicerCameraPathTileRenderer()
+{
+  this->Tile->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathTileRenderer::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Size: " << this->Size[0] << "x" << this->Size[1] << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathTileRenderer::GetNumberOfTiles(const int size[2],
+                                                       const int tileSize[2],
+                                                       int numberOfTiles[2])
+{
+  for (int i = 0; i < 2; ++i)
+    {
+    numberOfTiles[i] = tileSize[i] > 0 ?
+      (size[i] + tileSize[i] - 1) / tileSize[i] : 0;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathTileRenderer::GetTileWindowCenter(
+  const int size[2], const int tileSize[2], const int origin[2],
+  const double windowCenter[2], double tileWindowCenter[2])
+{
+  for (int axis = 0; axis < 2; ++axis)
+    {
+    const double scale = static_cast<double>(tileSize[axis]) / size[axis];
+    tileWindowCenter[axis] = windowCenter[axis] / scale +
+      static_cast<double>(2 * origin[axis] + tileSize[axis] - size[axis]) /
+      tileSize[axis];
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathTileRenderer::Render(vtkRenderWindow* renderWindow,
+                                             vtkImageData* image)
+{
+  if (!renderWindow || !image || this->Size[0] <= 0 || this->Size[1] <= 0)
+    {
+    vtkErrorMacro("Render: invalid window or image size");
+    return false;
+    }
+  int* windowSize = renderWindow->GetSize();
+  const int tileSize[2] = {windowSize[0], windowSize[1]};
+  int numberOfTiles[2];
+  GetNumberOfTiles(this->Size, tileSize, numberOfTiles);
+  if (numberOfTiles[0] <= 0 || numberOfTiles[1] <= 0)
+    {
+    vtkErrorMacro("Render: invalid window size");
+    return false;
+    }
+
+  const int dimensions[3] = {this->Size[0], this->Size[1], 1};
+  vtkSlicerCameraPathExporter::AllocatePixels(image, dimensions, 3);
+
+  // Cameras of the renderers of the first layer, a camera shared by several
+  // renderers being narrowed once. Overlay layers and 2D actors are placed
+  // in the viewport, not in the scene: they would be repeated in each tile
+  // and are hidden while tiling, as vtkRenderLargeImage does.
+  std::vector<CameraView> views;
+  std::vector<vtkRenderer*> overlays;
+  std::vector<vtkActor2D*> actors2D;
+  vtkRendererCollection* renderers = renderWindow->GetRenderers();
+  renderers->InitTraversal();
+  while (vtkRenderer* renderer = renderers->GetNextItem())
+    {
+    if (renderer->GetLayer() != 0)
+      {
+      if (renderer->GetDraw())
+        {
+        overlays.push_back(renderer);
+        renderer->DrawOff();
+        }
+      continue;
+      }
+    vtkActor2DCollection* rendererActors2D = renderer->GetActors2D();
+    rendererActors2D->InitTraversal();
+    while (vtkActor2D* actor = rendererActors2D->GetNextActor2D())
+      {
+      if (actor->GetVisibility())
+        {
+        actors2D.push_back(actor);
+        actor->VisibilityOff();
+        }
+      }
+    vtkCamera* camera = renderer->GetActiveCamera();
+    bool found = false;
+    for (size_t i = 0; i < views.size() && !found; ++i)
+      {
+      found = views[i].Camera == camera;
+      }
+    if (!found)
+      {
+      CameraView view;
+      view.Camera = camera;
+      view.ViewAngle = camera->GetViewAngle();
+      view.ParallelScale = camera->GetParallelScale();
+      camera->GetWindowCenter(view.WindowCenter);
+      views.push_back(view);
+      }
+    }
+
+  // A tile sees the fraction tileSize / Size of the view, centered on the
+  // tile
+  const double scale[2] = {static_cast<double>(tileSize[0]) / this->Size[0],
+                           static_cast<double>(tileSize[1]) / this->Size[1]};
+  unsigned char* pixels = static_cast<unsigned char*>(image->GetScalarPointer());
+  bool success = true;
+  for (int row = 0; row < numberOfTiles[1] && success; ++row)
+    {
+    for (int column = 0; column < numberOfTiles[0] && success; ++column)
+      {
+      const int origin[2] = {column * tileSize[0], row * tileSize[1]};
+      for (size_t i = 0; i < views.size(); ++i)
+        {
+        vtkCamera* camera = views[i].Camera;
+        double angleScale = camera->GetUseHorizontalViewAngle() ?
+          scale[0] : scale[1];
+        double halfAngle =
+          vtkMath::RadiansFromDegrees(views[i].ViewAngle / 2.0);
+        camera->SetViewAngle(2.0 * vtkMath::DegreesFromRadians(
+          atan(tan(halfAngle) * angleScale)));
+        camera->SetParallelScale(views[i].ParallelScale * scale[1]);
+        double windowCenter[2];
+        GetTileWindowCenter(this->Size, tileSize, origin,
+                            views[i].WindowCenter, windowCenter);
+        camera->SetWindowCenter(windowCenter[0], windowCenter[1]);
+        }
+
+      renderWindow->Render();
+      success = vtkSlicerCameraPathExporter::ReadPixels(renderWindow, this->Tile);
+
+      // Tiles on the right and top borders are cropped
+      const int width = std::min(tileSize[0], this->Size[0] - origin[0]);
+      const int height = std::min(tileSize[1], this->Size[1] - origin[1]);
+      const unsigned char* tilePixels =
+        static_cast<unsigned char*>(this->Tile->GetScalarPointer());
+      for (int y = 0; y < height && success; ++y)
+        {
+        memcpy(pixels + 3 * (static_cast<size_t>(origin[1] + y) * this->Size[0] +
+                             origin[0]),
+               tilePixels + 3 * static_cast<size_t>(y) * tileSize[0],
+               3 * static_cast<size_t>(width));
+        }
+      }
+    }
+
+  for (size_t i = 0; i < views.size(); ++i)
+    {
+    views[i].Camera->SetViewAngle(views[i].ViewAngle);
+    views[i].Camera->SetParallelScale(views[i].ParallelScale);
+    views[i].Camera->SetWindowCenter(views[i].WindowCenter[0],
+                                     views[i].WindowCenter[1]);
+    }
+  for (size_t i = 0; i < overlays.size(); ++i)
+    {
+    overlays[i]->DrawOn();
+    }
+  for (size_t i = 0; i < actors2D.size(); ++i)
+    {
+    actors2D[i]->VisibilityOn();
+    }
+  image->Modified();
+  if (!success)
+    {
+    vtkErrorMacro("Render: unable to read the pixels of the render window");
+    }
+  return success;
+}
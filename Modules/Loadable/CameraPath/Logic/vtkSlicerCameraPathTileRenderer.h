@@ -0,0 +1,89 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// .NAME vtkSlicerCameraPathTileRenderer - render images larger than a window
+// .SECTION Description
+// An image of any size is rendered as a grid of tiles of the window size,
+// without resizing the window. For each tile, the cameras of the window
+// renderers are narrowed to the part of the view of the tile, using their
+// window center and view angle (or parallel scale), then the tile is read
+// back and copied into the image. Only one tile buffer is kept besides the
+// image, so that the memory does not depend on the number of tiles.
+// Like vtkRenderLargeImage, gradient backgrounds are drawn in each tile.
+// Only the renderers of layer 0 are tiled: overlay renderers (e.g. the
+// orientation marker) and 2D actors, which are laid out in the viewport,
+// are hidden while tiling so that they are not repeated in each tile.
+
+#ifndef __vtkSlicerCameraPathTileRenderer_h
+#define __vtkSlicerCameraPathTileRenderer_h
+
+// VTK includes
+#include <vtkObject.h>
+
+#include "vtkSlicerCameraPathModuleLogicExport.h"
+
+class vtkImageData;
+class vtkRenderWindow;
+
+/// \ingroup Slicer_QtModules_CameraPath
+class VTK_SLICER_CAMERAPATH_MODULE_LOGIC_EXPORT vtkSlicerCameraPathTileRenderer :
+  public vtkObject
+{
+public:
+
+  static vtkSlicerCameraPathTileRenderer *New();
+  vtkTypeMacro(vtkSlicerCameraPathTileRenderer, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Size of the rendered image in pixels
+  vtkSetVector2Macro(Size, int);
+  vtkGetVector2Macro(Size, int);
+
+  /// Render the tiles of the image in \a renderWindow and stitch them in
+  /// the RGB \a image, reusing its scalars if the size did not change.
+  /// The cameras, overlay renderers and 2D actors are restored afterwards.
+  bool Render(vtkRenderWindow* renderWindow, vtkImageData* image);
+
+  /// Number of columns and rows of tiles of \a tileSize covering an image
+  /// of \a size
+  static void GetNumberOfTiles(const int size[2], const int tileSize[2],
+                               int numberOfTiles[2]);
+
+  /// Window center of a camera of window center \a windowCenter narrowed to
+  /// the tile of \a tileSize pixels at \a origin in an image of \a size:
+  /// the offset of the tile center from the image center, in half tiles
+  static void GetTileWindowCenter(const int size[2], const int tileSize[2],
+                                  const int origin[2],
+                                  const double windowCenter[2],
+                                  double tileWindowCenter[2]);
+
+protected:
+  vtkSlicerCameraPathTileRenderer();
+  virtual ~vtkSlicerCameraPathTileRenderer();
+
+  int Size[2];
+
+  /// Pixels of the last tile rendered, reused for each tile
+  vtkImageData* Tile;
+
+private:
+
+  vtkSlicerCameraPathTileRenderer(const vtkSlicerCameraPathTileRenderer&); // Not implemented
+  void operator=(const vtkSlicerCameraPathTileRenderer&); // Not implemented
+};
+
+#endif
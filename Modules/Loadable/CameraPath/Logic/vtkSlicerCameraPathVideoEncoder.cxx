@@ -0,0 +1,413 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathExporter.h"
+#include "vtkSlicerCameraPathVideoEncoder.h"
+
+// VTK includes
+#include <vtkConditionVariable.h>
+#include <vtkImageData.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkRenderWindow.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <deque>
+#include <vector>
+
+//----------------------------------------------------------------------------
+class vtkSlicerCameraPathVideoEncoder::vtkInternal
+{
+public:
+  vtkInternal();
+
+  static VTK_THREAD_RETURN_TYPE EncodeFrames(void* arg);
+
+  /// Take a free buffer, or allocate one until the queue is full, else wait
+  /// for a buffer to be freed by the encoder thread
+  vtkImageData* AcquireFrame(size_t queueSize);
+  void QueueFrame(vtkImageData* frame);
+  void ReleaseFrame(vtkImageData* frame);
+
+  /// Let the encoder thread finish the queue and wait for it
+  void Stop();
+
+  vtkSlicerCameraPathVideoEncoder* Encoder;
+
+  vtkSimpleMutexLock Lock;
+  vtkConditionVariable FrameQueued;
+  vtkConditionVariable FrameEncoded;
+
+  std::vector<vtkSmartPointer<vtkImageData> > Frames;
+  std::vector<vtkImageData*> FreeFrames;
+  std::deque<vtkImageData*> QueuedFrames;
+  bool Stopping;
+
+  int Width;
+  int Height;
+  bool Failed;
+  int NumberOfFramesEncoded;
+  double EncodeTime;
+
+  vtkNew<vtkMultiThreader> Threader;
+  int ThreadId;
+};
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathVideoEncoder::vtkInternal::vtkInternal()
+  : Encoder(0)
+  , Stopping(false)
+  , Width(0)
+  , Height(0)
+  , Failed(false)
+  , NumberOfFramesEncoded(0)
+  , EncodeTime(0.0)
+  , ThreadId(-1)
+{
+}
+
+//----------------------------------------------------------------------------
+vtkImageData* vtkSlicerCameraPathVideoEncoder::vtkInternal::AcquireFrame(size_t queueSize)
+{
+  this->Lock.Lock();
+  while (this->FreeFrames.empty() && this->Frames.size() >= queueSize)
+    {
+    this->FrameEncoded.Wait(this->Lock);
+    }
+  vtkImageData* frame = 0;
+  if (!this->FreeFrames.empty())
+    {
+    frame = this->FreeFrames.back();
+    this->FreeFrames.pop_back();
+    }
+  else
+    {
+    this->Frames.push_back(vtkSmartPointer<vtkImageData>::New());
+    frame = this->Frames.back();
+    }
+  this->Lock.Unlock();
+  return frame;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathVideoEncoder::vtkInternal::QueueFrame(vtkImageData* frame)
+{
+  this->Lock.Lock();
+  this->QueuedFrames.push_back(frame);
+  this->FrameQueued.Signal();
+  this->Lock.Unlock();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathVideoEncoder::vtkInternal::ReleaseFrame(vtkImageData* frame)
+{
+  this->Lock.Lock();
+  this->FreeFrames.push_back(frame);
+  this->FrameEncoded.Signal();
+  this->Lock.Unlock();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathVideoEncoder::vtkInternal::Stop()
+{
+  if (this->ThreadId < 0)
+    {
+    return;
+    }
+  this->Lock.Lock();
+  this->Stopping = true;
+  this->FrameQueued.Signal();
+  this->Lock.Unlock();
+  this->Threader->TerminateThread(this->ThreadId);
+  this->ThreadId = -1;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkSlicerCameraPathVideoEncoder::vtkInternal::EncodeFrames(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkInternal* internal = static_cast<vtkInternal*>(info->UserData);
+
+  while (true)
+    {
+    internal->Lock.Lock();
+    while (internal->QueuedFrames.empty() && !internal->Stopping)
+      {
+      internal->FrameQueued.Wait(internal->Lock);
+      }
+    if (internal->QueuedFrames.empty())
+      {
+      internal->Lock.Unlock();
+      break;
+      }
+    vtkImageData* frame = internal->QueuedFrames.front();
+    internal->QueuedFrames.pop_front();
+    bool failed = internal->Failed;
+    internal->Lock.Unlock();
+
+    // Frames queued after a failure are dropped, the video is lost anyway
+    double start = vtkTimerLog::GetUniversalTime();
+    bool success = !failed && internal->Encoder->EncodeFrame(frame);
+    double encodeTime = vtkTimerLog::GetUniversalTime() - start;
+
+    internal->Lock.Lock();
+    internal->FreeFrames.push_back(frame);
+    internal->EncodeTime += encodeTime;
+    if (success)
+      {
+      ++internal->NumberOfFramesEncoded;
+      }
+    else
+      {
+      internal->Failed = true;
+      }
+    internal->FrameEncoded.Signal();
+    internal->Lock.Unlock();
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathVideoEncoder::vtkSlicerCameraPathVideoEncoder()
+{
+  this->FileName = 0;
+  this->Rate = 30;
+  this->Codec = H264;
+  this->ConstantRateFactor = 23;
+  this->BitRate = 8000;
+  this->GOPSize = 0;
+  this->NumberOfThreads = 0;
+  this->QueueSize = 4;
+  this->Internal = new vtkInternal;
+  this->Internal->Encoder = this;
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraPathVideoEncoder::~vtkSlicerCameraPathVideoEncoder()
+{
+  // Subclasses call End() to finish their video, the thread only remains
+  // if they did not
+  this->Internal->Stop();
+  this->SetFileName(0);
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraPathVideoEncoder::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "FileName: " << (this->FileName ? this->FileName : "(none)") << "\n";
+  os << indent << "Rate: " << this->Rate << "\n";
+  os << indent << "Codec: " << GetCodecName(this->Codec) << "\n";
+  os << indent << "ConstantRateFactor: " << this->ConstantRateFactor << "\n";
+  os << indent << "BitRate: " << this->BitRate << "\n";
+  os << indent << "GOPSize: " << this->GOPSize << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "QueueSize: " << this->QueueSize << "\n";
+}
+
+//----------------------------------------------------------------------------
+const char* vtkSlicerCameraPathVideoEncoder::GetCodecName(int codec)
+{
+  switch (codec)
+    {
+    case H264:
+      return "H.264";
+    case H265:
+      return "H.265";
+    case VP9:
+      return "VP9";
+    case MPEG4:
+      return "MPEG-4";
+    default:
+      return "Unknown";
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCameraPathVideoEncoder::GetDefaultConstantRateFactor(int codec,
+                                                                  int quality)
+{
+  // Low, medium and high qualities. MPEG-4 maps the H.264 scale to its
+  // quantizer or quality.
+  static const int h264Factors[3] = {28, 23, 18};
+  static const int h265Factors[3] = {32, 28, 23};
+  static const int vp9Factors[3] = {40, 33, 24};
+  quality = quality < 0 ? 0 : (quality > 2 ? 2 : quality);
+  switch (codec)
+    {
+    case H265:
+      return h265Factors[quality];
+    case VP9:
+      return vp9Factors[quality];
+    case H264:
+    case MPEG4:
+    default:
+      return h264Factors[quality];
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathVideoEncoder::Start(int width, int height)
+{
+  if (this->Internal->ThreadId >= 0)
+    {
+    vtkErrorMacro("Start: the encoder is already started");
+    return false;
+    }
+  if (width <= 0 || height <= 0 || this->Rate <= 0)
+    {
+    vtkErrorMacro("Start: invalid frame size or rate");
+    return false;
+    }
+  if (this->ConstantRateFactor < 0 && this->BitRate <= 0)
+    {
+    vtkErrorMacro("Start: no constant rate factor nor bit rate");
+    return false;
+    }
+  if (!this->StartEncoder(width, height))
+    {
+    return false;
+    }
+
+  this->Internal->Width = width;
+  this->Internal->Height = height;
+  this->Internal->Stopping = false;
+  this->Internal->Failed = false;
+  this->Internal->NumberOfFramesEncoded = 0;
+  this->Internal->EncodeTime = 0.0;
+
+  // A single thread keeps the frames in order, the codec has its own
+  // worker threads
+  this->Internal->ThreadId = this->Internal->Threader->SpawnThread(
+    vtkInternal::EncodeFrames, this->Internal);
+  if (this->Internal->ThreadId < 0)
+    {
+    vtkErrorMacro("Start: unable to start the encoder thread");
+    this->EndEncoder();
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathVideoEncoder::AddFrame(vtkImageData* image)
+{
+  int dimensions[3] = {0, 0, 0};
+  if (image)
+    {
+    image->GetDimensions(dimensions);
+    }
+  if (!image || !image->GetPointData()->GetScalars() ||
+      image->GetScalarType() != VTK_UNSIGNED_CHAR ||
+      dimensions[0] != this->Internal->Width ||
+      dimensions[1] != this->Internal->Height)
+    {
+    vtkErrorMacro("AddFrame: the frame must be an RGB image of "
+                  << this->Internal->Width << "x" << this->Internal->Height);
+    return false;
+    }
+  if (this->Internal->ThreadId < 0)
+    {
+    vtkErrorMacro("AddFrame: the encoder is not started");
+    return false;
+    }
+
+  vtkImageData* frame = this->Internal->AcquireFrame(
+    this->QueueSize > 0 ? this->QueueSize : 1);
+  // The buffer is not shared until it is queued
+  vtkSlicerCameraPathExporter::CopyPixels(image, frame);
+  this->Internal->QueueFrame(frame);
+
+  this->Internal->Lock.Lock();
+  bool failed = this->Internal->Failed;
+  this->Internal->Lock.Unlock();
+  return !failed;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathVideoEncoder::AddFrame(vtkRenderWindow* renderWindow)
+{
+  if (!renderWindow)
+    {
+    vtkErrorMacro("AddFrame: invalid frame");
+    return false;
+    }
+  int* size = renderWindow->GetSize();
+  if (size[0] != this->Internal->Width || size[1] != this->Internal->Height)
+    {
+    vtkErrorMacro("AddFrame: the window must be of "
+                  << this->Internal->Width << "x" << this->Internal->Height);
+    return false;
+    }
+  if (this->Internal->ThreadId < 0)
+    {
+    vtkErrorMacro("AddFrame: the encoder is not started");
+    return false;
+    }
+
+  vtkImageData* frame = this->Internal->AcquireFrame(
+    this->QueueSize > 0 ? this->QueueSize : 1);
+  if (!vtkSlicerCameraPathExporter::ReadPixels(renderWindow, frame))
+    {
+    this->Internal->ReleaseFrame(frame);
+    vtkErrorMacro("AddFrame: unable to read the pixels of the render window");
+    return false;
+    }
+  this->Internal->QueueFrame(frame);
+
+  this->Internal->Lock.Lock();
+  bool failed = this->Internal->Failed;
+  this->Internal->Lock.Unlock();
+  return !failed;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCameraPathVideoEncoder::End()
+{
+  if (this->Internal->ThreadId < 0)
+    {
+    return false;
+    }
+  this->Internal->Stop();
+  bool ended = this->EndEncoder();
+  return ended && !this->Internal->Failed;
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCameraPathVideoEncoder::GetNumberOfFramesEncoded()
+{
+  this->Internal->Lock.Lock();
+  int numberOfFramesEncoded = this->Internal->NumberOfFramesEncoded;
+  this->Internal->Lock.Unlock();
+  return numberOfFramesEncoded;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerCameraPathVideoEncoder::GetEncodeTime()
+{
+  this->Internal->Lock.Lock();
+  double encodeTime = this->Internal->EncodeTime;
+  this->Internal->Lock.Unlock();
+  return encodeTime;
+}
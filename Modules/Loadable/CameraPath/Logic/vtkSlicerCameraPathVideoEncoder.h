@@ -0,0 +1,156 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// .NAME vtkSlicerCameraPathVideoEncoder - threaded video encoder backend
+// .SECTION Description
+// Base class of the video encoders of exported camera paths. Frames read
+// back on the calling thread are copied into pooled buffers and queued, an
+// encoder thread hands them in order to the backend, so that encoding the
+// previous frames overlaps rendering the next ones. The queue is bounded:
+// AddFrame() waits for a free buffer when the encoder falls behind.
+// Subclasses implement StartEncoder(), EncodeFrame() and EndEncoder(), and
+// map the codec, rate control, GOP and thread settings to their encoder.
+// .SECTION See Also
+// vtkSlicerCameraPathCommandEncoder, vtkSlicerCameraPathFFMPEGEncoder
+
+#ifndef __vtkSlicerCameraPathVideoEncoder_h
+#define __vtkSlicerCameraPathVideoEncoder_h
+
+// VTK includes
+#include <vtkObject.h>
+
+#include "vtkSlicerCameraPathModuleLogicExport.h"
+
+class vtkImageData;
+class vtkRenderWindow;
+
+/// \ingroup Slicer_QtModules_CameraPath
+class VTK_SLICER_CAMERAPATH_MODULE_LOGIC_EXPORT vtkSlicerCameraPathVideoEncoder :
+  public vtkObject
+{
+public:
+
+  vtkAbstractTypeMacro(vtkSlicerCameraPathVideoEncoder, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  enum Codecs
+  {
+    H264 = 0,
+    H265,
+    VP9,
+    MPEG4
+  };
+
+  /// Output video file
+  vtkSetStringMacro(FileName);
+  vtkGetStringMacro(FileName);
+
+  /// Number of frames per second, 30 by default
+  vtkSetMacro(Rate, int);
+  vtkGetMacro(Rate, int);
+
+  /// Codec of the video, H264 by default
+  vtkSetClampMacro(Codec, int, H264, MPEG4);
+  vtkGetMacro(Codec, int);
+
+  /// Constant rate factor of the codec, lower is better, 23 by default.
+  /// -1 encodes at BitRate instead.
+  vtkSetClampMacro(ConstantRateFactor, int, -1, 63);
+  vtkGetMacro(ConstantRateFactor, int);
+
+  /// Target bit rate in kbit/s, used if ConstantRateFactor is -1
+  vtkSetMacro(BitRate, int);
+  vtkGetMacro(BitRate, int);
+
+  /// Maximum number of frames between key frames.
+  /// 0 (default) uses the default of the codec.
+  vtkSetMacro(GOPSize, int);
+  vtkGetMacro(GOPSize, int);
+
+  /// Number of worker threads of the codec.
+  /// 0 (default) lets the codec choose from the number of processors.
+  vtkSetMacro(NumberOfThreads, int);
+  vtkGetMacro(NumberOfThreads, int);
+
+  /// Maximum number of frames buffered, waiting or being encoded, 4 by
+  /// default
+  vtkSetMacro(QueueSize, int);
+  vtkGetMacro(QueueSize, int);
+
+  /// Start the backend for frames of \a width by \a height pixels and the
+  /// encoder thread
+  bool Start(int width, int height);
+
+  /// Copy the pixels of \a image and queue them to be encoded. Wait for a
+  /// free buffer if the queue is full. \a image must be an unsigned char
+  /// RGB image of the size given to Start().
+  bool AddFrame(vtkImageData* image);
+
+  /// Read the pixels of the last render of \a renderWindow straight into a
+  /// pooled buffer and queue them to be encoded. Must be called from the
+  /// thread rendering the window.
+  bool AddFrame(vtkRenderWindow* renderWindow);
+
+  /// Wait for the queued frames to be encoded, stop the encoder thread and
+  /// finish the video. Return false if a frame could not be encoded.
+  bool End();
+
+  int GetNumberOfFramesEncoded();
+
+  /// Time spent by the encoder thread in the backend, in seconds
+  double GetEncodeTime();
+
+  /// Short name of \a codec, e.g. "H.264"
+  static const char* GetCodecName(int codec);
+
+  /// Usual constant rate factor of \a codec for a low (0), medium (1) or
+  /// high (2) quality. The scales differ between codecs, e.g. 23 is a
+  /// medium quality with H.264 but a high one with VP9.
+  static int GetDefaultConstantRateFactor(int codec, int quality);
+
+protected:
+  vtkSlicerCameraPathVideoEncoder();
+  virtual ~vtkSlicerCameraPathVideoEncoder();
+
+  /// Open the video, called by Start() on the calling thread
+  virtual bool StartEncoder(int width, int height) = 0;
+
+  /// Encode a frame, called in order on the encoder thread
+  virtual bool EncodeFrame(vtkImageData* image) = 0;
+
+  /// Finish the video, called by End() once the encoder thread stopped
+  virtual bool EndEncoder() = 0;
+
+  char* FileName;
+  int Rate;
+  int Codec;
+  int ConstantRateFactor;
+  int BitRate;
+  int GOPSize;
+  int NumberOfThreads;
+  int QueueSize;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+
+  vtkSlicerCameraPathVideoEncoder(const vtkSlicerCameraPathVideoEncoder&); // Not implemented
+  void operator=(const vtkSlicerCameraPathVideoEncoder&); // Not implemented
+};
+
+#endif
@@ -7,11 +7,15 @@
 #include "vtkMRMLCameraPathStorageNode.h"
 
 // VTK includes
+#include <vtkCamera.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 
 // STD includes
 #include <sstream>
+#include <string>
 #include <utility>
 #include <vector>
 #include <algorithm>
@@ -38,6 +42,13 @@ public:
   vtkSmartPointer<vtkMRMLPointSplineNode> FocalPoints;
   vtkSmartPointer<vtkMRMLPointSplineNode> ViewUps;
 
+  struct RigCamera
+  {
+    std::string Name;
+    double Transform[16];
+  };
+  std::vector<RigCamera> Rig;
+
   vtkMRMLCameraPathNode* External;
 };
 
@@ -76,6 +87,72 @@ vtkMRMLCameraPathNode::~vtkMRMLCameraPathNode()
   delete this->Internal;
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLCameraPathNode::ReadXMLAttributes(const char** atts)
+{
+  int disabledModify = this->StartModify();
+
+  this->Superclass::ReadXMLAttributes(atts);
+
+  const char* attName;
+  const char* attValue;
+  while (*atts != NULL)
+    {
+    attName = *(atts++);
+    attValue = *(atts++);
+    if (!strcmp(attName, "rigCameras"))
+      {
+      // "name m0 ... m15" entries separated by semicolons
+      this->Internal->Rig.clear();
+      std::stringstream ss(attValue);
+      std::string entry;
+      while (std::getline(ss, entry, ';'))
+        {
+        std::stringstream entryStream(entry);
+        vtkInternal::RigCamera rigCamera;
+        if (!(entryStream >> rigCamera.Name))
+          {
+          continue;
+          }
+        int i = 0;
+        for (; i < 16 && (entryStream >> rigCamera.Transform[i]); ++i)
+          {
+          }
+        if (i != 16)
+          {
+          vtkWarningMacro("ReadXMLAttributes: invalid rig camera " << rigCamera.Name);
+          continue;
+          }
+        this->Internal->Rig.push_back(rigCamera);
+        }
+      }
+    }
+
+  this->EndModify(disabledModify);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLCameraPathNode::WriteXML(ostream& of, int nIndent)
+{
+  this->Superclass::WriteXML(of, nIndent);
+
+  if (this->Internal->Rig.empty())
+    {
+    return;
+    }
+  vtkIndent indent(nIndent);
+  of << indent << " rigCameras=\"";
+  for (size_t i = 0; i < this->Internal->Rig.size(); ++i)
+    {
+    of << (i == 0 ? "" : ";") << this->Internal->Rig[i].Name;
+    for (int j = 0; j < 16; ++j)
+      {
+      of << " " << this->Internal->Rig[i].Transform[j];
+      }
+    }
+  of << "\"";
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLCameraPathNode::Copy(vtkMRMLNode *anode)
 {
@@ -101,10 +178,11 @@ void vtkMRMLCameraPathNode::Copy(vtkMRMLNode *anode)
   FocalPoints->Copy(node->GetFocalPointSplines());
   ViewUps->Copy(node->GetViewUpSplines());
 
-  this->SetKeyFrames(KeyFrames);
+  this->SetKeyFrames(KeyFrames, false);
   this->SetPointSplines(Positions.GetPointer(),
                         FocalPoints.GetPointer(),
                         ViewUps.GetPointer());
+  this->Internal->Rig = node->Internal->Rig;
 
   this->EndModify(disabledModify);
 }
@@ -118,6 +196,7 @@ void vtkMRMLCameraPathNode::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "NumberOfKeyFrames: " << numPts << "\n";
   os << indent << "MinimumT: " << this->GetMinimumT() << "\n";
   os << indent << "MaximumT: " << this->GetMaximumT() << "\n";
+  os << indent << "NumberOfRigCameras: " << this->GetNumberOfRigCameras() << "\n";
 
   for( vtkIdType i = 0; i < numPts; ++i)
     {
@@ -224,12 +303,35 @@ void vtkMRMLCameraPathNode::GetKeyFrameViewUp(vtkIdType index,
 
 //----------------------------------------------------------------------------
 void vtkMRMLCameraPathNode::SetKeyFrames(KeyFrameVector keyFrames)
+{
+  this->SetKeyFrames(keyFrames, true);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLCameraPathNode::SetKeyFrames(KeyFrameVector keyFrames,
+                                         bool createPath)
 {
   this->Internal->KeyFrames = keyFrames;
   this->SortKeyFrames();
 
+  // Update splines
+  this->GetPositionSplines()->RemoveAllPoints();
+  this->GetFocalPointSplines()->RemoveAllPoints();
+  this->GetViewUpSplines()->RemoveAllPoints();
+  for (KeyFrameVector::iterator it = this->Internal->KeyFrames.begin();
+       it != this->Internal->KeyFrames.end(); ++it)
+    {
+    this->GetPositionSplines()->AddPoint(it->Time, it->Camera->GetPosition());
+    this->GetFocalPointSplines()->AddPoint(it->Time, it->Camera->GetFocalPoint());
+    this->GetViewUpSplines()->AddPoint(it->Time, it->Camera->GetViewUp());
+    }
+  if (createPath)
+    {
+    this->CreatePath();
+    }
+
   this->Modified();
-  // TODO : Update splines
+  this->InvokeEvent(KeyFramesResetEvent);
 }
 
 //----------------------------------------------------------------------------
@@ -270,6 +372,8 @@ void vtkMRMLCameraPathNode::SetKeyFrame(vtkIdType index, KeyFrame keyFrame)
   this->CreatePath();
 
   this->Modified();
+  double times[2] = {oldKeyFrame.Time, keyFrame.Time};
+  this->InvokeEvent(KeyFrameModifiedEvent, times);
 }
 
 //----------------------------------------------------------------------------
@@ -309,6 +413,8 @@ void vtkMRMLCameraPathNode::SetKeyFrameTime(vtkIdType index, double time)
   this->CreatePath();
 
   this->Modified();
+  double times[2] = {oldKeyFrame.Time, time};
+  this->InvokeEvent(KeyFrameModifiedEvent, times);
 }
 
 //----------------------------------------------------------------------------
@@ -339,6 +445,8 @@ void vtkMRMLCameraPathNode::SetKeyFrameCamera(vtkIdType index,
   this->CreatePath();
 
   this->Modified();
+  double times[2] = {time, time};
+  this->InvokeEvent(KeyFrameModifiedEvent, times);
 }
 
 //----------------------------------------------------------------------------
@@ -367,6 +475,8 @@ void vtkMRMLCameraPathNode::SetKeyFramePosition(vtkIdType index,
   this->CreatePath();
 
   this->Modified();
+  double times[2] = {time, time};
+  this->InvokeEvent(KeyFrameModifiedEvent, times);
 }
 
 //----------------------------------------------------------------------------
@@ -394,6 +504,8 @@ void vtkMRMLCameraPathNode::SetKeyFrameFocalPoint(vtkIdType index,
   this->GetFocalPointSplines()->AddPoint(time, focalPoint);
 
   this->Modified();
+  double times[2] = {time, time};
+  this->InvokeEvent(KeyFrameModifiedEvent, times);
 }
 
 //----------------------------------------------------------------------------
@@ -421,6 +533,8 @@ void vtkMRMLCameraPathNode::SetKeyFrameViewUp(vtkIdType index,
   this->GetViewUpSplines()->AddPoint(time, viewUp);
 
   this->Modified();
+  double times[2] = {time, time};
+  this->InvokeEvent(KeyFrameModifiedEvent, times);
 }
 
 //---------------------------------------------------------------------------
@@ -445,6 +559,7 @@ void vtkMRMLCameraPathNode::AddKeyFrame(KeyFrame keyFrame)
   this->CreatePath();
 
   this->Modified();
+  this->InvokeEvent(KeyFrameAddedEvent, &t);
 }
 
 //---------------------------------------------------------------------------
@@ -500,6 +615,7 @@ void vtkMRMLCameraPathNode::RemoveKeyFrames()
   this->Internal->KeyFrames.clear();
 
   this->Modified();
+  this->InvokeEvent(KeyFramesResetEvent);
 }
 
 //---------------------------------------------------------------------------
@@ -526,6 +642,7 @@ void vtkMRMLCameraPathNode::RemoveKeyFrame(vtkIdType index)
               this->Internal->KeyFrames.begin() + index);
 
   this->Modified();
+  this->InvokeEvent(KeyFrameRemovedEvent, &t);
 }
 
 
@@ -595,14 +712,179 @@ void vtkMRMLCameraPathNode::SetPointSplines(vtkMRMLPointSplineNode* positions,
 void vtkMRMLCameraPathNode::GetCameraAt(double t,
                       vtkMRMLCameraNode* camera)
 {
-  double position[3], focalPoint[3], viewUp[3];
-  this->GetPositionAt(t, position);
-  this->GetFocalPointAt(t, focalPoint);
-  this->GetViewUpAt(t, viewUp);
+  CameraPose pose;
+  this->GetPoseAt(t, pose);
+  vtkMRMLCameraPathNode::ApplyCameraPose(camera, pose);
+}
 
-  camera->SetPosition(position);
-  camera->SetFocalPoint(focalPoint);
-  camera->SetViewUp(viewUp);
+//---------------------------------------------------------------------------
+void vtkMRMLCameraPathNode::GetPoseAt(double t, CameraPose& pose)
+{
+  t = this->ClampTime(t);
+  this->GetPositionSplines()->Evaluate(t, pose.Position);
+  this->GetFocalPointSplines()->Evaluate(t, pose.FocalPoint);
+  this->GetViewUpSplines()->Evaluate(t, pose.ViewUp);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLCameraPathNode::ApplyCameraPose(vtkMRMLCameraNode* camera,
+                                            const CameraPose& pose,
+                                            const double* clippingRange)
+{
+  if (!camera)
+    {
+    return;
+    }
+
+  // the camera node forwards each vtkCamera modification, only send one
+  int wasModifying = camera->StartModify();
+  camera->SetPosition(const_cast<double*>(pose.Position));
+  camera->SetFocalPoint(const_cast<double*>(pose.FocalPoint));
+  camera->SetViewUp(const_cast<double*>(pose.ViewUp));
+  if (clippingRange && camera->GetCamera())
+    {
+    camera->GetCamera()->SetClippingRange(clippingRange[0], clippingRange[1]);
+    }
+  camera->EndModify(wasModifying);
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLCameraPathNode::GetNumberOfRigCameras()
+{
+  return static_cast<int>(this->Internal->Rig.size());
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLCameraPathNode::AddRigCamera(const char* name, vtkMatrix4x4* transform)
+{
+  vtkInternal::RigCamera rigCamera;
+  rigCamera.Name = name ? name : "";
+  vtkMatrix4x4::DeepCopy(rigCamera.Transform, transform);
+  this->Internal->Rig.push_back(rigCamera);
+  this->Modified();
+  return this->GetNumberOfRigCameras() - 1;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLCameraPathNode::RemoveRigCameras()
+{
+  if (this->Internal->Rig.empty())
+    {
+    return;
+    }
+  this->Internal->Rig.clear();
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+const char* vtkMRMLCameraPathNode::GetRigCameraName(int index)
+{
+  if (index < 0 || index >= this->GetNumberOfRigCameras())
+    {
+    vtkErrorMacro("GetRigCameraName: invalid index " << index);
+    return NULL;
+    }
+  return this->Internal->Rig[index].Name.c_str();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLCameraPathNode::GetRigCameraTransform(int index, vtkMatrix4x4* transform)
+{
+  if (index < 0 || index >= this->GetNumberOfRigCameras() || !transform)
+    {
+    vtkErrorMacro("GetRigCameraTransform: invalid index " << index);
+    return;
+    }
+  transform->DeepCopy(this->Internal->Rig[index].Transform);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLCameraPathNode::SetRigCameraTransform(int index, vtkMatrix4x4* transform)
+{
+  if (index < 0 || index >= this->GetNumberOfRigCameras() || !transform)
+    {
+    vtkErrorMacro("SetRigCameraTransform: invalid index " << index);
+    return;
+    }
+  vtkMatrix4x4::DeepCopy(this->Internal->Rig[index].Transform, transform);
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLCameraPathNode::SetStereoRig(double eyeSeparation)
+{
+  int disabledModify = this->StartModify();
+  this->RemoveRigCameras();
+  vtkNew<vtkMatrix4x4> transform;
+  transform->SetElement(0, 3, -eyeSeparation / 2.0);
+  this->AddRigCamera("Left", transform.GetPointer());
+  transform->SetElement(0, 3, eyeSeparation / 2.0);
+  this->AddRigCamera("Right", transform.GetPointer());
+  this->EndModify(disabledModify);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLCameraPathNode::GetRigPose(int index, const CameraPose& pose,
+                                       CameraPose& rigPose)
+{
+  if (index < 0 || index >= this->GetNumberOfRigCameras())
+    {
+    vtkErrorMacro("GetRigPose: invalid index " << index);
+    rigPose = pose;
+    return;
+    }
+  ComputeRigPose(pose, this->Internal->Rig[index].Transform, rigPose);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLCameraPathNode::GetRigPosesAt(double t, std::vector<CameraPose>& poses)
+{
+  CameraPose pose;
+  this->GetPoseAt(t, pose);
+
+  poses.resize(this->Internal->Rig.size());
+  for (size_t i = 0; i < this->Internal->Rig.size(); ++i)
+    {
+    ComputeRigPose(pose, this->Internal->Rig[i].Transform, poses[i]);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLCameraPathNode::ComputeRigPose(const CameraPose& pose,
+                                           const double transform[16],
+                                           CameraPose& rigPose)
+{
+  // path camera frame
+  double z[3];
+  vtkMath::Subtract(pose.Position, pose.FocalPoint, z);
+  double distance = vtkMath::Normalize(z);
+  double y[3] = {pose.ViewUp[0], pose.ViewUp[1], pose.ViewUp[2]};
+  double projection = vtkMath::Dot(y, z);
+  for (int i = 0; i < 3; ++i)
+    {
+    y[i] -= projection * z[i];
+    }
+  vtkMath::Normalize(y);
+  double x[3];
+  vtkMath::Cross(y, z, x);
+
+  // rig camera position, focal point and view up in the path camera frame
+  const double* m = transform;
+  double position[3] = {m[3], m[7], m[11]};
+  double focalPoint[3] = {m[3] - distance * m[2],
+                          m[7] - distance * m[6],
+                          m[11] - distance * m[10]};
+  double viewUp[3] = {m[1], m[5], m[9]};
+
+  for (int i = 0; i < 3; ++i)
+    {
+    rigPose.Position[i] = pose.Position[i] +
+      position[0] * x[i] + position[1] * y[i] + position[2] * z[i];
+    rigPose.FocalPoint[i] = pose.Position[i] +
+      focalPoint[0] * x[i] + focalPoint[1] * y[i] + focalPoint[2] * z[i];
+    rigPose.ViewUp[i] =
+      viewUp[0] * x[i] + viewUp[1] * y[i] + viewUp[2] * z[i];
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -622,7 +904,7 @@ void vtkMRMLCameraPathNode::GetFocalPointAt(double t, double focalPoint[3])
 //---------------------------------------------------------------------------
 void vtkMRMLCameraPathNode::GetViewUpAt(double t, double viewUp[3])
 {
-  this->ClampTime(t);
+  t = this->ClampTime(t);
   this->GetViewUpSplines()->Evaluate(t, viewUp);
 }
 
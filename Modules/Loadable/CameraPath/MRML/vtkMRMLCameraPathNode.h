@@ -6,6 +6,10 @@
 #include "vtkMRMLPointSplineNode.h"
 #include <vtkMRMLCameraNode.h>
 #include <vtkMRMLStorableNode.h>
+
+// VTK includes
+#include <vtkCommand.h>
+class vtkMatrix4x4;
 class vtkMRMLStorageNode;
 
 // STD includes
@@ -55,6 +59,14 @@ struct timeEqual
     }
 };
 
+/// Camera position, focal point and view up at a given time of the path
+struct CameraPose
+{
+  double Position[3];
+  double FocalPoint[3];
+  double ViewUp[3];
+};
+
 /// \brief MRML node to hold the information about a camera path.
 ///
 class VTK_SLICER_CAMERAPATH_MODULE_MRML_EXPORT vtkMRMLCameraPathNode:
@@ -67,6 +79,19 @@ public:
         PATH_NOT_UP_TO_DATE,
         PATH_UP_TO_DATE};
 
+  /// Keyframe events, invoked after the keyframe operation.
+  /// KeyFrameAddedEvent and KeyFrameRemovedEvent pass the keyframe time
+  /// (double*), KeyFrameModifiedEvent passes the old and new keyframe times
+  /// (double[2]). KeyFramesResetEvent is invoked when all the keyframes are
+  /// replaced or removed.
+  enum
+    {
+    KeyFrameAddedEvent = vtkCommand::UserEvent + 310,
+    KeyFrameRemovedEvent,
+    KeyFrameModifiedEvent,
+    KeyFramesResetEvent
+    };
+
   static vtkMRMLCameraPathNode *New();
   vtkTypeMacro(vtkMRMLCameraPathNode,vtkMRMLStorableNode)
   virtual void PrintSelf(ostream& os, vtkIndent indent);
@@ -76,6 +101,12 @@ public:
   //--------------------------------------------------------------------------
   virtual vtkMRMLNode* CreateNodeInstance();
 
+  /// Read node attributes from XML file
+  virtual void ReadXMLAttributes(const char** atts);
+
+  /// Write this node's information to a MRML file in XML format.
+  virtual void WriteXML(ostream& of, int indent);
+
   /// Copy the node's attributes to this object
   virtual void Copy(vtkMRMLNode *node);
 
@@ -103,6 +134,10 @@ public:
   void GetKeyFrameViewUp(vtkIdType index, double viewUp[3] = 0);
 
   void SetKeyFrames(KeyFrameVector keyFrames);
+  /// Replace all the keyframes and rebuild the splines in one pass.
+  /// If \a createPath is false, the sampled path is left for the caller to
+  /// set, e.g. from a cache.
+  void SetKeyFrames(KeyFrameVector keyFrames, bool createPath);
   void SetKeyFrame(vtkIdType index, KeyFrame keyFrame);
   void SetKeyFrameTime(vtkIdType index, double time);
   void SetKeyFrameCamera(vtkIdType index, vtkMRMLCameraNode* camera);
@@ -134,11 +169,48 @@ public:
                        vtkMRMLPointSplineNode* viewUps);
 
   void GetCameraAt(double t, vtkMRMLCameraNode* camera);
+  /// Evaluate the position, focal point and view up splines at \a t
+  void GetPoseAt(double t, CameraPose& pose);
+  /// Set the pose of \a camera, and its clipping range if not null, in a
+  /// single modify block so that the camera node is only modified once.
+  static void ApplyCameraPose(vtkMRMLCameraNode* camera,
+                              const CameraPose& pose,
+                              const double* clippingRange = 0);
   void GetPositionAt(double t, double position[3] = 0);
   void GetFocalPointAt(double t, double focalPoint[3] = 0);
   void GetViewUpAt(double t, double viewUp[3] = 0);
   double ClampTime(double t);
 
+  //--------------------------------------------------------------------------
+  /// Camera rig methods
+  //--------------------------------------------------------------------------
+
+  /// Rig cameras follow the path with a fixed transform relative to the
+  /// path camera, e.g. a stereo pair. Transforms are expressed in the path
+  /// camera frame: x to the right, y up and z backwards, the focal point
+  /// being on -z at the focal distance. The rig is saved with the scene,
+  /// rig camera names should not contain spaces or semicolons.
+  int GetNumberOfRigCameras();
+  /// Add a rig camera and return its index
+  int AddRigCamera(const char* name, vtkMatrix4x4* transform);
+  void RemoveRigCameras();
+  const char* GetRigCameraName(int index);
+  void GetRigCameraTransform(int index, vtkMatrix4x4* transform);
+  void SetRigCameraTransform(int index, vtkMatrix4x4* transform);
+  /// Replace the rig by a "Left" and a "Right" camera, translated by half
+  /// of \a eyeSeparation on each side with parallel view directions.
+  void SetStereoRig(double eyeSeparation);
+
+  /// Pose of the rig camera \a index when the path camera is at \a pose
+  void GetRigPose(int index, const CameraPose& pose, CameraPose& rigPose);
+  /// Evaluate the path once at \a t and derive the pose of every rig camera
+  void GetRigPosesAt(double t, std::vector<CameraPose>& poses);
+  /// Pose of a camera placed by \a transform (row major 4x4 matrix)
+  /// relative to a camera at \a pose
+  static void ComputeRigPose(const CameraPose& pose,
+                             const double transform[16],
+                             CameraPose& rigPose);
+
 protected:
   vtkMRMLCameraPathNode();
   virtual ~vtkMRMLCameraPathNode();
@@ -0,0 +1,825 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkMRMLCameraPathParser.h"
+#include "vtkMRMLPointSplineNode.h"
+
+#include "vtkSlicerVersionConfigure.h"
+
+#include "vtkObjectFactory.h"
+#include <vtksys/MD5.h>
+#include <vtksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <sstream>
+
+namespace
+{
+
+const char* const CHANNEL_NAMES[3] = {"position", "focalPoint", "viewUp"};
+
+//----------------------------------------------------------------------------
+void ParseDoubles(const std::string& value, std::vector<double>& values)
+{
+  values.clear();
+  std::stringstream ss(value);
+  std::string component;
+  while (getline(ss, component, ','))
+    {
+    values.push_back(atof(component.c_str()));
+    }
+}
+
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkMRMLCameraPathParser);
+
+//----------------------------------------------------------------------------
+vtkMRMLCameraPathParser::vtkMRMLCameraPathParser()
+{
+  this->FileName = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLCameraPathParser::~vtkMRMLCameraPathParser()
+{
+  this->SetFileName(0);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLCameraPathParser::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "FileName: " << (this->FileName ? this->FileName : "(none)") << "\n";
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLCameraPathParser::ReadPathData(CameraPathData& data,
+                                         bool computePath)
+{
+  std::string fullName = this->FileName ? this->FileName : "";
+
+  if (fullName == std::string(""))
+    {
+    vtkErrorMacro("vtkMRMLCameraPathParser: File name not specified");
+    return 0;
+    }
+
+  // open the file for reading input
+  fstream fstr;
+  fstr.open(fullName.c_str(), fstream::in);
+  if (!fstr.is_open())
+    {
+    vtkErrorMacro("ReadData: unable to open file " << fullName.c_str() << " for reading");
+    return 0;
+    }
+
+  data = CameraPathData();
+  std::set<double> keyFrameTimes;
+
+  // read file
+  std::string line;
+  while (getline(fstr, line))
+    {
+    // files written on windows
+    if (!line.empty() && line[line.size() - 1] == '\r')
+      {
+      line.erase(line.size() - 1);
+      }
+
+    // is it empty?
+    if (line.empty())
+      {
+      vtkDebugMacro("Empty line, skipping:\n\"" << line << "\"");
+      }
+    // does it start with a #?
+    else if (line[0] == '#')
+      {
+      vtkDebugMacro("Comment line, checking:\n\"" << line << "\"");
+      std::string key, value;
+      if (this->ParseCommentLine(line, key, value))
+        {
+        data.Comments[key] = value;
+        }
+      }
+    // keyframe line
+    else
+      {
+      std::stringstream ss(line);
+
+      double time;
+      double pose[9];
+
+      time = ReadNextLineComponentAsDouble(&ss);
+      for (int i = 0; i < 9; ++i)
+        {
+        pose[i] = ReadNextLineComponentAsDouble(&ss);
+        }
+
+      if (!keyFrameTimes.insert(time).second)
+        {
+        vtkWarningMacro("ReadData: a keyframe already exists for t = "
+                        << time << ", skipping");
+        continue;
+        }
+
+      data.Times.push_back(time);
+      data.Poses.insert(data.Poses.end(), pose, pose + 9);
+      data.KeyFrameLines.push_back(line);
+      }
+    }
+  fstr.close();
+
+  // edits made after the file was written
+  if (this->ReplayJournal(data) == 0)
+    {
+    data.PathComputed = this->ReadPathCache(data);
+    }
+  if (!data.PathComputed && computePath && data.Times.size() > 1)
+    {
+    // Sort keyframes by time as the camera path node does
+    std::vector<std::pair<double, size_t> > order;
+    for (size_t i = 0; i < data.Times.size(); ++i)
+      {
+      order.push_back(std::make_pair(data.Times[i], i));
+      }
+    std::sort(order.begin(), order.end());
+
+    std::vector<double> times;
+    std::vector<double> points[3];
+    for (size_t i = 0; i < order.size(); ++i)
+      {
+      times.push_back(order[i].first);
+      const double* pose = &data.Poses[9 * order[i].second];
+      for (int channel = 0; channel < 3; ++channel)
+        {
+        points[channel].insert(points[channel].end(),
+                               pose + 3 * channel, pose + 3 * channel + 3);
+        }
+      }
+
+    data.PathComputed = true;
+    for (int channel = 0; channel < 3; ++channel)
+      {
+      // only the position path is sampled, see vtkMRMLCameraPathNode::CreatePath
+      data.PathComputed = data.PathComputed &&
+        vtkMRMLPointSplineNode::ComputePath(times, points[channel],
+                                            data.Intervals[channel],
+                                            data.Coefficients[channel],
+                                            30, channel == 0 ? &data.Samples : 0);
+      }
+    }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+std::string vtkMRMLCameraPathParser::GetJournalFileName()
+{
+  std::string fullName = this->FileName ? this->FileName : "";
+  if (fullName.empty())
+    {
+    return fullName;
+    }
+  return fullName + ".journal";
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLCameraPathParser::AppendJournalEntry(const char* operation,
+                                               const double* values,
+                                               int numberOfValues)
+{
+  std::string journalName = this->GetJournalFileName();
+  if (journalName.empty() || !operation)
+    {
+    return 0;
+    }
+
+  fstream of;
+  of.open(journalName.c_str(), fstream::out | fstream::app);
+  if (!of.is_open())
+    {
+    vtkErrorMacro("AppendJournalEntry: unable to open file " << journalName.c_str() << " for writing");
+    return 0;
+    }
+
+  // build the line first so that it is written at once
+  of << FormatJournalEntry(operation, values, numberOfValues);
+  of.flush();
+  of.close();
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLCameraPathParser::ResetJournal(const CameraPathData& data)
+{
+  std::string journalName = this->GetJournalFileName();
+  if (journalName.empty())
+    {
+    return 0;
+    }
+
+  // a "clear" entry discards the previous ones: replace the journal
+  // instead of appending to it, through a temporary file so that a crash
+  // leaves either journal complete
+  std::string temporaryName = journalName + ".tmp";
+  fstream of;
+  of.open(temporaryName.c_str(), fstream::out | fstream::trunc);
+  if (!of.is_open())
+    {
+    vtkErrorMacro("ResetJournal: unable to open file " << temporaryName.c_str() << " for writing");
+    return 0;
+    }
+  of << FormatJournalEntry("clear", 0, 0);
+  std::vector<double> values(10);
+  for (size_t i = 0; i < data.Times.size(); ++i)
+    {
+    values[0] = data.Times[i];
+    std::copy(data.Poses.begin() + 9 * i, data.Poses.begin() + 9 * (i + 1),
+              values.begin() + 1);
+    of << FormatJournalEntry("add", &values[0], 10);
+    }
+  of.flush();
+  of.close();
+
+  // rename() does not replace an existing file on all platforms
+  if (rename(temporaryName.c_str(), journalName.c_str()) != 0)
+    {
+    vtksys::SystemTools::RemoveFile(journalName.c_str());
+    if (rename(temporaryName.c_str(), journalName.c_str()) != 0)
+      {
+      vtkErrorMacro("ResetJournal: unable to replace " << journalName.c_str());
+      vtksys::SystemTools::RemoveFile(temporaryName.c_str());
+      return 0;
+      }
+    }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+std::string vtkMRMLCameraPathParser::FormatJournalEntry(const char* operation,
+                                                       const double* values,
+                                                       int numberOfValues)
+{
+  std::stringstream ss;
+  ss << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+  ss << operation;
+  for (int i = 0; i < numberOfValues; ++i)
+    {
+    ss << "," << values[i];
+    }
+  ss << "\n";
+  return ss.str();
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLCameraPathParser::ReplayJournal(CameraPathData& data)
+{
+  std::string journalName = this->GetJournalFileName();
+  if (journalName.empty() ||
+      !vtksys::SystemTools::FileExists(journalName.c_str(), true))
+    {
+    return 0;
+    }
+
+  fstream fstr;
+  fstr.open(journalName.c_str(), fstream::in);
+  if (!fstr.is_open())
+    {
+    vtkErrorMacro("ReplayJournal: unable to open file " << journalName.c_str() << " for reading");
+    return 0;
+    }
+
+  int numberOfOperations = 0;
+  std::string line;
+  std::vector<double> values;
+  while (getline(fstr, line))
+    {
+    if (!line.empty() && line[line.size() - 1] == '\r')
+      {
+      line.erase(line.size() - 1);
+      }
+    std::string::size_type separator = line.find(',');
+    std::string operation = line.substr(0, separator);
+    values.clear();
+    if (separator != std::string::npos)
+      {
+      ParseDoubles(line.substr(separator + 1), values);
+      }
+
+    // time of the keyframe to remove, and index of the new pose in values
+    double removedTime = 0.0;
+    bool remove = false;
+    size_t pose = 0;
+    if (operation == "clear" && values.empty())
+      {
+      data.Times.clear();
+      data.Poses.clear();
+      }
+    else if (operation == "add" && values.size() == 10)
+      {
+      remove = true;
+      removedTime = values[0];
+      pose = 1;
+      }
+    else if (operation == "remove" && values.size() == 1)
+      {
+      remove = true;
+      removedTime = values[0];
+      }
+    else if (operation == "modify" && values.size() == 11)
+      {
+      remove = true;
+      removedTime = values[0];
+      pose = 2;
+      }
+    else
+      {
+      // last line may be truncated by a crash
+      vtkWarningMacro("ReplayJournal: invalid journal line, skipping:\n\"" << line << "\"");
+      continue;
+      }
+
+    if (remove)
+      {
+      std::vector<double>::iterator it =
+        std::find(data.Times.begin(), data.Times.end(), removedTime);
+      if (it != data.Times.end())
+        {
+        size_t index = it - data.Times.begin();
+        data.Times.erase(it);
+        data.Poses.erase(data.Poses.begin() + 9 * index,
+                         data.Poses.begin() + 9 * (index + 1));
+        }
+      }
+    if (pose > 0)
+      {
+      double time = values[pose - 1];
+      std::vector<double>::iterator it =
+        std::find(data.Times.begin(), data.Times.end(), time);
+      if (it != data.Times.end())
+        {
+        size_t index = it - data.Times.begin();
+        std::copy(values.begin() + pose, values.end(),
+                  data.Poses.begin() + 9 * index);
+        }
+      else
+        {
+        data.Times.push_back(time);
+        data.Poses.insert(data.Poses.end(), values.begin() + pose, values.end());
+        }
+      }
+    ++numberOfOperations;
+    }
+  fstr.close();
+
+  if (numberOfOperations > 0)
+    {
+    // keyframes no longer match the file, the path cache is not valid
+    data.KeyFrameLines.clear();
+    data.PathComputed = false;
+    }
+
+  return numberOfOperations;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLCameraPathParser::ReadHeader(CameraPathHeader& header)
+{
+  std::string fullName = this->FileName ? this->FileName : "";
+  if (fullName == std::string(""))
+    {
+    vtkErrorMacro("vtkMRMLCameraPathParser: File name not specified");
+    return 0;
+    }
+
+  fstream fstr;
+  fstr.open(fullName.c_str(), fstream::in);
+  if (!fstr.is_open())
+    {
+    vtkErrorMacro("ReadHeader: unable to open file " << fullName.c_str() << " for reading");
+    return 0;
+    }
+
+  header = CameraPathHeader();
+  header.FileName = fullName;
+
+  // the header is made of the comment lines before the first keyframe
+  std::map<std::string, std::string> comments;
+  std::string line;
+  while (getline(fstr, line))
+    {
+    if (!line.empty() && line[line.size() - 1] == '\r')
+      {
+      line.erase(line.size() - 1);
+      }
+    if (line.empty())
+      {
+      continue;
+      }
+    if (line[0] != '#')
+      {
+      break;
+      }
+    std::string key, value;
+    if (this->ParseCommentLine(line, key, value))
+      {
+      comments[key] = value;
+      }
+    }
+  fstr.close();
+
+  // the header does not count the keyframes edited since the file was
+  // written, they are only in its journal
+  bool journaled = vtksys::SystemTools::FileExists(
+    this->GetJournalFileName().c_str(), true);
+  if (!journaled && this->ParseHeader(comments, header))
+    {
+    return 1;
+    }
+
+  // older file or pending journal, read the keyframes and replay the journal
+  vtkDebugMacro("ReadHeader: no header or a journal for " << fullName.c_str()
+                << ", reading keyframes");
+  CameraPathData data;
+  if (!this->ReadPathData(data, false))
+    {
+    return 0;
+    }
+  this->ParseHeader(data.Comments, header);
+  this->ComputeHeader(data.Times, data.Poses, header);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLCameraPathParser::ComputeHeader(const std::vector<double>& times,
+                                           const std::vector<double>& poses,
+                                           CameraPathHeader& header)
+{
+  header.NumberOfKeyFrames = static_cast<int>(times.size());
+  if (times.empty())
+    {
+    return;
+    }
+
+  header.TimeRange[0] = *std::min_element(times.begin(), times.end());
+  header.TimeRange[1] = *std::max_element(times.begin(), times.end());
+
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    header.Bounds[2 * axis] = poses[axis];
+    header.Bounds[2 * axis + 1] = poses[axis];
+    }
+  for (size_t i = 1; i < times.size(); ++i)
+    {
+    const double* position = &poses[9 * i];
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      header.Bounds[2 * axis] = std::min(header.Bounds[2 * axis], position[axis]);
+      header.Bounds[2 * axis + 1] = std::max(header.Bounds[2 * axis + 1], position[axis]);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLCameraPathParser::ParseHeader(
+  const std::map<std::string, std::string>& comments, CameraPathHeader& header)
+{
+  std::map<std::string, std::string>::const_iterator it;
+  if ((it = comments.find("name")) != comments.end())
+    {
+    header.Name = it->second;
+    }
+  if ((it = comments.find("thumbnail")) != comments.end())
+    {
+    header.Thumbnail = it->second;
+    }
+
+  if ((it = comments.find("keyframes")) == comments.end())
+    {
+    return false;
+    }
+  header.NumberOfKeyFrames = atoi(it->second.c_str());
+
+  std::vector<double> values;
+  if ((it = comments.find("time range")) != comments.end())
+    {
+    ParseDoubles(it->second, values);
+    if (values.size() == 2)
+      {
+      std::copy(values.begin(), values.end(), header.TimeRange);
+      }
+    }
+  if ((it = comments.find("bounds")) != comments.end())
+    {
+    ParseDoubles(it->second, values);
+    if (values.size() == 6)
+      {
+      std::copy(values.begin(), values.end(), header.Bounds);
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLCameraPathParser::ParseCommentLine(const std::string& line,
+                                              std::string& key,
+                                              std::string& value)
+{
+  if (line.size() < 2 || line[0] != '#' || line[1] != ' ')
+    {
+    return false;
+    }
+  std::string::size_type separator = line.find(" = ");
+  if (separator == std::string::npos)
+    {
+    return false;
+    }
+  key = line.substr(2, separator - 2);
+  value = line.substr(separator + 3);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+std::string vtkMRMLCameraPathParser::ComputeKeyFramesChecksum(
+  const std::vector<std::string>& keyFrameLines)
+{
+  vtksysMD5* md5 = vtksysMD5_New();
+  vtksysMD5_Initialize(md5);
+  for (std::vector<std::string>::const_iterator it = keyFrameLines.begin();
+       it != keyFrameLines.end(); ++it)
+    {
+    vtksysMD5_Append(md5,
+                     reinterpret_cast<const unsigned char*>(it->c_str()),
+                     static_cast<int>(it->size()));
+    vtksysMD5_Append(md5, reinterpret_cast<const unsigned char*>("\n"), 1);
+    }
+  char hex[33];
+  vtksysMD5_FinalizeHex(md5, hex);
+  hex[32] = '\0';
+  vtksysMD5_Delete(md5);
+  return std::string(hex);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLCameraPathParser::WritePathCache(ostream& of,
+                                            const CameraPathData& data,
+                                            const std::string& checksum)
+{
+  of << "# checksum = " << checksum << endl;
+
+  // spline coefficients: number of intervals, intervals,
+  // then the 4 coefficients per interval for x, y and z
+  for (int channel = 0; channel < 3; ++channel)
+    {
+    const std::vector<double>& intervals = data.Intervals[channel];
+    if (intervals.empty())
+      {
+      continue;
+      }
+    of << "# " << CHANNEL_NAMES[channel] << " coefficients = " << intervals.size();
+    for (size_t i = 0; i < intervals.size(); ++i)
+      {
+      of << "," << intervals[i];
+      }
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      const std::vector<double>& coefficients = data.Coefficients[channel][axis];
+      for (size_t i = 0; i < coefficients.size(); ++i)
+        {
+        of << "," << coefficients[i];
+        }
+      }
+    of << endl;
+    }
+
+  // sampled path: number of samples, then t,x,y,z per sample
+  if (data.Samples.empty())
+    {
+    return;
+    }
+  of << "# position samples = " << data.Samples.size() / 4;
+  for (size_t i = 0; i < data.Samples.size(); ++i)
+    {
+    of << "," << data.Samples[i];
+    }
+  of << endl;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLCameraPathParser::ReadPathCache(CameraPathData& data)
+{
+  std::map<std::string, std::string>::const_iterator it =
+    data.Comments.find("checksum");
+  if (it == data.Comments.end())
+    {
+    return false;
+    }
+  if (it->second != this->ComputeKeyFramesChecksum(data.KeyFrameLines))
+    {
+    vtkDebugMacro("ReadPathCache: keyframes changed, recomputing path");
+    return false;
+    }
+
+  // spline coefficients
+  std::vector<double> values;
+  for (int channel = 0; channel < 3; ++channel)
+    {
+    it = data.Comments.find(std::string(CHANNEL_NAMES[channel]) + " coefficients");
+    if (it == data.Comments.end())
+      {
+      return false;
+      }
+    ParseDoubles(it->second, values);
+    if (values.empty())
+      {
+      return false;
+      }
+    size_t size = static_cast<size_t>(values[0]);
+    if (values.size() != 1 + 13 * size)
+      {
+      vtkWarningMacro("ReadPathCache: invalid " << CHANNEL_NAMES[channel] << " coefficients");
+      return false;
+      }
+    std::vector<double>::const_iterator begin = values.begin() + 1;
+    data.Intervals[channel].assign(begin, begin + size);
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      begin = values.begin() + 1 + size + 4 * size * axis;
+      data.Coefficients[channel][axis].assign(begin, begin + 4 * size);
+      }
+    }
+
+  // sampled path
+  it = data.Comments.find("position samples");
+  if (it == data.Comments.end())
+    {
+    return false;
+    }
+  ParseDoubles(it->second, values);
+  if (values.empty() ||
+      values.size() != 1 + 4 * static_cast<size_t>(values[0]))
+    {
+    vtkWarningMacro("ReadPathCache: invalid position samples");
+    return false;
+    }
+  data.Samples.assign(values.begin() + 1, values.end());
+  return true;
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLCameraPathParser::ReadNextLineComponentAsDouble(std::stringstream *ss)
+{
+  if(!ss)
+  {
+    vtkErrorMacro("ReadNextLineComponentAsDouble : Empty line");
+    return 0.0;
+  }
+
+  std::string component;
+  getline(*ss, component, ',');
+
+  if (component.empty())
+    {
+    vtkErrorMacro("ReadNextLineComponentAsDouble : Empty component");
+    return 0.0;
+    }
+
+  return atof(component.c_str());
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLCameraPathParser::WritePathData(const CameraPathData& data)
+{
+  // check the filename
+  std::string fullName = this->FileName ? this->FileName : "";
+  if (fullName.empty())
+    {
+    vtkErrorMacro("vtkMRMLCameraPathParser: File name not specified");
+    return 0;
+    }
+  vtkDebugMacro("WritePathData: have file name " << fullName.c_str());
+
+  // write doubles so that they read back to the same values
+  const int precision = std::numeric_limits<double>::digits10 + 2;
+
+  // format the keyframes
+  std::vector<std::string> keyFrameLines;
+  for (size_t i = 0; i < data.Times.size(); i++)
+    {
+    std::stringstream ss;
+    ss << std::setprecision(precision);
+    ss << data.Times[i];
+    for (int j = 0; j < 9; ++j)
+      {
+      ss << "," << data.Poses[9 * i + j];
+      }
+    keyFrameLines.push_back(ss.str());
+    }
+
+  // write to a temporary file renamed over the file once complete, so that
+  // a failed write leaves the file and its journal untouched
+  std::string temporaryName = fullName + ".tmp";
+  fstream of;
+  of.open(temporaryName.c_str(), fstream::out | fstream::trunc);
+  if (!of.is_open())
+    {
+    vtkErrorMacro("WriteData: unable to open file " << temporaryName.c_str() << " for writing");
+    return 0;
+    }
+  of << std::setprecision(precision);
+
+  // put down a header
+  of << "# CameraPath  file version = " << Slicer_VERSION << endl;
+
+  // summary read by ReadHeader()
+  CameraPathHeader header;
+  this->ComputeHeader(data.Times, data.Poses, header);
+  std::map<std::string, std::string>::const_iterator it = data.Comments.find("name");
+  if (it != data.Comments.end())
+    {
+    of << "# name = " << it->second << endl;
+    }
+  of << "# keyframes = " << header.NumberOfKeyFrames << endl;
+  if (header.NumberOfKeyFrames > 0)
+    {
+    of << "# time range = " << header.TimeRange[0] << "," << header.TimeRange[1] << endl;
+    of << "# bounds = " << header.Bounds[0];
+    for (int i = 1; i < 6; ++i)
+      {
+      of << "," << header.Bounds[i];
+      }
+    of << endl;
+    }
+  it = data.Comments.find("thumbnail");
+  if (it != data.Comments.end())
+    {
+    of << "# thumbnail = " << it->second << endl;
+    }
+
+  // label the columns
+  of << "# columns = time,posX,posY,posZ,focX,focY,focZ,viewX,viewY,viewZ" << endl;
+
+  // add the keyframes
+  for (size_t i = 0; i < keyFrameLines.size(); ++i)
+    {
+    of << keyFrameLines[i] << endl;
+    }
+
+  // add the precomputed path
+  if (data.PathComputed && keyFrameLines.size() > 1)
+    {
+    this->WritePathCache(of, data, this->ComputeKeyFramesChecksum(keyFrameLines));
+    }
+
+  of.flush();
+  bool failed = of.fail();
+  of.close();
+  if (failed || of.fail())
+    {
+    vtkErrorMacro("WriteData: unable to write file " << temporaryName.c_str());
+    vtksys::SystemTools::RemoveFile(temporaryName.c_str());
+    return 0;
+    }
+
+  // rename() does not replace an existing file on all platforms
+  if (rename(temporaryName.c_str(), fullName.c_str()) != 0)
+    {
+    vtksys::SystemTools::RemoveFile(fullName.c_str());
+    if (rename(temporaryName.c_str(), fullName.c_str()) != 0)
+      {
+      vtkErrorMacro("WriteData: unable to replace " << fullName.c_str());
+      vtksys::SystemTools::RemoveFile(temporaryName.c_str());
+      return 0;
+      }
+    }
+
+  // the journal is compacted into the file
+  std::string journalName = this->GetJournalFileName();
+  if (vtksys::SystemTools::FileExists(journalName.c_str(), true))
+    {
+    vtksys::SystemTools::RemoveFile(journalName.c_str());
+    }
+
+  return 1;
+}
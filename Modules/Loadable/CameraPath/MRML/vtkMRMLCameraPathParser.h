@@ -0,0 +1,195 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+/// CameraPath Module MRML file parser
+///
+/// vtkMRMLCameraPathParser - read and write camera path files
+///
+/// vtkMRMLCameraPathParser reads and writes the keyframes, header, path
+/// cache and journal of camera path files. It is not a MRML node and does
+/// not use the scene, so that parsers can be used on worker threads, one
+/// per thread. \sa vtkMRMLCameraPathStorageNode
+
+#ifndef __vtkMRMLCameraPathParser_h
+#define __vtkMRMLCameraPathParser_h
+
+// CameraPath includes
+#include "vtkSlicerCameraPathModuleMRMLExport.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+// STD includes
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/// Keyframes and path read from a camera path file.
+/// It does not hold any MRML node, so that files can be read and their path
+/// computed outside of the main thread, then applied to a camera path node.
+/// \sa vtkMRMLCameraPathParser::ReadPathData(),
+/// vtkMRMLCameraPathStorageNode::ApplyPathData()
+struct CameraPathData
+{
+  /// Keyframe times, in file order
+  std::vector<double> Times;
+  /// Position, focal point and view up of each keyframe
+  std::vector<double> Poses;
+  /// Keyframe lines as read, used for the checksum
+  std::vector<std::string> KeyFrameLines;
+  /// "# key = value" comment lines
+  std::map<std::string, std::string> Comments;
+
+  /// Whether the coefficients and samples below are valid for the keyframes
+  bool PathComputed;
+  /// Spline intervals and coefficients of the position, focal point and
+  /// view up splines, \sa vtkMRMLPointSplineNode::GetCoefficients()
+  std::vector<double> Intervals[3];
+  std::vector<double> Coefficients[3][3];
+  /// Sampled position path as t,x,y,z values
+  std::vector<double> Samples;
+
+  CameraPathData() : PathComputed(false) {}
+};
+
+/// Summary of a camera path file, read from the comment lines at the top of
+/// the file so that path libraries can be listed without parsing keyframes.
+/// \sa vtkMRMLCameraPathParser::ReadHeader()
+struct CameraPathHeader
+{
+  /// Path of the file the header was read from
+  std::string FileName;
+  /// Name of the camera path node that was saved
+  std::string Name;
+  int NumberOfKeyFrames;
+  /// First and last keyframe times
+  double TimeRange[2];
+  /// Bounds of the keyframe camera positions
+  double Bounds[6];
+  /// Thumbnail image reference, \sa vtkMRMLCameraPathStorageNode::GetThumbnailAttributeName()
+  std::string Thumbnail;
+
+  CameraPathHeader() : NumberOfKeyFrames(0)
+  {
+    TimeRange[0] = TimeRange[1] = 0.0;
+    for (int i = 0; i < 6; ++i)
+      {
+      Bounds[i] = 0.0;
+      }
+  }
+};
+
+/// \ingroup Slicer_QtModules_CameraPath
+class VTK_SLICER_CAMERAPATH_MODULE_MRML_EXPORT vtkMRMLCameraPathParser :
+  public vtkObject
+{
+public:
+  static vtkMRMLCameraPathParser *New();
+  vtkTypeMacro(vtkMRMLCameraPathParser, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Full path of the camera path file
+  vtkSetStringMacro(FileName);
+  vtkGetStringMacro(FileName);
+
+  /// Return the journal file name: the file name with a ".journal"
+  /// suffix, or an empty string if no file name is set.
+  std::string GetJournalFileName();
+
+  /// Append a journal line "operation,value,value,..." and flush it.
+  /// Operations are "add" (time, 9 pose values), "remove" (time),
+  /// "modify" (old time, new time, 9 pose values) and "clear".
+  int AppendJournalEntry(const char* operation,
+                         const double* values = 0, int numberOfValues = 0);
+
+  /// Replace the journal with a "clear" entry followed by an "add" entry
+  /// for each keyframe of \a data, so that resetting the keyframes does not
+  /// grow the journal.
+  int ResetJournal(const CameraPathData& data);
+
+  /// Read the file into \a data. The journal, if any, is replayed over the
+  /// keyframes of the file. If the file has no valid path cache and
+  /// \a computePath is true, the path is computed.
+  int ReadPathData(CameraPathData& data, bool computePath = true);
+
+  /// Write \a data to the file, with the path cache if \a data has a
+  /// computed path, and remove the journal that it compacts.
+  /// The file is written to <file>.tmp then renamed over the file, the
+  /// journal being removed only once renamed. Return 0 if the file could
+  /// not be written, the file and its journal being left unchanged.
+  int WritePathData(const CameraPathData& data);
+
+  /// Read the name, keyframe count, time range, bounds and thumbnail
+  /// written at the top of the file, stopping at the first keyframe.
+  /// Files written without that header, or with a journal of the edits made
+  /// since they were written, are fully read instead.
+  int ReadHeader(CameraPathHeader& header);
+
+protected:
+  vtkMRMLCameraPathParser();
+  ~vtkMRMLCameraPathParser();
+
+  /// Return the journal line of \a operation and its values
+  static std::string FormatJournalEntry(const char* operation,
+                                        const double* values,
+                                        int numberOfValues);
+
+  /// Return next sstream component as a double
+  double ReadNextLineComponentAsDouble(std::stringstream *ss);
+
+  /// Split a "# key = value" comment line.
+  /// Return false if the line is not formatted that way.
+  static bool ParseCommentLine(const std::string& line,
+                               std::string& key, std::string& value);
+
+  /// Fill the keyframe count, time range and bounds of \a header from the
+  /// keyframe times and poses
+  static void ComputeHeader(const std::vector<double>& times,
+                            const std::vector<double>& poses,
+                            CameraPathHeader& header);
+
+  /// Fill \a header from "# key = value" comments.
+  /// Return false if the comments have no header.
+  static bool ParseHeader(const std::map<std::string, std::string>& comments,
+                          CameraPathHeader& header);
+
+  /// Return the MD5 checksum of the keyframe lines
+  static std::string ComputeKeyFramesChecksum(
+    const std::vector<std::string>& keyFrameLines);
+
+  /// Write the spline coefficients and the sampled path
+  void WritePathCache(ostream& of, const CameraPathData& data,
+                      const std::string& checksum);
+
+  /// Read the spline coefficients and the sampled path from the comments
+  /// if the cache checksum matches. Return false if the path must be
+  /// recomputed.
+  bool ReadPathCache(CameraPathData& data);
+
+  /// Apply the journal operations to the keyframes of \a data.
+  /// Return the number of operations replayed.
+  int ReplayJournal(CameraPathData& data);
+
+  char* FileName;
+
+private:
+  vtkMRMLCameraPathParser(const vtkMRMLCameraPathParser&); // Not implemented
+  void operator=(const vtkMRMLCameraPathParser&); // Not implemented
+};
+
+#endif
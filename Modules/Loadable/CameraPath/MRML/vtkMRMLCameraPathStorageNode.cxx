@@ -19,14 +19,29 @@
 #include "vtkMRMLCameraPathNode.h"
 
 #include "vtkMRMLScene.h"
-#include "vtkSlicerVersionConfigure.h"
 
+#include "vtkDataArray.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
 #include "vtkStringArray.h"
-#include <vtksys/SystemTools.hxx>
 
-#include <sstream>
-#include <iostream>
+namespace
+{
+
+//----------------------------------------------------------------------------
+vtkMRMLPointSplineNode* GetChannelSplines(vtkMRMLCameraPathNode* node, int channel)
+{
+  switch (channel)
+    {
+    case 0: return node->GetPositionSplines();
+    case 1: return node->GetFocalPointSplines();
+    default: return node->GetViewUpSplines();
+    }
+}
+
+}
 
 //------------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLCameraPathStorageNode);
@@ -34,6 +49,8 @@ vtkMRMLNodeNewMacro(vtkMRMLCameraPathStorageNode);
 //----------------------------------------------------------------------------
 vtkMRMLCameraPathStorageNode::vtkMRMLCameraPathStorageNode()
 {
+  this->EmbedPathCache = 0;
+  this->JournalEnabled = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -45,24 +62,58 @@ vtkMRMLCameraPathStorageNode::~vtkMRMLCameraPathStorageNode()
 void vtkMRMLCameraPathStorageNode::WriteXML(ostream& of, int nIndent)
 {
   Superclass::WriteXML(of,nIndent);
+
+  vtkIndent indent(nIndent);
+  of << indent << " embedPathCache=\"" << (this->EmbedPathCache ? "true" : "false") << "\"";
+  of << indent << " journalEnabled=\"" << (this->JournalEnabled ? "true" : "false") << "\"";
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLCameraPathStorageNode::ReadXMLAttributes(const char** atts)
 {
+  int disabledModify = this->StartModify();
+
   Superclass::ReadXMLAttributes(atts);
+
+  const char* attName;
+  const char* attValue;
+  while (*atts != NULL)
+    {
+    attName = *(atts++);
+    attValue = *(atts++);
+    if (!strcmp(attName, "embedPathCache"))
+      {
+      this->EmbedPathCache = !strcmp(attValue, "true") ? 1 : 0;
+      }
+    else if (!strcmp(attName, "journalEnabled"))
+      {
+      this->JournalEnabled = !strcmp(attValue, "true") ? 1 : 0;
+      }
+    }
+
+  this->EndModify(disabledModify);
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLCameraPathStorageNode::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf(os,indent);
+  os << indent << "EmbedPathCache: " << this->EmbedPathCache << "\n";
+  os << indent << "JournalEnabled: " << this->JournalEnabled << "\n";
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLCameraPathStorageNode::Copy(vtkMRMLNode *anode)
 {
   Superclass::Copy(anode);
+
+  vtkMRMLCameraPathStorageNode* node =
+    vtkMRMLCameraPathStorageNode::SafeDownCast(anode);
+  if (node)
+    {
+    this->SetEmbedPathCache(node->GetEmbedPathCache());
+    this->SetJournalEnabled(node->GetJournalEnabled());
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -80,14 +131,6 @@ int vtkMRMLCameraPathStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     return 0;
     }
 
-  std::string fullName = this->GetFullNameFromFileName();
-
-  if (fullName == std::string(""))
-    {
-    vtkErrorMacro("vtkMRMLCameraPathStorageNode: File name not specified");
-    return 0;
-    }
-
   // cast the input node
   vtkMRMLCameraPathNode *cameraPathNode =
     vtkMRMLCameraPathNode::SafeDownCast(refNode);
@@ -96,12 +139,32 @@ int vtkMRMLCameraPathStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     return 0;
     }
 
-  // open the file for reading input
-  fstream fstr;
-  fstr.open(fullName.c_str(), fstream::in);
-  if (!fstr.is_open())
+  // read the file, the path is computed when applied
+  CameraPathData data;
+  if (!this->ReadPathData(data, false))
     {
-    vtkErrorMacro("WriteData: unable to open file " << fullName.c_str() << " for reading");
+    return 0;
+    }
+
+  return this->ApplyPathData(data, cameraPathNode);
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLCameraPathStorageNode::ReadPathData(CameraPathData& data,
+                                               bool computePath)
+{
+  vtkNew<vtkMRMLCameraPathParser> parser;
+  parser->SetFileName(this->GetFullNameFromFileName().c_str());
+  return parser->ReadPathData(data, computePath);
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLCameraPathStorageNode::ApplyPathData(const CameraPathData& data,
+                                                vtkMRMLCameraPathNode* cameraPathNode)
+{
+  if (!cameraPathNode)
+    {
+    vtkErrorMacro("ApplyPathData: null camera path node");
     return 0;
     }
 
@@ -111,84 +174,89 @@ int vtkMRMLCameraPathStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     cameraPathNode->RemoveKeyFrames();
     }
 
-  char line[1024];
+  KeyFrameVector keyFrames;
+  for (size_t i = 0; i < data.Times.size(); ++i)
+    {
+    const double* pose = &data.Poses[9 * i];
+    vtkNew<vtkMRMLCameraNode> camera;
+    camera->SetPosition(const_cast<double*>(pose));
+    camera->SetFocalPoint(const_cast<double*>(pose + 3));
+    camera->SetViewUp(const_cast<double*>(pose + 6));
+    keyFrames.push_back(KeyFrame(camera.GetPointer(), data.Times[i]));
+    }
+
+  // Build the splines once, and the path only if it was not computed
+  cameraPathNode->SetKeyFrames(keyFrames, false);
 
-  // read file
-  while (fstr.good())
+  std::map<std::string, std::string>::const_iterator thumbnail =
+    data.Comments.find("thumbnail");
+  if (thumbnail != data.Comments.end())
     {
-    fstr.getline(line, 1024);
+    cameraPathNode->SetAttribute(this->GetThumbnailAttributeName(),
+                                 thumbnail->second.c_str());
+    }
 
-    // does it start with a #?
-    if (line[0] == '#')
-      {
-      vtkDebugMacro("Comment line, checking:\n\"" << line << "\"");
-      }
-    // is it empty?
-    else if (line[0] == '\0')
-      {
-      vtkDebugMacro("Empty line, skipping:\n\"" << line << "\"");
-      }
-    // keyframe line
-    else
-      {
-      std::stringstream ss(line);
-
-      double time;
-      double position[3];
-      double focalPoint[3];
-      double viewUp[3];
-
-      time = ReadNextLineComponentAsDouble(&ss);
-      position[0] = ReadNextLineComponentAsDouble(&ss);
-      position[1] = ReadNextLineComponentAsDouble(&ss);
-      position[2] = ReadNextLineComponentAsDouble(&ss);
-      focalPoint[0] = ReadNextLineComponentAsDouble(&ss);
-      focalPoint[1] = ReadNextLineComponentAsDouble(&ss);
-      focalPoint[2] = ReadNextLineComponentAsDouble(&ss);
-      viewUp[0] = ReadNextLineComponentAsDouble(&ss);
-      viewUp[1] = ReadNextLineComponentAsDouble(&ss);
-      viewUp[2] = ReadNextLineComponentAsDouble(&ss);
-
-      cameraPathNode->AddKeyFrame(time, position, focalPoint, viewUp);
-      }
+  bool pathRestored = data.PathComputed;
+  for (int channel = 0; channel < 3 && pathRestored; ++channel)
+    {
+    pathRestored = GetChannelSplines(cameraPathNode, channel)->SetCoefficients(
+      data.Intervals[channel], data.Coefficients[channel]);
     }
-  fstr.close();
+  if (pathRestored)
+    {
+    cameraPathNode->GetPositionSplines()->SetPathSamples(data.Samples);
+    }
+  else
+    {
+    cameraPathNode->CreatePath();
+    }
+
   return 1;
 }
 
 //----------------------------------------------------------------------------
-double vtkMRMLCameraPathStorageNode::ReadNextLineComponentAsDouble(std::stringstream *ss)
+std::string vtkMRMLCameraPathStorageNode::GetJournalFileName()
 {
-  if(!ss)
-  {
-    vtkErrorMacro("ReadNextLineComponentAsDouble : Empty line");
-    return 0.0;
-  }
+  vtkNew<vtkMRMLCameraPathParser> parser;
+  parser->SetFileName(this->GetFullNameFromFileName().c_str());
+  return parser->GetJournalFileName();
+}
 
-  std::string component;
-  getline(*ss, component, ',');
+//----------------------------------------------------------------------------
+int vtkMRMLCameraPathStorageNode::AppendJournalEntry(const char* operation,
+                                                     const double* values,
+                                                     int numberOfValues)
+{
+  vtkNew<vtkMRMLCameraPathParser> parser;
+  parser->SetFileName(this->GetFullNameFromFileName().c_str());
+  return parser->AppendJournalEntry(operation, values, numberOfValues);
+}
 
-  if (component.empty())
-    {
-    vtkErrorMacro("ReadNextLineComponentAsDouble : Empty component");
-    return 0.0;
-    }
+//----------------------------------------------------------------------------
+int vtkMRMLCameraPathStorageNode::ResetJournal(const CameraPathData& data)
+{
+  vtkNew<vtkMRMLCameraPathParser> parser;
+  parser->SetFileName(this->GetFullNameFromFileName().c_str());
+  return parser->ResetJournal(data);
+}
 
-  return atof(component.c_str());
+//----------------------------------------------------------------------------
+int vtkMRMLCameraPathStorageNode::ReadHeader(CameraPathHeader& header)
+{
+  vtkNew<vtkMRMLCameraPathParser> parser;
+  parser->SetFileName(this->GetFullNameFromFileName().c_str());
+  return parser->ReadHeader(header);
 }
 
 //----------------------------------------------------------------------------
-int vtkMRMLCameraPathStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
+void vtkMRMLCameraPathStorageNode::StoredTimeModified()
 {
-  // check the filename
-  std::string fullName = this->GetFullNameFromFileName();
-  if (fullName.empty())
-    {
-    vtkErrorMacro("vtkMRMLCameraPathStorageNode: File name not specified");
-    return 0;
-    }
-  vtkDebugMacro("WriteDataInternal: have file name " << fullName.c_str());
+  this->StoredTime->Modified();
+}
 
+//----------------------------------------------------------------------------
+int vtkMRMLCameraPathStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
+{
   // cast the input node
   vtkMRMLCameraPathNode* cameraPathNode =
           vtkMRMLCameraPathNode::SafeDownCast(refNode);
@@ -198,46 +266,85 @@ int vtkMRMLCameraPathStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     return 0;
     }
 
-  // open the file for writing
-  fstream of;
-  of.open(fullName.c_str(), fstream::out);
-  if (!of.is_open())
+  CameraPathData data;
+  if (!this->GetPathData(cameraPathNode, data))
     {
-    vtkErrorMacro("WriteData: unable to open file " << fullName.c_str() << " for writing");
     return 0;
     }
 
-  // put down a header
-  of << "# CameraPath  file version = " << Slicer_VERSION << endl;
-
-  // label the columns
-  of << "# columns = time,posX,posY,posZ,focX,focY,focZ,viewX,viewY,viewZ" << endl;
+  return this->WritePathData(data);
+}
 
-  // add the keyframes
-  for (vtkIdType i = 0; i < cameraPathNode->GetNumberOfKeyFrames(); i++)
+//----------------------------------------------------------------------------
+int vtkMRMLCameraPathStorageNode::GetPathData(vtkMRMLCameraPathNode* cameraPathNode,
+                                              CameraPathData& data)
+{
+  if (!cameraPathNode)
     {
-    double time = cameraPathNode->GetKeyFrameTime(i);
-    of << time;
+    vtkErrorMacro("GetPathData: null camera path node");
+    return 0;
+    }
 
-    double position[3];
-    cameraPathNode->GetKeyFramePosition(i,position);
-    of << "," << position[0] << "," << position[1] << "," << position[2];
+  data = CameraPathData();
 
-    double focalPoint[3];
-    cameraPathNode->GetKeyFrameFocalPoint(i,focalPoint);
-    of << "," << focalPoint[0] << "," << focalPoint[1] << "," << focalPoint[2];
+  // keyframes
+  for (vtkIdType i = 0; i < cameraPathNode->GetNumberOfKeyFrames(); i++)
+    {
+    double pose[9];
+    cameraPathNode->GetKeyFramePosition(i,pose);
+    cameraPathNode->GetKeyFrameFocalPoint(i,pose + 3);
+    cameraPathNode->GetKeyFrameViewUp(i,pose + 6);
+    data.Times.push_back(cameraPathNode->GetKeyFrameTime(i));
+    data.Poses.insert(data.Poses.end(), pose, pose + 9);
+    }
 
-    double viewUp[3];
-    cameraPathNode->GetKeyFrameViewUp(i,viewUp);
-    of << "," << viewUp[0] << "," << viewUp[1] << "," << viewUp[2];
+  // header values that are not computed from the keyframes
+  if (cameraPathNode->GetName())
+    {
+    data.Comments["name"] = cameraPathNode->GetName();
+    }
+  const char* thumbnail =
+    cameraPathNode->GetAttribute(this->GetThumbnailAttributeName());
+  if (thumbnail && thumbnail[0] != '\0')
+    {
+    data.Comments["thumbnail"] = thumbnail;
+    }
 
-    of << endl;
+  // precomputed path
+  if (!this->EmbedPathCache || data.Times.size() < 2)
+    {
+    return 1;
+    }
+  data.PathComputed = true;
+  for (int channel = 0; channel < 3 && data.PathComputed; ++channel)
+    {
+    data.PathComputed = GetChannelSplines(cameraPathNode, channel)->GetCoefficients(
+      data.Intervals[channel], data.Coefficients[channel]);
+    }
+  vtkPolyData* polyData = cameraPathNode->GetPositionSplines()->GetPolyData();
+  vtkDataArray* times = (polyData && polyData->GetPoints()) ?
+    polyData->GetPointData()->GetArray("Time") : 0;
+  if (times)
+    {
+    for (vtkIdType i = 0; i < polyData->GetNumberOfPoints(); ++i)
+      {
+      double* point = polyData->GetPoint(i);
+      data.Samples.push_back(times->GetTuple1(i));
+      data.Samples.insert(data.Samples.end(), point, point + 3);
+      }
     }
 
-  of.close();
   return 1;
 }
 
+//----------------------------------------------------------------------------
+int vtkMRMLCameraPathStorageNode::WritePathData(const CameraPathData& data)
+{
+  vtkNew<vtkMRMLCameraPathParser> parser;
+  parser->SetFileName(this->GetFullNameFromFileName().c_str());
+  return parser->WritePathData(data);
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLCameraPathStorageNode::InitializeSupportedReadFileTypes()
 {
@@ -27,9 +27,10 @@
 
 // CameraPath includes
 #include "vtkSlicerCameraPathModuleMRMLExport.h"
+#include "vtkMRMLCameraPathParser.h"
 #include "vtkMRMLStorageNode.h"
 
-#include <sstream>
+class vtkMRMLCameraPathNode;
 
 /// \ingroup Slicer_QtModules_CameraPath
 class VTK_SLICER_CAMERAPATH_MODULE_MRML_EXPORT vtkMRMLCameraPathStorageNode :
@@ -61,6 +62,65 @@ public:
 
   virtual bool CanReadInReferenceNode(vtkMRMLNode *refNode);
 
+  /// Embed the spline coefficients and the sampled path in the written
+  /// file, along with a checksum of the keyframes. Reading a file whose
+  /// keyframes match the checksum restores the path without recomputing it.
+  /// Off by default.
+  vtkSetMacro(EmbedPathCache, int);
+  vtkGetMacro(EmbedPathCache, int);
+  vtkBooleanMacro(EmbedPathCache, int);
+
+  /// Record the keyframe operations in an append-only journal next to the
+  /// file (see GetJournalFileName()) as they happen, so that edits are not
+  /// lost if the application exits before the path is saved. Writing the
+  /// file compacts the journal into it. Off by default.
+  /// \sa AppendJournalEntry()
+  vtkSetMacro(JournalEnabled, int);
+  vtkGetMacro(JournalEnabled, int);
+  vtkBooleanMacro(JournalEnabled, int);
+
+  /// Return the journal file name: the full file name with a ".journal"
+  /// suffix, or an empty string if no file name is set.
+  std::string GetJournalFileName();
+
+  /// Append a journal line, \sa vtkMRMLCameraPathParser::AppendJournalEntry()
+  int AppendJournalEntry(const char* operation,
+                         const double* values = 0, int numberOfValues = 0);
+
+  /// Replace the journal, \sa vtkMRMLCameraPathParser::ResetJournal()
+  int ResetJournal(const CameraPathData& data);
+
+  /// Read the file into \a data without modifying any node.
+  /// Storage nodes are MRML nodes and must stay on the main thread, worker
+  /// threads use a vtkMRMLCameraPathParser instead.
+  /// \sa vtkMRMLCameraPathParser::ReadPathData()
+  int ReadPathData(CameraPathData& data, bool computePath = true);
+
+  /// Set the keyframes and the path of \a cameraPathNode from \a data.
+  /// New camera nodes are created for the keyframes.
+  int ApplyPathData(const CameraPathData& data,
+                    vtkMRMLCameraPathNode* cameraPathNode);
+
+  /// Copy the keyframes, name and thumbnail of \a cameraPathNode into
+  /// \a data, and its path if EmbedPathCache is set. Must be called on the
+  /// main thread; \a data can then be written from any thread.
+  int GetPathData(vtkMRMLCameraPathNode* cameraPathNode, CameraPathData& data);
+
+  /// Write \a data to the file, \sa vtkMRMLCameraPathParser::WritePathData()
+  int WritePathData(const CameraPathData& data);
+
+  /// Read the header of the file, \sa vtkMRMLCameraPathParser::ReadHeader()
+  int ReadHeader(CameraPathHeader& header);
+
+  /// Record that the file was written outside of WriteData(), e.g. by a
+  /// parser on a worker thread, so that the camera path node is no longer
+  /// reported as modified since read.
+  void StoredTimeModified();
+
+  /// Name of the camera path node attribute holding the thumbnail
+  /// reference (typically an image file name) saved in the file header.
+  static const char* GetThumbnailAttributeName() {return "CameraPath.Thumbnail";};
+
 protected:
   vtkMRMLCameraPathStorageNode();
   ~vtkMRMLCameraPathStorageNode();
@@ -86,8 +146,8 @@ protected:
   /// necessary, same with the description
   virtual int WriteDataInternal(vtkMRMLNode *refNode);
 
-  /// Return next sstream component as a double
-  double ReadNextLineComponentAsDouble(std::stringstream *ss);
+  int EmbedPathCache;
+  int JournalEnabled;
 };
 
 #endif
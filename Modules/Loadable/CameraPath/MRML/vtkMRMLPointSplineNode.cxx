@@ -12,12 +12,141 @@
 #include <vtkPolyData.h>
 #include <vtkPointData.h>
 #include <vtkFloatArray.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkPoints.h>
 #if (VTK_MAJOR_VERSION > 5)
 #include <vtkAlgorithmOutput.h>
 #include <vtkEventForwarderCommand.h>
 #include <vtkTrivialProducer.h>
 #endif
 
+// STD includes
+#include <algorithm>
+
+
+//------------------------------------------------------------------------------
+// vtkCachedKochanekSpline
+
+//------------------------------------------------------------------------------
+// Kochanek spline whose per-segment coefficients can be read and restored,
+// so that a saved path does not need to be fitted again.
+class vtkCachedKochanekSpline : public vtkKochanekSpline
+{
+public:
+  static vtkCachedKochanekSpline *New();
+  vtkTypeMacro(vtkCachedKochanekSpline, vtkKochanekSpline);
+
+  bool GetCoefficients(std::vector<double>& intervals,
+                       std::vector<double>& coefficients);
+  bool SetCoefficients(const std::vector<double>& intervals,
+                       const std::vector<double>& coefficients);
+
+protected:
+  vtkCachedKochanekSpline() {}
+  ~vtkCachedKochanekSpline() {}
+
+  /// Number of intervals used by Compute()
+  int GetNumberOfIntervals();
+
+private:
+  vtkCachedKochanekSpline(const vtkCachedKochanekSpline&);  // Not implemented.
+  void operator=(const vtkCachedKochanekSpline&);  // Not implemented.
+};
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro(vtkCachedKochanekSpline);
+
+//------------------------------------------------------------------------------
+int vtkCachedKochanekSpline::GetNumberOfIntervals()
+{
+  int size = this->PiecewiseFunction->GetSize();
+  // Closed splines get an extra point to close the loop
+  return this->Closed ? size + 1 : size;
+}
+
+//------------------------------------------------------------------------------
+bool vtkCachedKochanekSpline::GetCoefficients(std::vector<double>& intervals,
+                                              std::vector<double>& coefficients)
+{
+  if (this->PiecewiseFunction->GetSize() < 2)
+    {
+    return false;
+    }
+  if (this->ComputeTime < this->GetMTime())
+    {
+    this->Compute();
+    }
+
+  int size = this->GetNumberOfIntervals();
+  intervals.assign(this->Intervals, this->Intervals + size);
+  coefficients.assign(this->Coefficients, this->Coefficients + 4*size);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkCachedKochanekSpline::SetCoefficients(const std::vector<double>& intervals,
+                                              const std::vector<double>& coefficients)
+{
+  int numberOfPoints = this->PiecewiseFunction->GetSize();
+  int size = this->GetNumberOfIntervals();
+  if (numberOfPoints < 2 ||
+      static_cast<int>(intervals.size()) != size ||
+      static_cast<int>(coefficients.size()) != 4*size)
+    {
+    return false;
+    }
+
+  // The coefficients are only valid for the points they were computed from
+  double* ts = this->PiecewiseFunction->GetDataPointer();
+  for (int i = 0; i < numberOfPoints; ++i)
+    {
+    if (ts[2*i] != intervals[i])
+      {
+      return false;
+      }
+    }
+
+  delete [] this->Intervals;
+  this->Intervals = new double[size];
+  std::copy(intervals.begin(), intervals.end(), this->Intervals);
+
+  delete [] this->Coefficients;
+  this->Coefficients = new double[4*size];
+  std::copy(coefficients.begin(), coefficients.end(), this->Coefficients);
+
+  // Mark the spline as computed
+  this->ComputeTime = this->GetMTime();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+namespace
+{
+
+//------------------------------------------------------------------------------
+// Sample the x, y and z splines at framerate as t,x,y,z values
+void SampleSplines(vtkSpline* splines[3], int framerate,
+                   std::vector<double>& samples)
+{
+  double range[2];
+  splines[0]->GetParametricRange(range);
+  double tmin = range[0];
+  double tmax = range[1];
+
+  int numSplinePoints = framerate * int(tmax - tmin);
+  samples.resize(4 * numSplinePoints);
+  for (int i = 0; i < numSplinePoints; ++i)
+    {
+    double t = (i/(double)framerate) + tmin;
+    samples[4*i] = t;
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      samples[4*i + 1 + axis] = splines[axis]->Evaluate(t);
+      }
+    }
+}
+
+}
 
 //------------------------------------------------------------------------------
 // vtkMRMLPointSplineNode::vtkInternal
@@ -40,9 +169,9 @@ public:
 vtkMRMLPointSplineNode::vtkInternal::vtkInternal(
     vtkMRMLPointSplineNode* external):External(external)
 {
-  this->XSpline = vtkSmartPointer<splineType>::New();
-  this->YSpline = vtkSmartPointer<splineType>::New();
-  this->ZSpline = vtkSmartPointer<splineType>::New();
+  this->XSpline = vtkSmartPointer<vtkCachedKochanekSpline>::New();
+  this->YSpline = vtkSmartPointer<vtkCachedKochanekSpline>::New();
+  this->ZSpline = vtkSmartPointer<vtkCachedKochanekSpline>::New();
 }
 
 //------------------------------------------------------------------------------
@@ -61,6 +190,7 @@ vtkMRMLPointSplineNode::vtkMRMLPointSplineNode()
 {
   this->Internal = new vtkInternal(this);
   this->HideFromEditors = 1;
+  this->SaveWithScene = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -84,9 +214,9 @@ void vtkMRMLPointSplineNode::Copy(vtkMRMLNode *anode)
 
   this->Superclass::Copy(anode);
 
-  vtkNew<splineType> XSpline;
-  vtkNew<splineType> YSpline;
-  vtkNew<splineType> ZSpline;
+  vtkNew<vtkCachedKochanekSpline> XSpline;
+  vtkNew<vtkCachedKochanekSpline> YSpline;
+  vtkNew<vtkCachedKochanekSpline> ZSpline;
 
   XSpline->DeepCopy(node->GetXSpline());
   YSpline->DeepCopy(node->GetYSpline());
@@ -122,10 +252,12 @@ void vtkMRMLPointSplineNode::CreateDefaultDisplayNodes()
     }
   if (this->GetScene()==NULL)
     {
-    vtkErrorMacro("vtkMRMLPointSplineNode::CreateDefaultDisplayNodes failed: scene is invalid");
+    // display node is created when the spline is added to the scene
+    vtkDebugMacro("vtkMRMLPointSplineNode::CreateDefaultDisplayNodes: no scene");
     return;
     }
   vtkNew<vtkMRMLModelDisplayNode> dispNode;
+  dispNode->SetSaveWithScene(0);
   this->GetScene()->AddNode(dispNode.GetPointer());
   this->SetAndObserveDisplayNodeID(dispNode->GetID());
   dispNode->SetScalarVisibility(1);
@@ -133,6 +265,12 @@ void vtkMRMLPointSplineNode::CreateDefaultDisplayNodes()
   dispNode->SetAndObserveColorNodeID("vtkMRMLColorTableNodeInvertedGrey");
 }
 
+//----------------------------------------------------------------------------
+vtkMRMLStorageNode* vtkMRMLPointSplineNode::CreateDefaultStorageNode()
+{
+  return NULL;
+}
+
 //----------------------------------------------------------------------------
 double vtkMRMLPointSplineNode::GetMinimumT()
 {
@@ -196,23 +334,55 @@ void vtkMRMLPointSplineNode::UpdatePolyData(int framerate)
     return;
     }
 
-  int numSplinePoints = framerate * int(tmax - tmin);
+  vtkSpline* splines[3] =
+    {
+    this->GetXSpline(), this->GetYSpline(), this->GetZSpline()
+    };
+  std::vector<double> samples;
+  SampleSplines(splines, framerate, samples);
+
+  this->SetPathSamples(samples);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLPointSplineNode::SetPathSamples(const std::vector<double>& samples)
+{
+  vtkIdType numSplinePoints = static_cast<vtkIdType>(samples.size() / 4);
 
   vtkSmartPointer<vtkPoints> splinePoints = vtkSmartPointer<vtkPoints>::New();
   vtkSmartPointer<vtkFloatArray> timeArray = vtkSmartPointer<vtkFloatArray>::New();
-  timeArray->SetName("Time");
-  for (int i = 0; i < numSplinePoints; ++i)
+  splinePoints->SetNumberOfPoints(numSplinePoints);
+  timeArray->SetNumberOfValues(numSplinePoints);
+  for (vtkIdType i = 0; i < numSplinePoints; ++i)
     {
-    double t = (i/(double)framerate) + tmin;
-    double pt[3];
-    this->Evaluate(t,pt);
-    splinePoints->InsertNextPoint(pt);
-    timeArray->InsertNextValue(t);
+    const double* sample = &samples[4*i];
+    timeArray->SetValue(i, sample[0]);
+    splinePoints->SetPoint(i, sample[1], sample[2], sample[3]);
+    }
+
+  this->SetPathSamples(splinePoints, timeArray);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLPointSplineNode::SetPathSamples(vtkPoints* points,
+                                            vtkDataArray* times)
+{
+  if ( !points || !times ||
+       points->GetNumberOfPoints() != times->GetNumberOfTuples() )
+    {
+    vtkErrorMacro("SetPathSamples: invalid samples");
+    return;
     }
 
+  vtkIdType numSplinePoints = points->GetNumberOfPoints();
+
+  vtkSmartPointer<vtkFloatArray> timeArray = vtkSmartPointer<vtkFloatArray>::New();
+  timeArray->DeepCopy(times);
+  timeArray->SetName("Time");
+
   // Set up spline points
   vtkSmartPointer<vtkPolyData> splinePolyData = vtkSmartPointer<vtkPolyData>::New();
-  splinePolyData->SetPoints( splinePoints );
+  splinePolyData->SetPoints( points );
   splinePolyData->GetPointData()->AddArray(timeArray);
   splinePolyData->GetPointData()->SetActiveScalars("Time");
 
@@ -230,6 +400,117 @@ void vtkMRMLPointSplineNode::UpdatePolyData(int framerate)
   this->Modified();
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLPointSplineNode::GetCoefficients(std::vector<double>& intervals,
+                                             std::vector<double> coefficients[3])
+{
+  vtkCachedKochanekSpline* splines[3] =
+    {
+    vtkCachedKochanekSpline::SafeDownCast(this->GetXSpline()),
+    vtkCachedKochanekSpline::SafeDownCast(this->GetYSpline()),
+    vtkCachedKochanekSpline::SafeDownCast(this->GetZSpline())
+    };
+  for (int i = 0; i < 3; ++i)
+    {
+    // All splines share the same intervals
+    if ( !splines[i] || !splines[i]->GetCoefficients(intervals, coefficients[i]) )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLPointSplineNode::SetCoefficients(const std::vector<double>& intervals,
+                                             const std::vector<double> coefficients[3])
+{
+  vtkCachedKochanekSpline* splines[3] =
+    {
+    vtkCachedKochanekSpline::SafeDownCast(this->GetXSpline()),
+    vtkCachedKochanekSpline::SafeDownCast(this->GetYSpline()),
+    vtkCachedKochanekSpline::SafeDownCast(this->GetZSpline())
+    };
+  for (int i = 0; i < 3; ++i)
+    {
+    if ( !splines[i] || !splines[i]->SetCoefficients(intervals, coefficients[i]) )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLPointSplineNode::EvaluateCoefficients(const std::vector<double>& intervals,
+                                                  const std::vector<double> coefficients[3],
+                                                  double t, double point[3])
+{
+  size_t size = intervals.size();
+  if (size < 2)
+    {
+    point[0] = point[1] = point[2] = 0.0;
+    return;
+    }
+
+  // clamp the function at both ends
+  t = std::max(intervals[0], std::min(t, intervals[size - 1]));
+
+  // interval holding t, the left one at a knot like vtkSpline::FindIndex
+  size_t index = std::lower_bound(intervals.begin() + 1, intervals.end(), t)
+    - intervals.begin() - 1;
+  index = std::min(index, size - 2);
+
+  // offset within the interval
+  t = (t - intervals[index]) / (intervals[index + 1] - intervals[index]);
+
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    const double* c = &coefficients[axis][4 * index];
+    point[axis] = t * (t * (t * c[3] + c[2]) + c[1]) + c[0];
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLPointSplineNode::ComputePath(const std::vector<double>& times,
+                                         const std::vector<double>& points,
+                                         std::vector<double>& intervals,
+                                         std::vector<double> coefficients[3],
+                                         int framerate,
+                                         std::vector<double>* samples)
+{
+  if (times.size() < 2 || points.size() != 3 * times.size())
+    {
+    return false;
+    }
+
+  vtkNew<vtkCachedKochanekSpline> xSpline;
+  vtkNew<vtkCachedKochanekSpline> ySpline;
+  vtkNew<vtkCachedKochanekSpline> zSpline;
+  vtkCachedKochanekSpline* splines[3] =
+    {
+    xSpline.GetPointer(), ySpline.GetPointer(), zSpline.GetPointer()
+    };
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    for (size_t i = 0; i < times.size(); ++i)
+      {
+      splines[axis]->AddPoint(times[i], points[3*i + axis]);
+      }
+    if (!splines[axis]->GetCoefficients(intervals, coefficients[axis]))
+      {
+      return false;
+      }
+    }
+
+  if (samples)
+    {
+    vtkSpline* sampledSplines[3] = {splines[0], splines[1], splines[2]};
+    SampleSplines(sampledSplines, framerate, *samples);
+    }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLPointSplineNode::RemoveAllPoints()
 {
@@ -9,9 +9,17 @@ class vtkMRMLStorageNode;
 // VTK includes
 #include <vtkKochanekSpline.h>
 class vtkAlgorithmOutput;
+class vtkDataArray;
+class vtkPoints;
+
+// STD includes
+#include <vector>
 
 /// \brief MRML node to hold the information about a 3D spline.
 ///
+/// Point spline nodes are derived from the keyframes of a camera path node:
+/// they are neither saved with the scene nor written to file, and are
+/// rebuilt from the camera path node when it is loaded.
 class VTK_SLICER_CAMERAPATH_MODULE_MRML_EXPORT vtkMRMLPointSplineNode :
     public vtkMRMLModelNode
 {
@@ -38,6 +46,9 @@ public:
   /// \sa vtkMRMLPointSplineDisplayNode
   void CreateDefaultDisplayNodes();
 
+  /// Point splines are derived data: no storage node is created
+  virtual vtkMRMLStorageNode* CreateDefaultStorageNode();
+
   //--------------------------------------------------------------------------
   /// PointSpline methods
   //--------------------------------------------------------------------------
@@ -58,6 +69,43 @@ public:
   void UpdatePolyData(int framerate);
   void Evaluate(double t, double point[3]=0);
 
+  /// Set the sampled path from precomputed points and their times, instead
+  /// of evaluating the splines like UpdatePolyData does.
+  void SetPathSamples(vtkPoints* points, vtkDataArray* times);
+  /// Set the sampled path from t,x,y,z values
+  /// \sa ComputePath
+  void SetPathSamples(const std::vector<double>& samples);
+
+  /// Get the per-segment coefficients of the X, Y and Z splines.
+  /// Return false if the splines have less than 2 points.
+  bool GetCoefficients(std::vector<double>& intervals,
+                       std::vector<double> coefficients[3]);
+
+  /// Restore coefficients returned by GetCoefficients so that the splines
+  /// are not recomputed. The splines must hold the same points.
+  /// Return false if the coefficients do not match the spline points.
+  bool SetCoefficients(const std::vector<double>& intervals,
+                       const std::vector<double> coefficients[3]);
+
+  /// Evaluate coefficients returned by GetCoefficients at \a t, as
+  /// Evaluate() does on the splines they were read from.
+  /// No node is involved, so it can be called from any thread.
+  static void EvaluateCoefficients(const std::vector<double>& intervals,
+                                   const std::vector<double> coefficients[3],
+                                   double t, double point[3]);
+
+  /// Fit splines through \a points (x,y,z for each of the \a times) and
+  /// return their coefficients, as GetCoefficients does. If \a samples is
+  /// set, it is filled with the path sampled at \a framerate as t,x,y,z
+  /// values, as UpdatePolyData does.
+  /// No node is involved, so it can be called from any thread.
+  static bool ComputePath(const std::vector<double>& times,
+                          const std::vector<double>& points,
+                          std::vector<double>& intervals,
+                          std::vector<double> coefficients[3],
+                          int framerate = 0,
+                          std::vector<double>* samples = 0);
+
 protected:
   vtkMRMLPointSplineNode();
   virtual ~vtkMRMLPointSplineNode();
@@ -0,0 +1,140 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath MRML includes
+#include "vtkMRMLCameraPathNode.h"
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool isClose(const double a[3], double x, double y, double z)
+{
+  return fabs(a[0] - x) < 1e-9 && fabs(a[1] - y) < 1e-9 && fabs(a[2] - z) < 1e-9;
+}
+
+//----------------------------------------------------------------------------
+void printPose(const CameraPose& pose)
+{
+  for (int i = 0; i < 3; ++i)
+    {
+    std::cerr << " " << pose.Position[i];
+    }
+  for (int i = 0; i < 3; ++i)
+    {
+    std::cerr << " " << pose.FocalPoint[i];
+    }
+  for (int i = 0; i < 3; ++i)
+    {
+    std::cerr << " " << pose.ViewUp[i];
+    }
+  std::cerr << std::endl;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+int vtkMRMLCameraPathNodeRigPoseTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // Path camera at z = 10 looking at the origin, its right being +x
+  CameraPose pose;
+  const double position[3] = {0.0, 0.0, 10.0};
+  const double focalPoint[3] = {0.0, 0.0, 0.0};
+  const double viewUp[3] = {0.0, 1.0, 0.0};
+  for (int i = 0; i < 3; ++i)
+    {
+    pose.Position[i] = position[i];
+    pose.FocalPoint[i] = focalPoint[i];
+    pose.ViewUp[i] = viewUp[i];
+    }
+
+  // The identity places the rig camera at the path camera
+  const double identity[16] = {1, 0, 0, 0,
+                               0, 1, 0, 0,
+                               0, 0, 1, 0,
+                               0, 0, 0, 1};
+  CameraPose rigPose;
+  vtkMRMLCameraPathNode::ComputeRigPose(pose, identity, rigPose);
+  if (!isClose(rigPose.Position, 0, 0, 10) ||
+      !isClose(rigPose.FocalPoint, 0, 0, 0) ||
+      !isClose(rigPose.ViewUp, 0, 1, 0))
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong identity rig pose";
+    printPose(rigPose);
+    return EXIT_FAILURE;
+    }
+
+  // A right eye is translated along the right of the path camera, with a
+  // parallel view direction
+  const double rightEye[16] = {1, 0, 0, 0.5,
+                               0, 1, 0, 0,
+                               0, 0, 1, 0,
+                               0, 0, 0, 1};
+  vtkMRMLCameraPathNode::ComputeRigPose(pose, rightEye, rigPose);
+  if (!isClose(rigPose.Position, 0.5, 0, 10) ||
+      !isClose(rigPose.FocalPoint, 0.5, 0, 0) ||
+      !isClose(rigPose.ViewUp, 0, 1, 0))
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong right eye pose";
+    printPose(rigPose);
+    return EXIT_FAILURE;
+    }
+
+  // A rotation around the view direction turns the view up
+  const double roll[16] = {0, -1, 0, 0,
+                           1, 0, 0, 0,
+                           0, 0, 1, 0,
+                           0, 0, 0, 1};
+  vtkMRMLCameraPathNode::ComputeRigPose(pose, roll, rigPose);
+  if (!isClose(rigPose.Position, 0, 0, 10) ||
+      !isClose(rigPose.FocalPoint, 0, 0, 0) ||
+      !isClose(rigPose.ViewUp, -1, 0, 0))
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong rolled pose";
+    printPose(rigPose);
+    return EXIT_FAILURE;
+    }
+
+  // The frame of the path camera follows its orientation and the view up
+  // is orthogonalized: looking down -x from x = 4, the right is +y
+  for (int i = 0; i < 3; ++i)
+    {
+    pose.Position[i] = 0.0;
+    pose.FocalPoint[i] = 0.0;
+    }
+  pose.Position[0] = 4.0;
+  pose.ViewUp[0] = 1.0;
+  pose.ViewUp[1] = 0.0;
+  pose.ViewUp[2] = 2.0;
+  vtkMRMLCameraPathNode::ComputeRigPose(pose, rightEye, rigPose);
+  if (!isClose(rigPose.Position, 4, 0.5, 0) ||
+      !isClose(rigPose.FocalPoint, 0, 0.5, 0) ||
+      !isClose(rigPose.ViewUp, 0, 0, 1))
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong right eye pose of a "
+              << "rotated camera";
+    printPose(rigPose);
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
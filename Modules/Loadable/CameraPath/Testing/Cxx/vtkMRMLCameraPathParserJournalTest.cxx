@@ -0,0 +1,198 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath MRML includes
+#include "vtkMRMLCameraPathParser.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Pose whose values all derive from \a seed
+void addKeyFrame(CameraPathData& data, double time, double seed)
+{
+  data.Times.push_back(time);
+  for (int i = 0; i < 9; ++i)
+    {
+    data.Poses.push_back(seed + i);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Whether \a data has the keyframes at \a times, in order, with the poses
+// of \a seeds
+bool hasKeyFrames(const CameraPathData& data, int numberOfKeyFrames,
+                  const double* times, const double* seeds)
+{
+  if (static_cast<int>(data.Times.size()) != numberOfKeyFrames ||
+      static_cast<int>(data.Poses.size()) != 9 * numberOfKeyFrames)
+    {
+    std::cerr << data.Times.size() << " keyframes instead of "
+              << numberOfKeyFrames << std::endl;
+    return false;
+    }
+  for (int k = 0; k < numberOfKeyFrames; ++k)
+    {
+    if (data.Times[k] != times[k])
+      {
+      std::cerr << "Keyframe " << k << " at " << data.Times[k]
+                << " instead of " << times[k] << std::endl;
+      return false;
+      }
+    for (int i = 0; i < 9; ++i)
+      {
+      if (data.Poses[9 * k + i] != seeds[k] + i)
+        {
+        std::cerr << "Wrong pose of keyframe " << k << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+int vtkMRMLCameraPathParserJournalTest(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " <temporary directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string fileName =
+    std::string(argv[1]) + "/vtkMRMLCameraPathParserJournalTest.kcsv";
+
+  vtkNew<vtkMRMLCameraPathParser> parser;
+  parser->SetFileName(fileName.c_str());
+  const std::string journalName = parser->GetJournalFileName();
+  if (journalName != fileName + ".journal")
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong journal file name "
+              << journalName << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtksys::SystemTools::RemoveFile(journalName.c_str());
+
+  CameraPathData data;
+  addKeyFrame(data, 0.0, 10.0);
+  addKeyFrame(data, 1.0, 20.0);
+  if (!parser->WritePathData(data))
+    {
+    std::cerr << "Line " << __LINE__ << ": unable to write " << fileName
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Edits made after the file was written are replayed in order: keyframes
+  // moved by "modify" and added by "add" go after the others
+  double values[11] = {2.0, 30.0, 31.0, 32.0, 33.0, 34.0, 35.0, 36.0, 37.0, 38.0};
+  parser->AppendJournalEntry("add", values, 10);
+  values[0] = 1.0;
+  values[1] = 1.5;
+  for (int i = 0; i < 9; ++i)
+    {
+    values[2 + i] = 40.0 + i;
+    }
+  parser->AppendJournalEntry("modify", values, 11);
+  values[0] = 0.0;
+  parser->AppendJournalEntry("remove", values, 1);
+  // A line truncated by a crash is skipped
+  values[0] = 3.0;
+  parser->AppendJournalEntry("add", values, 4);
+
+  CameraPathData readData;
+  const double editedTimes[2] = {2.0, 1.5};
+  const double editedSeeds[2] = {30.0, 40.0};
+  if (!parser->ReadPathData(readData, false) ||
+      !hasKeyFrames(readData, 2, editedTimes, editedSeeds))
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong replayed keyframes" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!readData.KeyFrameLines.empty() || readData.PathComputed)
+    {
+    std::cerr << "Line " << __LINE__ << ": the path cache of the file is used "
+              << "for the replayed keyframes" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The header of the file is replaced by the one of the replayed keyframes
+  CameraPathHeader header;
+  if (!parser->ReadHeader(header) || header.NumberOfKeyFrames != 2 ||
+      header.TimeRange[0] != 1.5 || header.TimeRange[1] != 2.0)
+    {
+    std::cerr << "Line " << __LINE__ << ": header of the file read instead "
+              << "of the replayed keyframes" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A reset journal replaces the keyframes of the file
+  CameraPathData resetData;
+  addKeyFrame(resetData, 5.0, 50.0);
+  const double resetTimes[1] = {5.0};
+  const double resetSeeds[1] = {50.0};
+  if (!parser->ResetJournal(resetData) ||
+      !parser->ReadPathData(readData, false) ||
+      !hasKeyFrames(readData, 1, resetTimes, resetSeeds))
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong keyframes after a reset"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (vtksys::SystemTools::FileExists((journalName + ".tmp").c_str(), true))
+    {
+    std::cerr << "Line " << __LINE__ << ": temporary journal left" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A file that can't be written keeps its journal
+  const std::string temporaryName = fileName + ".tmp";
+  vtksys::SystemTools::MakeDirectory(temporaryName.c_str());
+  if (parser->WritePathData(data) ||
+      !vtksys::SystemTools::FileExists(journalName.c_str(), true) ||
+      !parser->ReadPathData(readData, false) ||
+      !hasKeyFrames(readData, 1, resetTimes, resetSeeds))
+    {
+    std::cerr << "Line " << __LINE__ << ": journal lost by a failed write"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtksys::SystemTools::RemoveADirectory(temporaryName.c_str());
+
+  // Writing the file compacts the journal
+  if (!parser->WritePathData(readData) ||
+      vtksys::SystemTools::FileExists(journalName.c_str(), true) ||
+      !parser->ReadPathData(readData, false) ||
+      !hasKeyFrames(readData, 1, resetTimes, resetSeeds))
+    {
+    std::cerr << "Line " << __LINE__ << ": journal not compacted" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtksys::SystemTools::RemoveFile(fileName.c_str());
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathDownscaler.h"
+
+// VTK includes
+#include <vtkNew.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Area of the source pixel j covered by the target pixel i along an axis,
+// relative to the area of the target pixel
+double coverage(int sourceSize, int size, int i, int j)
+{
+  const double scale = static_cast<double>(sourceSize) / size;
+  const double start = std::max(i * scale, static_cast<double>(j));
+  const double end = std::min((i + 1) * scale, j + 1.0);
+  return end > start ? (end - start) / scale : 0.0;
+}
+
+//----------------------------------------------------------------------------
+// Downscale a random image and compare to the area average computed in
+// double precision, the fixed point weights rounding by at most one level
+bool testImage(vtkSlicerCameraPathDownscaler* downscaler, int sourceWidth,
+               int sourceHeight, int components, int width, int height)
+{
+  std::vector<unsigned char> source(
+    static_cast<size_t>(sourceWidth) * sourceHeight * components);
+  for (size_t i = 0; i < source.size(); ++i)
+    {
+    source[i] = static_cast<unsigned char>(rand() % 256);
+    }
+  std::vector<unsigned char> target(static_cast<size_t>(width) * height * components);
+  if (!downscaler->Downscale(&source[0], sourceWidth, sourceHeight, components,
+                             &target[0], width, height))
+    {
+    std::cerr << "Downscale from " << sourceWidth << "x" << sourceHeight
+              << " to " << width << "x" << height << " failed" << std::endl;
+    return false;
+    }
+
+  for (int y = 0; y < height; ++y)
+    {
+    for (int x = 0; x < width; ++x)
+      {
+      for (int c = 0; c < components; ++c)
+        {
+        double average = 0.0;
+        for (int sy = 0; sy < sourceHeight; ++sy)
+          {
+          double weightY = coverage(sourceHeight, height, y, sy);
+          for (int sx = 0; sx < sourceWidth && weightY > 0.0; ++sx)
+            {
+            average += weightY * coverage(sourceWidth, width, x, sx) *
+              source[(static_cast<size_t>(sy) * sourceWidth + sx) * components + c];
+            }
+          }
+        int value = target[(static_cast<size_t>(y) * width + x) * components + c];
+        if (fabs(value - average) > 1.0)
+          {
+          std::cerr << "Pixel " << x << "," << y << " of " << sourceWidth
+                    << "x" << sourceHeight << " downscaled to " << width
+                    << "x" << height << " is " << value << " instead of "
+                    << average << std::endl;
+          return false;
+          }
+        }
+      }
+    }
+  return true;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCameraPathDownscalerTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkSlicerCameraPathDownscaler> downscaler;
+
+  // Halving averages pairs of pixels
+  const unsigned char pairs[4 * 3] = {10, 0, 255,   30, 100, 255,
+                                      200, 7, 0,    100, 8, 1};
+  unsigned char halved[2 * 3];
+  if (!downscaler->Downscale(pairs, 4, 1, 3, halved, 2, 1) ||
+      halved[0] != 20 || halved[1] != 50 || halved[2] != 255 ||
+      halved[3] != 150 || halved[4] != 8 || halved[5] != 1)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong halved pixels" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A 3 to 2 downscale weights the middle pixel by a third in each target
+  const unsigned char thirds[3 * 3] = {0, 0, 0,   90, 90, 90,   180, 180, 180};
+  unsigned char twoThirds[2 * 3];
+  if (!downscaler->Downscale(thirds, 3, 1, 3, twoThirds, 2, 1) ||
+      twoThirds[0] != 30 || twoThirds[3] != 150)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong 3 to 2 pixels "
+              << static_cast<int>(twoThirds[0]) << " "
+              << static_cast<int>(twoThirds[3]) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The weights of each target pixel sum to 1: uniform images stay uniform
+  std::vector<unsigned char> white(97 * 61 * 4, 255);
+  std::vector<unsigned char> target(white.size());
+  for (int width = 1; width <= 97; width += 8)
+    {
+    for (int height = 1; height <= 61; height += 5)
+      {
+      downscaler->Downscale(&white[0], 97, 61, 4, &target[0], width, height);
+      for (int i = 0; i < width * height * 4; ++i)
+        {
+        if (target[i] != 255)
+          {
+          std::cerr << "Line " << __LINE__ << ": white downscaled to "
+                    << width << "x" << height << " is not white" << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  // Weights are recomputed when the sizes change, with blocks of target
+  // rows that do not divide the height
+  srand(0);
+  const int sizes[][4] = {{64, 36, 32, 18}, {64, 36, 21, 12}, {50, 40, 50, 40},
+                          {37, 41, 10, 19}, {7, 5, 1, 1}, {120, 70, 37, 17}};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+    if (!testImage(downscaler.GetPointer(), sizes[i][0], sizes[i][1], 3,
+                   sizes[i][2], sizes[i][3]) ||
+        !testImage(downscaler.GetPointer(), sizes[i][0], sizes[i][1], 4,
+                   sizes[i][2], sizes[i][3]))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
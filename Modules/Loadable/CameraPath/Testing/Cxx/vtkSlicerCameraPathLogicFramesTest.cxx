@@ -0,0 +1,80 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathLogic.h"
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCameraPathLogicFramesTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // The last frame is at or before the end of the path
+  if (vtkSlicerCameraPathLogic::GetNumberOfFrames(0.0, 10.0, 30.0) != 301 ||
+      vtkSlicerCameraPathLogic::GetNumberOfFrames(0.0, 1.0, 3.0) != 4 ||
+      vtkSlicerCameraPathLogic::GetNumberOfFrames(0.0, 0.99, 1.0) != 1 ||
+      vtkSlicerCameraPathLogic::GetNumberOfFrames(5.0, 5.0, 30.0) != 1)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong number of frames" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (vtkSlicerCameraPathLogic::GetNumberOfFrames(1.0, 0.0, 30.0) != 0 ||
+      vtkSlicerCameraPathLogic::GetNumberOfFrames(0.0, 1.0, 0.0) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": an empty range or a null "
+              << "framerate has frames" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (fabs(vtkSlicerCameraPathLogic::GetFrameTime(2.0, 3, 30.0) - 2.1) > 1e-12 ||
+      vtkSlicerCameraPathLogic::GetFrameTime(2.0, 3, 0.0) != 2.0)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong frame time" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (vtkSlicerCameraPathLogic::GetFrameAt(1.0, 1.05, 10.0) != 0 ||
+      vtkSlicerCameraPathLogic::GetFrameAt(1.0, 1.1, 10.0) != 1 ||
+      vtkSlicerCameraPathLogic::GetFrameAt(1.0, 1.0, 0.0) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong frame at time" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Times computed from frames map back to their frame despite the rounding
+  const double framerates[3] = {24.0, 29.97, 60.0};
+  for (int f = 0; f < 3; ++f)
+    {
+    for (int frame = 0; frame < 100000; ++frame)
+      {
+      double t = vtkSlicerCameraPathLogic::GetFrameTime(-3.7, frame, framerates[f]);
+      int frameAt = vtkSlicerCameraPathLogic::GetFrameAt(-3.7, t, framerates[f]);
+      if (frameAt != frame)
+        {
+        std::cerr << "Line " << __LINE__ << ": frame " << frame << " at "
+                  << framerates[f] << " fps is found at frame " << frameAt
+                  << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,97 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathLogic.h"
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCameraPathLogicOutputsTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  std::vector<ExportOutput> outputs;
+  if (!vtkSlicerCameraPathLogic::ParseExportOutputs(
+        " 1280x720, 640X360.png 320x180.webm,,", outputs) ||
+      outputs.size() != 3 ||
+      outputs[0].Width != 1280 || outputs[0].Height != 720 ||
+      !outputs[0].Extension.empty() ||
+      outputs[1].Width != 640 || outputs[1].Height != 360 ||
+      outputs[1].Extension != "png" ||
+      outputs[2].Width != 320 || outputs[2].Height != 180 ||
+      outputs[2].Extension != "webm")
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong outputs parsed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!vtkSlicerCameraPathLogic::ParseExportOutputs("", outputs) ||
+      !outputs.empty())
+    {
+    std::cerr << "Line " << __LINE__ << ": no output expected" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const char* invalidOutputs[] = {"1280", "1280x", "x720", "0x720",
+                                  "1280x-720", "1280x720.", "12a0x720",
+                                  "1280x720x2", "640x360, 1280"};
+  for (size_t i = 0; i < sizeof(invalidOutputs) / sizeof(invalidOutputs[0]); ++i)
+    {
+    if (vtkSlicerCameraPathLogic::ParseExportOutputs(invalidOutputs[i], outputs))
+      {
+      std::cerr << "Line " << __LINE__ << ": invalid output \""
+                << invalidOutputs[i] << "\" accepted" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Outputs keep the aspect ratio of the frames, up to the rounding of
+  // their size
+  ExportOutput output;
+  output.Width = 1280;
+  output.Height = 720;
+  if (!vtkSlicerCameraPathLogic::HasFrameAspectRatio(output, 1920, 1080) ||
+      !vtkSlicerCameraPathLogic::HasFrameAspectRatio(output, 3840, 2160))
+    {
+    std::cerr << "Line " << __LINE__ << ": 1280x720 rejected" << std::endl;
+    return EXIT_FAILURE;
+    }
+  output.Width = 854;
+  output.Height = 480;
+  if (!vtkSlicerCameraPathLogic::HasFrameAspectRatio(output, 1920, 1080))
+    {
+    std::cerr << "Line " << __LINE__ << ": rounded 854x480 rejected" << std::endl;
+    return EXIT_FAILURE;
+    }
+  output.Width = 1280;
+  output.Height = 1024;
+  if (vtkSlicerCameraPathLogic::HasFrameAspectRatio(output, 1920, 1080) ||
+      vtkSlicerCameraPathLogic::HasFrameAspectRatio(output, 0, 1080))
+    {
+    std::cerr << "Line " << __LINE__ << ": 1280x1024 accepted" << std::endl;
+    return EXIT_FAILURE;
+    }
+  output.Width = 1920;
+  output.Height = 1082;
+  if (vtkSlicerCameraPathLogic::HasFrameAspectRatio(output, 3840, 2160))
+    {
+    std::cerr << "Line " << __LINE__ << ": 1920x1082 accepted" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
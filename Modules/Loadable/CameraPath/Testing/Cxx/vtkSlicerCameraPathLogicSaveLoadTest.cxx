@@ -0,0 +1,167 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathLogic.h"
+
+// CameraPath MRML includes
+#include "vtkMRMLCameraPathNode.h"
+#include "vtkMRMLCameraPathStorageNode.h"
+
+// MRML includes
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCameraPathLogicSaveLoadTest(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " <temporary directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkSlicerCameraPathLogic> logic;
+  logic->SetMRMLScene(scene.GetPointer());
+  logic->SetNumberOfThreads(2);
+
+  // Paths of 2 to 4 keyframes, the keyframe k of path p being at x = 10p + k
+  const int numberOfPaths = 3;
+  std::vector<vtkMRMLCameraPathNode*> nodes;
+  std::vector<std::string> fileNames;
+  for (int p = 0; p < numberOfPaths; ++p)
+    {
+    vtkSmartPointer<vtkMRMLCameraPathNode> node =
+      vtkSmartPointer<vtkMRMLCameraPathNode>::New();
+    scene->AddNode(node);
+    for (int k = 0; k < p + 2; ++k)
+      {
+      double position[3] = {10.0 * p + k, 0.0, 10.0};
+      double focalPoint[3] = {10.0 * p + k, 0.0, 0.0};
+      double viewUp[3] = {0.0, 1.0, 0.0};
+      node->AddKeyFrame(k, position, focalPoint, viewUp);
+      }
+    nodes.push_back(node);
+
+    std::stringstream fileName;
+    fileName << argv[1] << "/vtkSlicerCameraPathLogicSaveLoadTest" << p << ".kcsv";
+    fileNames.push_back(fileName.str());
+    vtksys::SystemTools::RemoveFile(fileNames.back().c_str());
+    }
+
+  // Each node is saved to its file, which it is then stored in
+  std::vector<std::string> missingFileNames(1, fileNames[0]);
+  if (logic->SaveCameraPaths(nodes, missingFileNames))
+    {
+    std::cerr << "Line " << __LINE__ << ": saved without a file per node"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!logic->SaveCameraPaths(nodes, fileNames))
+    {
+    std::cerr << "Line " << __LINE__ << ": could not save the paths"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  for (int p = 0; p < numberOfPaths; ++p)
+    {
+    vtkMRMLCameraPathStorageNode* storageNode =
+      vtkMRMLCameraPathStorageNode::SafeDownCast(nodes[p]->GetStorageNode());
+    if (!storageNode || !storageNode->GetFileName() ||
+        fileNames[p] != storageNode->GetFileName())
+      {
+      std::cerr << "Line " << __LINE__ << ": path " << p
+                << " not stored in its file" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The files are loaded back as nodes named after them, in order
+  char* nodeIDs = logic->LoadCameraPaths(fileNames);
+  if (!nodeIDs)
+    {
+    std::cerr << "Line " << __LINE__ << ": could not load the paths"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::vector<vtkMRMLCameraPathNode*> loadedNodes;
+  std::stringstream ids(nodeIDs);
+  free(nodeIDs);
+  std::string id;
+  while (std::getline(ids, id, ','))
+    {
+    vtkMRMLCameraPathNode* node =
+      vtkMRMLCameraPathNode::SafeDownCast(scene->GetNodeByID(id.c_str()));
+    if (node)
+      {
+      loadedNodes.push_back(node);
+      }
+    }
+  if (static_cast<int>(loadedNodes.size()) != numberOfPaths)
+    {
+    std::cerr << "Line " << __LINE__ << ": " << loadedNodes.size()
+              << " paths loaded instead of " << numberOfPaths << std::endl;
+    return EXIT_FAILURE;
+    }
+  for (int p = 0; p < numberOfPaths; ++p)
+    {
+    vtkMRMLCameraPathNode* node = loadedNodes[p];
+    std::stringstream name;
+    name << "vtkSlicerCameraPathLogicSaveLoadTest" << p;
+    if (!node->GetName() || name.str() != node->GetName())
+      {
+      std::cerr << "Line " << __LINE__ << ": path " << p << " named "
+                << (node->GetName() ? node->GetName() : "(null)")
+                << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (node->GetNumberOfKeyFrames() != p + 2)
+      {
+      std::cerr << "Line " << __LINE__ << ": path " << p << " has "
+                << node->GetNumberOfKeyFrames() << " keyframes" << std::endl;
+      return EXIT_FAILURE;
+      }
+    for (int k = 0; k < p + 2; ++k)
+      {
+      double position[3];
+      node->GetKeyFramePosition(k, position);
+      if (node->GetKeyFrameTime(k) != k || position[0] != 10.0 * p + k ||
+          position[1] != 0.0 || position[2] != 10.0)
+        {
+        std::cerr << "Line " << __LINE__ << ": wrong keyframe " << k
+                  << " of path " << p << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  for (int p = 0; p < numberOfPaths; ++p)
+    {
+    vtksys::SystemTools::RemoveFile(fileNames[p].c_str());
+    }
+  return EXIT_SUCCESS;
+}
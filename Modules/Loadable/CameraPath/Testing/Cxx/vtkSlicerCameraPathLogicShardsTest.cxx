@@ -0,0 +1,91 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathLogic.h"
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCameraPathLogicShardsTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  int first = 0;
+  int last = 0;
+
+  // 10 frames in 3 shards: the first shard gets the extra frame
+  const int expected[3][2] = {{5, 8}, {9, 11}, {12, 14}};
+  for (int shard = 0; shard < 3; ++shard)
+    {
+    if (!vtkSlicerCameraPathLogic::GetShardFrameRange(5, 14, shard, 3, first, last) ||
+        first != expected[shard][0] || last != expected[shard][1])
+      {
+      std::cerr << "Line " << __LINE__ << ": shard " << shard << " is "
+                << first << "-" << last << " instead of " << expected[shard][0]
+                << "-" << expected[shard][1] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Shards cover the range in order without overlap, sizes differing by one
+  for (int numberOfFrames = 1; numberOfFrames <= 40; ++numberOfFrames)
+    {
+    for (int shardCount = 1; shardCount <= numberOfFrames; ++shardCount)
+      {
+      int next = 100;
+      int minSize = numberOfFrames;
+      int maxSize = 0;
+      for (int shard = 0; shard < shardCount; ++shard)
+        {
+        if (!vtkSlicerCameraPathLogic::GetShardFrameRange(
+              100, 100 + numberOfFrames - 1, shard, shardCount, first, last) ||
+            first != next || last < first)
+          {
+          std::cerr << "Line " << __LINE__ << ": shard " << shard << " of "
+                    << shardCount << " over " << numberOfFrames
+                    << " frames is " << first << "-" << last << std::endl;
+          return EXIT_FAILURE;
+          }
+        next = last + 1;
+        minSize = std::min(minSize, last - first + 1);
+        maxSize = std::max(maxSize, last - first + 1);
+        }
+      if (next != 100 + numberOfFrames || maxSize - minSize > 1)
+        {
+        std::cerr << "Line " << __LINE__ << ": " << shardCount << " shards do "
+                  << "not split " << numberOfFrames << " frames evenly"
+                  << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // Shards without frames and invalid shards are rejected
+  if (vtkSlicerCameraPathLogic::GetShardFrameRange(0, 1, 2, 3, first, last) ||
+      vtkSlicerCameraPathLogic::GetShardFrameRange(0, 9, 3, 3, first, last) ||
+      vtkSlicerCameraPathLogic::GetShardFrameRange(0, 9, -1, 3, first, last) ||
+      vtkSlicerCameraPathLogic::GetShardFrameRange(0, 9, 0, 0, first, last) ||
+      vtkSlicerCameraPathLogic::GetShardFrameRange(9, 0, 0, 1, first, last))
+    {
+    std::cerr << "Line " << __LINE__ << ": invalid shard accepted" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
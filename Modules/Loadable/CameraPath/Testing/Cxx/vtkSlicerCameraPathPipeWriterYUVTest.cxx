@@ -0,0 +1,166 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathPipeWriter.h"
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+int clampByte(int value)
+{
+  return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+//----------------------------------------------------------------------------
+// Component c of the pixel at column x of the row y from the top, the
+// borders of odd sizes being repeated
+int component(const std::vector<unsigned char>& rgb, int width, int height,
+              int components, int x, int y, int c)
+{
+  x = x < width ? x : width - 1;
+  y = y < height ? y : height - 1;
+  return rgb[(static_cast<size_t>(height - 1 - y) * width + x) * components + c];
+}
+
+//----------------------------------------------------------------------------
+// Convert an image pixel by pixel and compare to ConvertRGBToYUV420()
+bool testImage(int width, int height, int components)
+{
+  std::vector<unsigned char> rgb(static_cast<size_t>(width) * height * components);
+  for (size_t i = 0; i < rgb.size(); ++i)
+    {
+    rgb[i] = static_cast<unsigned char>(rand() % 256);
+    }
+  const int chromaWidth = (width + 1) / 2;
+  const int chromaHeight = (height + 1) / 2;
+  std::vector<unsigned char> y(static_cast<size_t>(width) * height);
+  std::vector<unsigned char> u(static_cast<size_t>(chromaWidth) * chromaHeight);
+  std::vector<unsigned char> v(u.size());
+  vtkSlicerCameraPathPipeWriter::ConvertRGBToYUV420(&rgb[0], width, height,
+                                                    components, &y[0], &u[0],
+                                                    &v[0]);
+
+  for (int row = 0; row < height; ++row)
+    {
+    for (int x = 0; x < width; ++x)
+      {
+      int luma = (77 * component(rgb, width, height, components, x, row, 0) +
+                  150 * component(rgb, width, height, components, x, row, 1) +
+                  29 * component(rgb, width, height, components, x, row, 2) +
+                  128) >> 8;
+      if (y[row * width + x] != luma)
+        {
+        std::cerr << "Luma of " << x << "," << row << " in " << width << "x"
+                  << height << "x" << components << " is "
+                  << static_cast<int>(y[row * width + x]) << " instead of "
+                  << luma << std::endl;
+        return false;
+        }
+      }
+    }
+
+  for (int row = 0; row < chromaHeight; ++row)
+    {
+    for (int x = 0; x < chromaWidth; ++x)
+      {
+      int sums[3] = {0, 0, 0};
+      for (int c = 0; c < 3; ++c)
+        {
+        for (int j = 0; j < 4; ++j)
+          {
+          sums[c] += component(rgb, width, height, components,
+                               2 * x + j % 2, 2 * row + j / 2, c);
+          }
+        }
+      int chromaU = clampByte(
+        ((-43 * sums[0] - 85 * sums[1] + 128 * sums[2] + 512) >> 10) + 128);
+      int chromaV = clampByte(
+        ((128 * sums[0] - 107 * sums[1] - 21 * sums[2] + 512) >> 10) + 128);
+      if (u[row * chromaWidth + x] != chromaU ||
+          v[row * chromaWidth + x] != chromaV)
+        {
+        std::cerr << "Chroma of " << x << "," << row << " in " << width << "x"
+                  << height << "x" << components << " is "
+                  << static_cast<int>(u[row * chromaWidth + x]) << ","
+                  << static_cast<int>(v[row * chromaWidth + x])
+                  << " instead of " << chromaU << "," << chromaV << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCameraPathPipeWriterYUVTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // Full range values of primary colors, the bottom row of the image being
+  // the last row of the planes
+  const unsigned char rgb[2 * 2 * 3] = {255, 0, 0,   255, 0, 0,
+                                        0, 0, 255,   0, 0, 255};
+  unsigned char y[4];
+  unsigned char u[1];
+  unsigned char v[1];
+  vtkSlicerCameraPathPipeWriter::ConvertRGBToYUV420(rgb, 2, 2, 3, y, u, v);
+  if (y[0] != 29 || y[1] != 29 || y[2] != 77 || y[3] != 77)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong luma of blue over red "
+              << static_cast<int>(y[0]) << " " << static_cast<int>(y[2])
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  // Average of red (85, 255) and blue (255, 107)
+  if (u[0] != 170 || v[0] != 181)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong chroma of blue over red "
+              << static_cast<int>(u[0]) << " " << static_cast<int>(v[0])
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned char white[4] = {255, 255, 255, 255};
+  vtkSlicerCameraPathPipeWriter::ConvertRGBToYUV420(white, 1, 1, 4, y, u, v);
+  if (y[0] != 255 || u[0] != 128 || v[0] != 128)
+    {
+    std::cerr << "Line " << __LINE__ << ": white is not full range" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Odd sizes repeat the last column and row in the chroma samples
+  srand(0);
+  for (int width = 1; width <= 37; width += 3)
+    {
+    for (int height = 1; height <= 9; ++height)
+      {
+      if (!testImage(width, height, 3) || !testImage(width, height, 4))
+        {
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
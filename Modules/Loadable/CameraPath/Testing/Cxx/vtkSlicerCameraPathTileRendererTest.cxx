@@ -0,0 +1,112 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// CameraPath Logic includes
+#include "vtkSlicerCameraPathTileRenderer.h"
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCameraPathTileRendererTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // Tiles on the right and top borders are cropped
+  const int sizes[4][2][2] = {{{1920, 1080}, {1920, 1080}},
+                              {{3840, 2160}, {1920, 1080}},
+                              {{2000, 1000}, {1920, 1080}},
+                              {{7680, 4320}, {1000, 1000}}};
+  const int expectedTiles[4][2] = {{1, 1}, {2, 2}, {2, 1}, {8, 5}};
+  for (int i = 0; i < 4; ++i)
+    {
+    int numberOfTiles[2];
+    vtkSlicerCameraPathTileRenderer::GetNumberOfTiles(sizes[i][0], sizes[i][1],
+                                                      numberOfTiles);
+    if (numberOfTiles[0] != expectedTiles[i][0] ||
+        numberOfTiles[1] != expectedTiles[i][1])
+      {
+      std::cerr << "Line " << __LINE__ << ": " << numberOfTiles[0] << "x"
+                << numberOfTiles[1] << " tiles instead of "
+                << expectedTiles[i][0] << "x" << expectedTiles[i][1]
+                << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  const int emptyTile[2] = {0, 1080};
+  int numberOfTiles[2];
+  vtkSlicerCameraPathTileRenderer::GetNumberOfTiles(sizes[0][0], emptyTile,
+                                                    numberOfTiles);
+  if (numberOfTiles[0] != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": empty tiles cover the image"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A single tile keeps the window center of the camera
+  const double windowCenter[2] = {0.2, -0.4};
+  const int origin[2] = {0, 0};
+  double tileWindowCenter[2];
+  vtkSlicerCameraPathTileRenderer::GetTileWindowCenter(
+    sizes[0][0], sizes[0][1], origin, windowCenter, tileWindowCenter);
+  if (fabs(tileWindowCenter[0] - 0.2) > 1e-12 ||
+      fabs(tileWindowCenter[1] + 0.4) > 1e-12)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong window center of a single "
+              << "tile " << tileWindowCenter[0] << "," << tileWindowCenter[1]
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Each tile of a 3x1 grid, the last one cropped, is centered on its part
+  // of the view: a point at x in the view is at (x - c) / s in the tile of
+  // center c and scale s, so the tile window center is c / s
+  const int size[2] = {250, 100};
+  const int tileSize[2] = {100, 100};
+  const double centered[2] = {0.0, 0.0};
+  const double expectedCenters[3] = {-1.5, 0.5, 2.5};
+  for (int column = 0; column < 3; ++column)
+    {
+    const int tileOrigin[2] = {column * tileSize[0], 0};
+    vtkSlicerCameraPathTileRenderer::GetTileWindowCenter(
+      size, tileSize, tileOrigin, centered, tileWindowCenter);
+    if (fabs(tileWindowCenter[0] - expectedCenters[column]) > 1e-12 ||
+        fabs(tileWindowCenter[1]) > 1e-12)
+      {
+      std::cerr << "Line " << __LINE__ << ": wrong window center of tile "
+                << column << " " << tileWindowCenter[0] << ","
+                << tileWindowCenter[1] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The window center of the camera is scaled with the tile
+  const int quarterOrigin[2] = {1920, 0};
+  vtkSlicerCameraPathTileRenderer::GetTileWindowCenter(
+    sizes[1][0], sizes[1][1], quarterOrigin, windowCenter, tileWindowCenter);
+  if (fabs(tileWindowCenter[0] - 1.4) > 1e-12 ||
+      fabs(tileWindowCenter[1] + 1.8) > 1e-12)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong window center of an offset "
+              << "camera " << tileWindowCenter[0] << ","
+              << tileWindowCenter[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -17,26 +17,42 @@
 
 // Qt includes
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QTimer>
 #include <QInputDialog>
 #include <QtGlobal>
 #include <QProgressDialog>
 
+// STD includes
+#include <map>
+#include <vector>
+
 // CTK includes
 #include "ctkMessageBox.h"
 #include "ctkFileDialog.h"
 
 // SlicerQt includes
 #include "qSlicerCameraPathModuleWidget.h"
+#include "qSlicerCameraPathPoseBuffer.h"
 #include "ui_qSlicerCameraPathModuleWidget.h"
 
 // CameraPath includes
+#include "vtkSlicerCameraPathCommandEncoder.h"
+#include "vtkSlicerCameraPathDownscaler.h"
+#include "vtkSlicerCameraPathExporter.h"
+#include "vtkSlicerCameraPathFFMPEGEncoder.h"
 #include "vtkSlicerCameraPathLogic.h"
+#include "vtkSlicerCameraPathOffscreenView.h"
+#include "vtkSlicerCameraPathPipeWriter.h"
+#include "vtkSlicerCameraPathStatistics.h"
+#include "vtkSlicerCameraPathTileRenderer.h"
 #include "vtkMRMLCameraPathNode.h"
 
 // VTK includes
 #include "vtkNew.h"
+#include "vtkSmartPointer.h"
 #include "vtkCamera.h"
+#include "vtkMath.h"
 #include "vtkMRMLScene.h"
 
 // Test Export
@@ -46,10 +62,43 @@
 #include "qMRMLLayoutViewFactory.h"
 #include "qMRMLThreeDWidget.h"
 #include "qMRMLThreeDView.h"
+#include "qMRMLCheckableNodeComboBox.h"
 #include "vtkRenderWindow.h"
-#include "vtkWindowToImageFilter.h"
-#include "vtkPNGWriter.h"
-#include "vtkFFMPEGWriter.h"
+#include "vtkRenderWindowInteractor.h"
+#include "vtkAlgorithmOutput.h"
+#include "vtkImageAppend.h"
+#include "vtkImageData.h"
+
+//-----------------------------------------------------------------------------
+namespace
+{
+
+// Number of steps of the time slider over the path time range
+const int TIME_SLIDER_RESOLUTION = 1000;
+
+// Move a camera to a path pose, with a clipping range fitting the pose
+void applyCameraPose(vtkMRMLCameraNode* cameraNode, const CameraPose& pose)
+{
+  double distance = sqrt(vtkMath::Distance2BetweenPoints(pose.Position,
+                                                         pose.FocalPoint));
+  double clippingRange[2] = {0.1, distance*6};
+  vtkMRMLCameraPathNode::ApplyCameraPose(cameraNode, pose, clippingRange);
+}
+
+// Downscaled output of an export, written by its own screenshot writers or
+// video encoder
+struct OutputWriter
+{
+  ExportOutput Output;
+  /// Base name of the screenshots of the output
+  std::string BaseName;
+  vtkSmartPointer<vtkSlicerCameraPathDownscaler> Downscaler;
+  vtkSmartPointer<vtkImageData> Image;
+  vtkSmartPointer<vtkSlicerCameraPathExporter> Exporter;
+  vtkSmartPointer<vtkSlicerCameraPathVideoEncoder> Encoder;
+};
+
+}
 
 //-----------------------------------------------------------------------------
 /// \ingroup Slicer_QtModules_ExtensionTemplate
@@ -66,10 +115,58 @@ public:
 
   void init();
 
+  /// Start writing screenshots compressed for the export quality, frames
+  /// already listed in the manifest of \a baseName being skipped
+  bool startExporter(vtkSlicerCameraPathExporter* exporter,
+                     const std::string& path, const std::string& baseName,
+                     int firstFrame, int lastFrame, const std::string& hash,
+                     int width, int height, int framerate);
+
+  /// Create and start the video encoder of the export type and codec
+  /// settings, writing \a fileName. Return 0 on failure.
+  vtkSmartPointer<vtkSlicerCameraPathVideoEncoder> startEncoder(
+    int exportType, const QString& fileName, int width, int height,
+    int framerate);
+
 private:
 
   QTimer* Timer;
 
+  /// Time of the path shown in the cameras
+  double Time;
+
+  /// Slider values are coalesced while scrubbing: only the last one is
+  /// evaluated, once the render of the previous one is done
+  QTimer* ScrubTimer;
+  double ScrubTime;
+
+  /// Playback is driven by the elapsed wall time since PlaybackStartTime
+  /// was displayed, so that frames are dropped if rendering is too slow
+  QElapsedTimer PlaybackClock;
+  double PlaybackStartTime;
+  /// Last frame shown during playback
+  int PlaybackFrame;
+
+  /// Poses of the next frames, computed ahead during playback
+  qSlicerCameraPathPoseBuffer* PoseBuffer;
+
+  /// Render window of the playback view, whose render times are recorded
+  /// during playback
+  vtkRenderWindow* PlaybackRenderWindow;
+  double RenderStartTime;
+
+  /// Adaptive quality during playback: the desired update rate of the
+  /// playback render window follows the render times to fit in
+  /// PlaybackFrameTime (0 if disabled). StillUpdateRate is restored on pause.
+  double PlaybackFrameTime;
+  double PlaybackUpdateRate;
+  double StillUpdateRate;
+  /// The next render is at full quality, after a seek
+  bool FullQualityRender;
+
+  /// Offscreen copy of the export view, kept between exports
+  vtkSmartPointer<vtkSlicerCameraPathOffscreenView> ExportView;
+
 };
 
 //-----------------------------------------------------------------------------
@@ -81,11 +178,31 @@ qSlicerCameraPathModuleWidgetPrivate
   : q_ptr(&object)
 {
   this->Timer = new QTimer();
+#if QT_VERSION >= 0x050000
+  this->Timer->setTimerType(Qt::PreciseTimer);
+#endif
+  this->Time = 0.0;
+  this->ScrubTimer = new QTimer();
+  this->ScrubTimer->setSingleShot(true);
+  this->ScrubTimer->setInterval(0);
+  this->ScrubTime = 0.0;
+  this->PlaybackStartTime = 0.0;
+  this->PlaybackFrame = 0;
+  this->PoseBuffer = new qSlicerCameraPathPoseBuffer();
+  this->PlaybackRenderWindow = 0;
+  this->RenderStartTime = 0.0;
+  this->PlaybackFrameTime = 0.0;
+  this->PlaybackUpdateRate = 0.0;
+  this->StillUpdateRate = 0.0;
+  this->FullQualityRender = false;
+  this->ExportView = vtkSmartPointer<vtkSlicerCameraPathOffscreenView>::New();
 }
 
 //-----------------------------------------------------------------------------
 qSlicerCameraPathModuleWidgetPrivate::~qSlicerCameraPathModuleWidgetPrivate()
 {
+  delete this->PoseBuffer;
+  delete this->ScrubTimer;
   delete this->Timer;
 }
 
@@ -103,6 +220,74 @@ qSlicerCameraPathModuleWidgetPrivate::logic() const
   return logic;
 }
 
+//-----------------------------------------------------------------------------
+bool qSlicerCameraPathModuleWidgetPrivate::startExporter(
+  vtkSlicerCameraPathExporter* exporter, const std::string& path,
+  const std::string& baseName, int firstFrame, int lastFrame,
+  const std::string& hash, int width, int height, int framerate)
+{
+  switch(this->exportQualityComboBox->currentIndex()){
+  case qSlicerCameraPathModuleWidget::LOW:
+    exporter->SetCompressionLevel(9);
+    break;
+  case qSlicerCameraPathModuleWidget::MEDIUM:
+    exporter->SetCompressionLevel(5);
+    break;
+  case qSlicerCameraPathModuleWidget::HIGH:
+    exporter->SetCompressionLevel(1);
+    break;
+    }
+
+  // Frames already written by an interrupted export of the same path,
+  // display state, size, framerate and compression are not rendered again
+  exporter->SetManifestFileName(vtkSlicerCameraPathLogic::GetManifestFileName(
+    path, baseName, firstFrame, lastFrame).c_str());
+  exporter->SetExportSettings(hash.c_str(), width, height, framerate);
+  return exporter->Start();
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkSlicerCameraPathVideoEncoder>
+qSlicerCameraPathModuleWidgetPrivate::startEncoder(int exportType,
+                                                   const QString& fileName,
+                                                   int width, int height,
+                                                   int framerate)
+{
+  // H.264, H.265 and VP9 are encoded by an ffmpeg process, and custom
+  // commands get the raw frames
+  vtkSmartPointer<vtkSlicerCameraPathVideoEncoder> encoder;
+  const int codec = this->exportCodecComboBox->currentIndex();
+  if(exportType == qSlicerCameraPathModuleWidget::VIDEOCLIP &&
+     codec == vtkSlicerCameraPathVideoEncoder::MPEG4)
+    {
+    encoder.TakeReference(vtkSlicerCameraPathFFMPEGEncoder::New());
+    }
+  else
+    {
+    vtkSmartPointer<vtkSlicerCameraPathCommandEncoder> commandEncoder =
+      vtkSmartPointer<vtkSlicerCameraPathCommandEncoder>::New();
+    if(exportType == qSlicerCameraPathModuleWidget::ENCODERCOMMAND)
+      {
+      commandEncoder->SetCommand(this->exportCommandLineEdit->text().toStdString().c_str());
+      }
+    encoder = commandEncoder.GetPointer();
+    }
+  encoder->SetCodec(codec);
+  // A bit rate of 0 encodes at the constant rate factor
+  const int bitRate = this->exportBitRateSpinBox->value();
+  encoder->SetConstantRateFactor(bitRate > 0 ? -1 : this->exportCRFSpinBox->value());
+  encoder->SetBitRate(bitRate);
+  encoder->SetGOPSize(this->exportGOPSpinBox->value());
+  encoder->SetNumberOfThreads(this->exportThreadsSpinBox->value());
+  encoder->SetFileName(fileName.toStdString().c_str());
+  encoder->SetRate(framerate);
+  if (!encoder->Start(width, height))
+    {
+    return 0;
+    }
+  return encoder;
+}
+
 //-----------------------------------------------------------------------------
 // qSlicerCameraPathModuleWidget methods
 
@@ -141,6 +326,7 @@ void qSlicerCameraPathModuleWidget::setup()
            this, SLOT(onCameraPathVisibilityToggled(bool)) );
 
   // Slider + play buttons
+  d->timeSlider->setRange(0, TIME_SLIDER_RESOLUTION);
   connect( d->timeSlider, SIGNAL(valueChanged(int)), this, SLOT(onTimeSliderChanged(int)) );
   connect( d->firstFramePushButton, SIGNAL(clicked()), this, SLOT(onFirstFrameClicked()) );
   connect( d->previousFramePushButton, SIGNAL(clicked()), this, SLOT(onPreviousFrameClicked()) );
@@ -148,9 +334,21 @@ void qSlicerCameraPathModuleWidget::setup()
   connect( d->nextFramePushButton, SIGNAL(clicked()), this, SLOT(onNextFrameClicked()) );
   connect( d->lastFramePushButton, SIGNAL(clicked()), this, SLOT(onLastFrameClicked()) );
   connect( d->fpsSpinBox, SIGNAL(valueChanged(int)), this, SLOT(onFPSChanged(int)) );
+  connect( d->defaultCameraComboBox, SIGNAL(currentNodeChanged(vtkMRMLNode*)),
+           this, SLOT(onDefaultCameraChanged(vtkMRMLNode*)) );
+  connect( d->frameTimeSpinBox, SIGNAL(valueChanged(int)), this, SLOT(onFrameTimeChanged(int)) );
+  connect( d->linkedCamerasComboBox, SIGNAL(currentNodeChanged(vtkMRMLNode*)),
+           this, SLOT(onLinkedCameraChanged(vtkMRMLNode*)) );
+  connect( d->linkedCamerasComboBox, SIGNAL(checkedNodesChanged()),
+           this, SLOT(onLinkedCamerasChecked()) );
+  connect( d->timeOffsetSpinBox, SIGNAL(valueChanged(double)),
+           this, SLOT(onTimeOffsetChanged(double)) );
+  connect( d->rigCameraSpinBox, SIGNAL(valueChanged(int)),
+           this, SLOT(onRigCameraChanged(int)) );
 
   this->setTimerInterval(d->fpsSpinBox->value());
   connect( d->Timer, SIGNAL(timeout()), this, SLOT(playToNextFrame()));
+  connect( d->ScrubTimer, SIGNAL(timeout()), this, SLOT(scrubToSliderTime()));
 
   // Keyframes buttons
   connect( d->deleteAllPushButton, SIGNAL(clicked()), this, SLOT(onDeleteAllClicked()) );
@@ -171,8 +369,17 @@ void qSlicerCameraPathModuleWidget::setup()
            this, SLOT(onViewNodeChanged(vtkMRMLNode*)));
   connect( d->exportCurrentSizeRadioButton, SIGNAL(clicked(bool)), this, SLOT(onCurrentSizeClicked(bool)) );
   connect( d->exportCustomSizeRadioButton, SIGNAL(clicked(bool)), this, SLOT(onCustomSizeClicked(bool)) );
+  d->exportCommandLineEdit->setText(vtkSlicerCameraPathPipeWriter::GetDefaultCommand());
+  connect( d->exportTypeComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(onExportTypeChanged(int)) );
+  connect( d->exportQualityComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(onExportQualityChanged(int)) );
+  connect( d->exportCodecComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(onExportCodecChanged(int)) );
+  connect( d->exportBitRateSpinBox, SIGNAL(valueChanged(int)), this, SLOT(onExportBitRateChanged(int)) );
   connect( d->exportPushButton, SIGNAL(clicked()), this, SLOT(onRecordClicked()) );
 
+  // Statistics
+  connect( d->statisticsResetPushButton, SIGNAL(clicked()), this, SLOT(onResetStatisticsClicked()) );
+  connect( d->statisticsExportPushButton, SIGNAL(clicked()), this, SLOT(onExportStatisticsClicked()) );
+
 }
 
 //-----------------------------------------------------------------------------
@@ -180,34 +387,40 @@ void qSlicerCameraPathModuleWidget::setTimerInterval(int framerate)
 {
   Q_D(qSlicerCameraPathModuleWidget);
 
-  double msInterval = 1000.0/(double)framerate;
-  d->Timer->setInterval(msInterval);
+  // The wall clock, not the timer, drives the frames: each tick plays the
+  // frame due at the elapsed time. The interval is rounded down to whole
+  // milliseconds so that ticks are never late for a frame, a tick finding
+  // no new frame (one in 25 at 60 fps) returning without rendering.
+  d->Timer->setInterval(1000 / framerate);
 }
 
 //-----------------------------------------------------------------------------
-void qSlicerCameraPathModuleWidget::updateSliderRange()
+void qSlicerCameraPathModuleWidget::updateTimeSlider()
 {
   Q_D(qSlicerCameraPathModuleWidget);
 
   vtkMRMLCameraPathNode* cameraPathNode =
       vtkMRMLCameraPathNode::SafeDownCast(d->cameraPathComboBox->currentNode());
 
-  if (!cameraPathNode)
+  // Do not move the slider back while it is dragged to a newer time
+  if (d->timeSlider->isSliderDown() || d->ScrubTimer->isActive())
     {
     return;
     }
 
-  if (cameraPathNode->GetNumberOfKeyFrames() < 2)
+  int value = 0;
+  if (cameraPathNode && cameraPathNode->GetNumberOfKeyFrames() >= 2)
     {
-    d->timeSlider->setMaximum(0);
-    return;
+    double tmax = cameraPathNode->GetMaximumT();
+    double tmin = cameraPathNode->GetMinimumT();
+    double t = qBound(tmin, d->Time, tmax);
+    value = qRound(TIME_SLIDER_RESOLUTION * (t - tmin) / (tmax - tmin));
     }
 
-  double tmax = cameraPathNode->GetMaximumT();
-  double tmin = cameraPathNode->GetMinimumT();
-  int framerate = d->fpsSpinBox->value();
-  int numberOfFrames = framerate * int(tmax - tmin);
-  d->timeSlider->setMaximum(numberOfFrames);
+  // The slider only shows the time, do not seek back to its rounded value
+  bool wasBlocked = d->timeSlider->blockSignals(true);
+  d->timeSlider->setValue(value);
+  d->timeSlider->blockSignals(wasBlocked);
 }
 
 //-----------------------------------------------------------------------------
@@ -225,6 +438,14 @@ void qSlicerCameraPathModuleWidget::onCameraPathNodeChanged(vtkMRMLNode* node)
   // Listen to camerapathnode
   this->qvtkConnect(cameraPathNode, vtkCommand::ModifiedEvent,
                     this, SLOT(onCameraPathNodeModified(vtkObject*)));
+  this->qvtkConnect(cameraPathNode, vtkMRMLCameraPathNode::KeyFrameAddedEvent,
+                    this, SLOT(onKeyFramesEdited(vtkObject*,void*,unsigned long)));
+  this->qvtkConnect(cameraPathNode, vtkMRMLCameraPathNode::KeyFrameRemovedEvent,
+                    this, SLOT(onKeyFramesEdited(vtkObject*,void*,unsigned long)));
+  this->qvtkConnect(cameraPathNode, vtkMRMLCameraPathNode::KeyFrameModifiedEvent,
+                    this, SLOT(onKeyFramesEdited(vtkObject*,void*,unsigned long)));
+  this->qvtkConnect(cameraPathNode, vtkMRMLCameraPathNode::KeyFramesResetEvent,
+                    this, SLOT(onKeyFramesEdited(vtkObject*,void*,unsigned long)));
 
   // call modified
   this->onCameraPathNodeModified(cameraPathNode);
@@ -242,8 +463,8 @@ void qSlicerCameraPathModuleWidget::onCameraPathNodeModified(vtkObject* caller)
     return;
     }
 
-  // Update Slider Range
-  this->updateSliderRange();
+  // Update Slider
+  this->updateTimeSlider();
 
   // Update visibility button
   d->cameraPathVisibilityPushButton->blockSignals(true);
@@ -264,6 +485,54 @@ void qSlicerCameraPathModuleWidget::onCameraPathNodeModified(vtkObject* caller)
   this->populateKeyFramesTableWidget();
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::onKeyFramesEdited(vtkObject* caller,
+                                                      void* callData,
+                                                      unsigned long event)
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  vtkMRMLCameraPathNode* cameraPathNode = vtkMRMLCameraPathNode::SafeDownCast(caller);
+
+  if (!cameraPathNode ||
+      cameraPathNode != d->cameraPathComboBox->currentNode() ||
+      !d->PoseBuffer->isRunning())
+    {
+    return;
+    }
+
+  if (event == vtkMRMLCameraPathNode::KeyFramesResetEvent || !callData)
+    {
+    d->PoseBuffer->setPath(cameraPathNode, d->fpsSpinBox->value(),
+                           d->PlaybackFrame + 1);
+    return;
+    }
+
+  // Earliest keyframe time of the edit
+  double* times = reinterpret_cast<double*>(callData);
+  double t = times[0];
+  if (event == vtkMRMLCameraPathNode::KeyFrameModifiedEvent)
+    {
+    t = qMin(times[0], times[1]);
+    }
+
+  // The spline tangents depend on the neighboring keyframes, the path
+  // changes from two keyframes before the edit
+  vtkIdType index = 0;
+  while (index < cameraPathNode->GetNumberOfKeyFrames() &&
+         cameraPathNode->GetKeyFrameTime(index) < t)
+    {
+    ++index;
+    }
+  index = qMax(index - 2, vtkIdType(0));
+  if (index < cameraPathNode->GetNumberOfKeyFrames())
+    {
+    t = qMin(t, cameraPathNode->GetKeyFrameTime(index));
+    }
+
+  d->PoseBuffer->invalidate(cameraPathNode, t);
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerCameraPathModuleWidget::onCameraPathNodeRenamed(QString nodeName)
 {
@@ -318,18 +587,7 @@ void qSlicerCameraPathModuleWidget::onCameraPathNodeAddedByUser(vtkMRMLNode* nod
     return;
     }
 
-  // Add PointSplines to Scene
-  if (cameraPathNode->GetScene()
-      && !cameraPathNode->GetPositionSplines()->GetScene()
-      && !cameraPathNode->GetFocalPointSplines()->GetScene()
-      && !cameraPathNode->GetViewUpSplines()->GetScene()
-      )
-    {
-    cameraPathNode->GetScene()->AddNode(cameraPathNode->GetPositionSplines());
-    cameraPathNode->GetScene()->AddNode(cameraPathNode->GetFocalPointSplines());
-    cameraPathNode->GetScene()->AddNode(cameraPathNode->GetViewUpSplines());
-    }
-
+  // PointSplines are added to the scene by the logic
   // Update PointSplines Name
   this->onCameraPathNodeRenamed(QString(cameraPathNode->GetName()));
 }
@@ -383,7 +641,7 @@ void qSlicerCameraPathModuleWidget::onCameraPathVisibilityToggled(bool visibilit
 }
 
 //-----------------------------------------------------------------------------
-void qSlicerCameraPathModuleWidget::onTimeSliderChanged(int frameNbr)
+void qSlicerCameraPathModuleWidget::onTimeSliderChanged(int value)
 {
   Q_D(qSlicerCameraPathModuleWidget);
 
@@ -395,27 +653,144 @@ void qSlicerCameraPathModuleWidget::onTimeSliderChanged(int frameNbr)
     return;
     }
 
-  // Get Time
-  int framerate = d->fpsSpinBox->value();
+  // Only keep the last value, it is evaluated when the events queued
+  // during the previous render have been processed
   double tmin = cameraPathNode->GetMinimumT();
-  double t = (frameNbr/(double)framerate) + tmin;
+  double tmax = cameraPathNode->GetMaximumT();
+  d->ScrubTime = tmin + (tmax - tmin) * value / TIME_SLIDER_RESOLUTION;
+  if (!d->ScrubTimer->isActive())
+    {
+    d->ScrubTimer->start();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::scrubToSliderTime()
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  this->setTime(d->ScrubTime);
+
+  // Render now instead of when the view render request fires, so that the
+  // slider values received meanwhile are coalesced into the next one
+  qMRMLThreeDView* view = this->getMRMLThreeDView(this->playbackViewNode());
+  if (view)
+    {
+    view->forceRender();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::setTime(double t)
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  vtkMRMLCameraPathNode* cameraPathNode =
+          vtkMRMLCameraPathNode::SafeDownCast(d->cameraPathComboBox->currentNode());
+
+  if (!cameraPathNode)
+    {
+    return;
+    }
+  t = cameraPathNode->ClampTime(t);
+
+  // Seeking while playing restarts the playback clock from the new time
+  if (d->Timer->isActive())
+    {
+    d->PlaybackStartTime = t;
+    d->PlaybackClock.restart();
+    d->PlaybackFrame = vtkSlicerCameraPathLogic::GetFrameAt(
+          cameraPathNode->GetMinimumT(), t, d->fpsSpinBox->value());
+    d->PoseBuffer->seek(d->PlaybackFrame + 1);
+
+    // Render the time sought at full quality
+    if (d->PlaybackFrameTime > 0.0)
+      {
+      d->PlaybackRenderWindow->SetDesiredUpdateRate(d->StillUpdateRate);
+      d->FullQualityRender = true;
+      }
+    }
 
   // Travel to time
   this->travelToTime(t);
 }
 
+//-----------------------------------------------------------------------------
+double qSlicerCameraPathModuleWidget::time()const
+{
+  Q_D(const qSlicerCameraPathModuleWidget);
+  return d->Time;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::playFrame(int frame)
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  vtkMRMLCameraPathNode* cameraPathNode =
+          vtkMRMLCameraPathNode::SafeDownCast(d->cameraPathComboBox->currentNode());
+
+  if (!cameraPathNode)
+    {
+    return;
+    }
+
+  double t = vtkSlicerCameraPathLogic::GetFrameTime(
+        cameraPathNode->GetMinimumT(), frame, d->fpsSpinBox->value());
+  d->PlaybackFrame = frame;
+
+  // Take the pose computed ahead
+  double start = vtkSlicerCameraPathStatistics::GetTime();
+  CameraPose pose;
+  if (!d->PoseBuffer->takePose(frame, pose))
+    {
+    cameraPathNode->GetPoseAt(t, pose);
+    d->PoseBuffer->seek(frame + 1);
+    }
+  d->logic()->GetStatistics()->AddStageTime(
+        vtkSlicerCameraPathStatistics::Evaluation,
+        vtkSlicerCameraPathStatistics::GetTime() - start);
+  this->travelToTime(t, &pose);
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerCameraPathModuleWidget::onFirstFrameClicked()
 {
   Q_D(qSlicerCameraPathModuleWidget);
-  d->timeSlider->setValue(d->timeSlider->minimum());
+
+  vtkMRMLCameraPathNode* cameraPathNode =
+          vtkMRMLCameraPathNode::SafeDownCast(d->cameraPathComboBox->currentNode());
+
+  if (!cameraPathNode)
+    {
+    return;
+    }
+  this->setTime(cameraPathNode->GetMinimumT());
 }
 
 //-----------------------------------------------------------------------------
 void qSlicerCameraPathModuleWidget::onPreviousFrameClicked()
 {
   Q_D(qSlicerCameraPathModuleWidget);
-  d->timeSlider->setValue(d->timeSlider->value()-1);
+
+  vtkMRMLCameraPathNode* cameraPathNode =
+          vtkMRMLCameraPathNode::SafeDownCast(d->cameraPathComboBox->currentNode());
+
+  if (!cameraPathNode)
+    {
+    return;
+    }
+
+  // Frame before the current time, which may be between two frames
+  double tmin = cameraPathNode->GetMinimumT();
+  int framerate = d->fpsSpinBox->value();
+  int frame = vtkSlicerCameraPathLogic::GetFrameAt(tmin, d->Time, framerate);
+  if (vtkSlicerCameraPathLogic::GetFrameTime(tmin, frame, framerate) >=
+      d->Time - 1e-6 / framerate)
+    {
+    --frame;
+    }
+  this->setTime(vtkSlicerCameraPathLogic::GetFrameTime(tmin, qMax(frame, 0), framerate));
 }
 
 //-----------------------------------------------------------------------------
@@ -425,15 +800,63 @@ void qSlicerCameraPathModuleWidget::onPlayPauseToogled(bool play)
 
   if (play)
     {
-    if(d->timeSlider->value() == d->timeSlider->maximum())
+    vtkMRMLCameraPathNode* cameraPathNode =
+            vtkMRMLCameraPathNode::SafeDownCast(d->cameraPathComboBox->currentNode());
+    if (!cameraPathNode)
+      {
+      d->playPushButton->setChecked(false);
+      return;
+      }
+
+    // Start from the first frame when at the last one
+    double tmin = cameraPathNode->GetMinimumT();
+    int framerate = d->fpsSpinBox->value();
+    int lastFrame = vtkSlicerCameraPathLogic::GetNumberOfFrames(
+          tmin, cameraPathNode->GetMaximumT(), framerate) - 1;
+    if (vtkSlicerCameraPathLogic::GetFrameAt(tmin, d->Time, framerate) >= lastFrame)
       {
-      d->timeSlider->setValue(0);
+      this->setTime(tmin);
       }
+    d->PlaybackStartTime = d->Time;
+    d->PlaybackFrame = vtkSlicerCameraPathLogic::GetFrameAt(tmin, d->Time, framerate);
+
+    // Record the frame timings, and the render times of the playback view
+    d->logic()->GetStatistics()->Reset();
+    vtkMRMLViewNode* viewNode = this->playbackViewNode();
+    d->PlaybackRenderWindow = viewNode ? this->getMRMLViewRenderWindow(viewNode) : 0;
+    if (d->PlaybackRenderWindow)
+      {
+      this->qvtkConnect(d->PlaybackRenderWindow, vtkCommand::StartEvent,
+                        this, SLOT(onRenderStarted()));
+      this->qvtkConnect(d->PlaybackRenderWindow, vtkCommand::EndEvent,
+                        this, SLOT(onRenderEnded()));
+      if (d->adaptiveQualityCheckBox->isChecked())
+        {
+        this->startAdaptiveQuality();
+        }
+      }
+
+    d->PlaybackClock.start();
+    d->PoseBuffer->setPath(cameraPathNode, framerate, d->PlaybackFrame + 1);
+    d->PoseBuffer->start();
     d->Timer->start();
     }
   else
     {
     d->Timer->stop();
+    d->PoseBuffer->stop();
+
+    if (d->PlaybackRenderWindow)
+      {
+      this->qvtkDisconnect(d->PlaybackRenderWindow, vtkCommand::StartEvent,
+                           this, SLOT(onRenderStarted()));
+      this->qvtkDisconnect(d->PlaybackRenderWindow, vtkCommand::EndEvent,
+                           this, SLOT(onRenderEnded()));
+      this->stopAdaptiveQuality();
+      d->PlaybackRenderWindow = 0;
+      }
+    d->logic()->GetStatistics()->EndFrame();
+    this->updateStatisticsLabel();
     }
   d->playPushButton->setChecked(play);
 }
@@ -442,14 +865,34 @@ void qSlicerCameraPathModuleWidget::onPlayPauseToogled(bool play)
 void qSlicerCameraPathModuleWidget::onNextFrameClicked()
 {
   Q_D(qSlicerCameraPathModuleWidget);
-  d->timeSlider->setValue(d->timeSlider->value()+1);
+
+  vtkMRMLCameraPathNode* cameraPathNode =
+          vtkMRMLCameraPathNode::SafeDownCast(d->cameraPathComboBox->currentNode());
+
+  if (!cameraPathNode)
+    {
+    return;
+    }
+
+  double tmin = cameraPathNode->GetMinimumT();
+  int framerate = d->fpsSpinBox->value();
+  int frame = vtkSlicerCameraPathLogic::GetFrameAt(tmin, d->Time, framerate) + 1;
+  this->setTime(vtkSlicerCameraPathLogic::GetFrameTime(tmin, frame, framerate));
 }
 
 //-----------------------------------------------------------------------------
 void qSlicerCameraPathModuleWidget::onLastFrameClicked()
 {
   Q_D(qSlicerCameraPathModuleWidget);
-  d->timeSlider->setValue(d->timeSlider->maximum());
+
+  vtkMRMLCameraPathNode* cameraPathNode =
+          vtkMRMLCameraPathNode::SafeDownCast(d->cameraPathComboBox->currentNode());
+
+  if (!cameraPathNode)
+    {
+    return;
+    }
+  this->setTime(cameraPathNode->GetMaximumT());
 }
 
 //-----------------------------------------------------------------------------
@@ -461,25 +904,64 @@ void qSlicerCameraPathModuleWidget::onFPSChanged(int framerate)
   vtkMRMLCameraPathNode* cameraPathNode =
           vtkMRMLCameraPathNode::SafeDownCast(d->cameraPathComboBox->currentNode());
 
-  if (!cameraPathNode)
+  // Frames are numbered from the new framerate, restart the playback clock
+  if (d->Timer->isActive() && cameraPathNode)
     {
-    return;
-    }
-
-  double tmax = cameraPathNode->GetMaximumT();
-  double tmin = cameraPathNode->GetMinimumT();
-  int numberOfFrames = framerate * int(tmax - tmin);
+    d->PlaybackStartTime = d->Time;
+    d->PlaybackClock.restart();
+    d->PlaybackFrame = vtkSlicerCameraPathLogic::GetFrameAt(
+          cameraPathNode->GetMinimumT(), d->Time, framerate);
+    d->PoseBuffer->setPath(cameraPathNode, framerate, d->PlaybackFrame + 1);
 
-  d->timeSlider->setMaximum(numberOfFrames);
+    // The frame time follows the framerate unless set for the view
+    if (d->PlaybackFrameTime > 0.0 &&
+        vtkSlicerCameraPathLogic::GetPlaybackFrameTime(this->playbackViewNode()) <= 0.0)
+      {
+      d->PlaybackFrameTime = 1.0 / framerate;
+      }
+    }
 }
 
 //-----------------------------------------------------------------------------
 void qSlicerCameraPathModuleWidget::playToNextFrame()
 {
   Q_D(qSlicerCameraPathModuleWidget);
-  d->timeSlider->setValue(d->timeSlider->value()+1);
 
-  if(d->timeSlider->value() == d->timeSlider->maximum())
+  vtkMRMLCameraPathNode* cameraPathNode =
+          vtkMRMLCameraPathNode::SafeDownCast(d->cameraPathComboBox->currentNode());
+
+  if (!cameraPathNode)
+    {
+    d->playPushButton->setChecked(false);
+    return;
+    }
+
+  // Frame due at the current wall time, skipping the frames that could not
+  // be rendered in time
+  double tmin = cameraPathNode->GetMinimumT();
+  int framerate = d->fpsSpinBox->value();
+  int lastFrame = vtkSlicerCameraPathLogic::GetNumberOfFrames(
+        tmin, cameraPathNode->GetMaximumT(), framerate) - 1;
+  double t = d->PlaybackStartTime + d->PlaybackClock.elapsed() / 1000.0;
+  int frameNbr = qMin(vtkSlicerCameraPathLogic::GetFrameAt(tmin, t, framerate),
+                      lastFrame);
+
+  if (frameNbr > d->PlaybackFrame)
+    {
+    // The previous frame includes its render, which happens between ticks
+    vtkSlicerCameraPathStatistics* statistics = d->logic()->GetStatistics();
+    statistics->EndFrame();
+    statistics->StartFrame(frameNbr, frameNbr - d->PlaybackFrame - 1);
+
+    this->playFrame(frameNbr);
+
+    if (statistics->GetNumberOfFrames() % framerate == 0)
+      {
+      this->updateStatisticsLabel();
+      }
+    }
+
+  if (d->PlaybackFrame >= lastFrame)
     {
     d->Timer->stop();
     d->playPushButton->setChecked(false);
@@ -619,18 +1101,8 @@ void qSlicerCameraPathModuleWidget::onGoToKeyFrameClicked()
   int row = selectedItems.at(0)->row();
   double t = d->keyFramesTableWidget->item(row, 0)->text().toDouble();
 
-  // Get frame number
-  int framerate = d->fpsSpinBox->value();
-  double tmin = cameraPathNode->GetMinimumT();
-  int frameNbr = framerate * int(t - tmin);
-
-  // Set slider to value
-  if(d->timeSlider->value() == frameNbr)
-  {
-    // If slider already set
-    this->travelToTime(t);
-  }
-  d->timeSlider->setValue(frameNbr);
+  // Go to the keyframe time
+  this->setTime(t);
 }
 
 //-----------------------------------------------------------------------------
@@ -869,6 +1341,10 @@ void qSlicerCameraPathModuleWidget::onViewNodeChanged(vtkMRMLNode* node)
     }
 
   vtkRenderWindow* renderWindow = this->getMRMLViewRenderWindow(viewNode);
+  if (!renderWindow)
+    {
+    return;
+    }
 
   // Listen to renderWindow
   // XXX TODO : remove connection when viewnode changed
@@ -912,6 +1388,7 @@ void qSlicerCameraPathModuleWidget::onCurrentSizeClicked(bool checked)
     // Disable size boxes
     d->exportWidthSpinBox->setEnabled(false);
     d->exportHeightSpinBox->setEnabled(false);
+    d->exportTiledCheckBox->setEnabled(false);
     }
 }
 
@@ -924,9 +1401,53 @@ void qSlicerCameraPathModuleWidget::onCustomSizeClicked(bool checked)
     {
     d->exportWidthSpinBox->setEnabled(true);
     d->exportHeightSpinBox->setEnabled(true);
+    d->exportTiledCheckBox->setEnabled(true);
     }
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::onExportTypeChanged(int exportType)
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+  d->exportCommandLineEdit->setEnabled(exportType == ENCODERCOMMAND);
+  d->exportCodecComboBox->setEnabled(exportType == VIDEOCLIP);
+  d->exportCRFSpinBox->setEnabled(exportType == VIDEOCLIP &&
+                                  d->exportBitRateSpinBox->value() == 0);
+  d->exportBitRateSpinBox->setEnabled(exportType == VIDEOCLIP);
+  d->exportGOPSpinBox->setEnabled(exportType == VIDEOCLIP);
+  d->exportThreadsSpinBox->setEnabled(exportType == VIDEOCLIP);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::onExportQualityChanged(int exportQuality)
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  // Usual constant rate factor of the codec, editable afterwards
+  d->exportCRFSpinBox->setValue(
+    vtkSlicerCameraPathVideoEncoder::GetDefaultConstantRateFactor(
+      d->exportCodecComboBox->currentIndex(), exportQuality));
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::onExportCodecChanged(int codec)
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  // Constant rate factor scales differ between codecs
+  d->exportCRFSpinBox->setValue(
+    vtkSlicerCameraPathVideoEncoder::GetDefaultConstantRateFactor(
+      codec, d->exportQualityComboBox->currentIndex()));
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::onExportBitRateChanged(int bitRate)
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+  d->exportCRFSpinBox->setEnabled(bitRate == 0 &&
+                                  d->exportBitRateSpinBox->isEnabled());
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerCameraPathModuleWidget::onRecordClicked()
 {
@@ -944,15 +1465,40 @@ void qSlicerCameraPathModuleWidget::onRecordClicked()
     }
 
   // Get Render Window
-  vtkRenderWindow* renderWindow = this->getMRMLViewRenderWindow(viewNode);
-  if (!renderWindow)
+  vtkRenderWindow* viewRenderWindow = this->getMRMLViewRenderWindow(viewNode);
+  if (!viewRenderWindow)
     {
     return;
     }
 
-  // Get Export type and Export quality
+  // Get Export type
   const int exportType = d->exportTypeComboBox->currentIndex();
-  const int exportQuality = d->exportQualityComboBox->currentIndex();
+
+  // Frames of the range rendered by this shard
+  double tmin = cameraPathNode->GetMinimumT();
+  int framerate = d->fpsSpinBox->value();
+  int numberOfFrames = vtkSlicerCameraPathLogic::GetNumberOfFrames(
+        tmin, cameraPathNode->GetMaximumT(), framerate);
+  int lastFrame = d->exportLastFrameSpinBox->value();
+  if (lastFrame < 0 || lastFrame >= numberOfFrames)
+    {
+    lastFrame = numberOfFrames - 1;
+    }
+  const int shardCount = d->exportShardCountSpinBox->value();
+  if (exportType != SCREENSHOTS && shardCount > 1)
+    {
+    qWarning() << "Shards can only be exported as screenshots";
+    return;
+    }
+  int firstFrame = 0;
+  if (!vtkSlicerCameraPathLogic::GetShardFrameRange(
+        d->exportFirstFrameSpinBox->value(), lastFrame,
+        d->exportShardIndexSpinBox->value() - 1, shardCount,
+        firstFrame, lastFrame))
+    {
+    qWarning() << "No frame to export";
+    return;
+    }
 
   // Get File name
   QString fileName;
@@ -961,16 +1507,29 @@ void qSlicerCameraPathModuleWidget::onRecordClicked()
   QString suffix;
   if (exportType == VIDEOCLIP)
     {
-    fileName = ctkFileDialog::getSaveFileName(this, tr("Save Video Clip"),".",tr("Videos (*.mkv *.avi)"));
+    fileName = ctkFileDialog::getSaveFileName(this, tr("Save Video Clip"),".",tr("Videos (*.mkv *.mp4 *.webm *.avi)"));
     QFileInfo fileInfo(fileName);
     path = fileInfo.path();
+    baseName = fileInfo.completeBaseName();
     suffix = fileInfo.suffix();
-    if(!fileName.isEmpty() && suffix != "mkv" && suffix != "avi")
+    if(!fileName.isEmpty() && suffix != "mkv" && suffix != "mp4" &&
+       suffix != "webm" && suffix != "avi")
       {
       qWarning() << "Extension incorrect, using .mkv instead";
       fileName += ".mkv";
+      baseName = fileInfo.fileName();
+      suffix = "mkv";
       }
     }
+  else if (exportType == ENCODERCOMMAND)
+    {
+    // The encoder chooses the container from the extension
+    fileName = ctkFileDialog::getSaveFileName(this, tr("Save Video"),".",tr("Videos (*.mp4 *.mkv *.mov *.webm)"));
+    QFileInfo fileInfo(fileName);
+    path = fileInfo.path();
+    baseName = fileInfo.completeBaseName();
+    suffix = fileInfo.suffix();
+    }
   else if (exportType == SCREENSHOTS)
     {
     fileName = ctkFileDialog::getSaveFileName(this, tr("Save Screenshot Files"),".",tr("Images (*.png)"));
@@ -990,48 +1549,179 @@ void qSlicerCameraPathModuleWidget::onRecordClicked()
     return;
     }
 
-  // Enable OffScreen Rendering
-  renderWindow->OffScreenRenderingOn();
-
-  // Set renderWindow size
-  int* windowSize = renderWindow->GetSize();
-  int W = windowSize[0];
-  int H = windowSize[1];
+  // Frames are rendered in an offscreen copy of the view, sharing its
+  // props and cameras, so that the view keeps its size and stays on screen.
+  // The view does not render during the export, the graphics resources of
+  // the props being uploaded to the offscreen context for each export.
+  // Tiled frames are rendered at the view size and stitched.
+  int* viewSize = viewRenderWindow->GetSize();
+  int frameSize[2] = {viewSize[0], viewSize[1]};
   if(d->exportCustomSizeRadioButton->isChecked())
     {
-    renderWindow->SetSize(d->exportWidthSpinBox->value(),d->exportHeightSpinBox->value());
+    frameSize[0] = d->exportWidthSpinBox->value();
+    frameSize[1] = d->exportHeightSpinBox->value();
+    }
+  const bool tiled = d->exportCustomSizeRadioButton->isChecked() &&
+    d->exportTiledCheckBox->isChecked();
+  if (!d->ExportView->Update(viewRenderWindow,
+                             tiled ? viewSize[0] : frameSize[0],
+                             tiled ? viewSize[1] : frameSize[1]))
+    {
+    return;
+    }
+  vtkRenderWindow* renderWindow = d->ExportView->GetRenderWindow();
+  vtkNew<vtkSlicerCameraPathTileRenderer> tileRenderer;
+  vtkNew<vtkImageData> frameImage;
+  if(tiled)
+    {
+    tileRenderer->SetSize(frameSize);
     }
 
-  // Get Image
-  vtkNew<vtkWindowToImageFilter> w2i;
-  w2i->SetInput(renderWindow);
+  // Side-by-side stereo: the left and right rig cameras are rendered in
+  // turn with the camera of the view, from a single path evaluation
+  vtkMRMLCameraNode* viewCameraNode = this->getViewCameraNode(viewNode);
+  const bool stereo = d->exportStereoCheckBox->isChecked() &&
+    cameraPathNode->GetNumberOfRigCameras() >= 2 && viewCameraNode;
+  if (d->exportStereoCheckBox->isChecked() && !stereo)
+    {
+    qWarning() << "Stereo export needs a camera path with two rig cameras, "
+                  "exporting a single view";
+    }
+  vtkNew<vtkImageData> eyeImages[2];
+  vtkNew<vtkImageAppend> stereoAppend;
+  stereoAppend->SetAppendAxis(0);
+  for (int eye = 0; eye < 2; ++eye)
+    {
+#if (VTK_MAJOR_VERSION <= 5)
+    stereoAppend->AddInput(eyeImages[eye].GetPointer());
+#else
+    stereoAppend->AddInputData(eyeImages[eye].GetPointer());
+#endif
+    }
+
+  // Smaller outputs are downscaled from the rendered frames
+  const int exportSize[2] = {stereo ? 2 * frameSize[0] : frameSize[0],
+                             frameSize[1]};
+  std::vector<ExportOutput> outputs;
+  if (!vtkSlicerCameraPathLogic::ParseExportOutputs(
+        d->exportOutputsLineEdit->text().toStdString(), outputs))
+    {
+    qWarning() << "Invalid outputs, expected sizes written <width>x<height>[.<extension>]";
+    d->ExportView->RemoveViewProps();
+    return;
+    }
+  for (size_t o = 0; o < outputs.size(); ++o)
+    {
+    if (outputs[o].Width > exportSize[0] || outputs[o].Height > exportSize[1])
+      {
+      qWarning() << "Output" << outputs[o].Width << "x" << outputs[o].Height
+                 << "is larger than the exported frames";
+      d->ExportView->RemoveViewProps();
+      return;
+      }
+    if (!vtkSlicerCameraPathLogic::HasFrameAspectRatio(
+          outputs[o], exportSize[0], exportSize[1]))
+      {
+      qWarning() << "Output" << outputs[o].Width << "x" << outputs[o].Height
+                 << "does not have the aspect ratio of the exported frames"
+                 << exportSize[0] << "x" << exportSize[1];
+      d->ExportView->RemoveViewProps();
+      return;
+      }
+    }
 
   // Create Writers
-  vtkNew<vtkPNGWriter> imageWriter;
-  if(exportType == SCREENSHOTS)
+  // Screenshots are compressed and written by a pool of threads while the
+  // next frames render. Video frames must be encoded in order, they are
+  // encoded by the thread of the encoder backend.
+  const std::string hash =
+    vtkSlicerCameraPathLogic::GetExportHash(cameraPathNode, viewNode);
+  vtkNew<vtkSlicerCameraPathExporter> exporter;
+  if(exportType == SCREENSHOTS &&
+     !d->startExporter(exporter.GetPointer(), path.toStdString(),
+                       baseName.toStdString(), firstFrame, lastFrame, hash,
+                       exportSize[0], exportSize[1], framerate))
+    {
+    qWarning() << "Unable to start writing screenshots";
+    d->ExportView->RemoveViewProps();
+    return;
+    }
+
+  vtkSmartPointer<vtkSlicerCameraPathVideoEncoder> encoder;
+  if(exportType == VIDEOCLIP || exportType == ENCODERCOMMAND)
     {
-    imageWriter->SetInputConnection(w2i->GetOutputPort());
-    switch(exportQuality){
-    case LOW:
-      imageWriter->SetCompressionLevel(9);
-      break;
-    case MEDIUM:
-      imageWriter->SetCompressionLevel(5);
-      break;
-    case HIGH:
-      imageWriter->SetCompressionLevel(1);
-      break;
+    encoder = d->startEncoder(exportType, fileName, exportSize[0],
+                              exportSize[1], framerate);
+    if (!encoder)
+      {
+      qWarning() << "Unable to start the video encoder";
+      d->ExportView->RemoveViewProps();
+      return;
       }
     }
 
-  vtkNew<vtkFFMPEGWriter> FFMPEGWriter;
-  if(exportType == VIDEOCLIP)
+  // Outputs are named after the export and their size, png outputs are
+  // written as screenshots and the others encoded as videos. Screenshots
+  // of the export are only skipped if no output is a video.
+  std::vector<OutputWriter> outputWriters(outputs.size());
+  bool resumable = true;
+  for (size_t o = 0; o < outputs.size(); ++o)
     {
-    FFMPEGWriter->SetInputConnection(w2i->GetOutputPort());
-    FFMPEGWriter->SetQuality(exportQuality);
-    FFMPEGWriter->SetFileName(fileName.toStdString().c_str());
-    FFMPEGWriter->SetRate(d->fpsSpinBox->value());
-    FFMPEGWriter->Start();
+    OutputWriter& writer = outputWriters[o];
+    writer.Output = outputs[o];
+    if (writer.Output.Extension.empty())
+      {
+      writer.Output.Extension = suffix.isEmpty() ? "mkv" : suffix.toStdString();
+      }
+    writer.BaseName = vtkSlicerCameraPathLogic::GetExportOutputBaseName(
+      baseName.toStdString(), writer.Output);
+    writer.Downscaler = vtkSmartPointer<vtkSlicerCameraPathDownscaler>::New();
+    writer.Image = vtkSmartPointer<vtkImageData>::New();
+    bool started = true;
+    if (writer.Output.Extension == "png" || writer.Output.Extension == "PNG")
+      {
+      writer.Exporter = vtkSmartPointer<vtkSlicerCameraPathExporter>::New();
+      started = d->startExporter(writer.Exporter, path.toStdString(),
+                                 writer.BaseName, firstFrame, lastFrame, hash,
+                                 writer.Output.Width, writer.Output.Height,
+                                 framerate);
+      }
+    else
+      {
+      QString outputFileName = path + "/" +
+        QString::fromStdString(writer.BaseName + "." + writer.Output.Extension);
+      writer.Encoder = d->startEncoder(exportType == ENCODERCOMMAND ?
+                                       ENCODERCOMMAND : VIDEOCLIP,
+                                       outputFileName, writer.Output.Width,
+                                       writer.Output.Height, framerate);
+      started = writer.Encoder.GetPointer() != 0;
+      resumable = false;
+      }
+    if (!started)
+      {
+      qWarning() << "Unable to start the output" << writer.BaseName.c_str();
+      d->ExportView->RemoveViewProps();
+      return;
+      }
+    }
+  // Frames are read into memory to be downscaled
+  const bool frameInMemory = tiled || !outputWriters.empty();
+
+  // The props of the view are rendered in the offscreen context, the view
+  // must not render them meanwhile, e.g. when the progress dialog repaints
+  // it or when its camera follows the path
+  qMRMLThreeDView* threeDView = this->getMRMLThreeDView(viewNode);
+  const bool viewRenderEnabled = threeDView && threeDView->renderEnabled();
+  if (threeDView)
+    {
+    threeDView->setRenderEnabled(false);
+    }
+  vtkRenderWindowInteractor* viewInteractor = viewRenderWindow->GetInteractor();
+  const int viewInteractorRenderEnabled =
+    viewInteractor ? viewInteractor->GetEnableRender() : 0;
+  if (viewInteractor)
+    {
+    viewInteractor->EnableRenderOff();
     }
 
   // Create progress dialog
@@ -1039,46 +1729,228 @@ void qSlicerCameraPathModuleWidget::onRecordClicked()
   d->keyFramesSection->setEnabled(false);
   d->exportSection->setEnabled(false);
   QProgressDialog progressDialog("Export to "+path, "Cancel",
-                           d->timeSlider->minimum(), d->timeSlider->maximum(),
+                           firstFrame, lastFrame,
                            this);
   progressDialog.show();
   progressDialog.setWindowModality(Qt::WindowModal);
 
+  // Record the frame timings
+  vtkSlicerCameraPathStatistics* statistics = d->logic()->GetStatistics();
+  statistics->Reset();
+  double start;
+
   // Write frame by frame
-  for(int i = d->timeSlider->minimum();
-      i <= d->timeSlider->maximum();
-      ++i)
+  for(int i = firstFrame; i <= lastFrame; ++i)
   {
-    // Render at next frame value
-    d->timeSlider->setValue(i);
-    renderWindow->Render();
+    std::string screenshotFileName;
+    if(exportType == SCREENSHOTS)
+      {
+      screenshotFileName =
+        vtkSlicerCameraPathLogic::GetFrameFileName(path.toStdString(),
+                                                   baseName.toStdString(), i,
+                                                   suffix.toStdString());
+      bool written = resumable &&
+        exporter->IsFrameWritten(screenshotFileName.c_str());
+      for (size_t o = 0; o < outputWriters.size() && written; ++o)
+        {
+        written = outputWriters[o].Exporter->IsFrameWritten(
+          vtkSlicerCameraPathLogic::GetFrameFileName(
+            path.toStdString(), outputWriters[o].BaseName, i,
+            outputWriters[o].Output.Extension).c_str());
+        }
+      if (written)
+        {
+        progressDialog.setValue(i);
+        continue;
+        }
+      }
 
-    // Update filter
-    w2i->Modified();
-    w2i->Update();
+    statistics->StartFrame(i);
+    bool rendered = true;
+    bool readBack = true;
+    bool queued = true;
+    bool encoded = true;
+
+    // Render at next frame value, the pose being evaluated once for the
+    // views and the stereo eyes
+    double t = cameraPathNode->ClampTime(
+      vtkSlicerCameraPathLogic::GetFrameTime(tmin, i, framerate));
+    start = vtkSlicerCameraPathStatistics::GetTime();
+    CameraPose pose;
+    cameraPathNode->GetPoseAt(t, pose);
+    statistics->AddStageTime(vtkSlicerCameraPathStatistics::Evaluation,
+                             vtkSlicerCameraPathStatistics::GetTime() - start);
+    this->travelToTime(t, &pose);
+
+    if (stereo)
+      {
+      for (int eye = 0; eye < 2 && rendered && readBack; ++eye)
+        {
+        CameraPose eyePose;
+        cameraPathNode->GetRigPose(eye, pose, eyePose);
+        applyCameraPose(viewCameraNode, eyePose);
+
+        // The render time of tiles includes reading them back
+        start = vtkSlicerCameraPathStatistics::GetTime();
+        if(tiled)
+          {
+          rendered = tileRenderer->Render(renderWindow,
+                                          eyeImages[eye].GetPointer());
+          }
+        else
+          {
+          renderWindow->Render();
+          }
+        statistics->AddStageTime(vtkSlicerCameraPathStatistics::Render,
+                                 vtkSlicerCameraPathStatistics::GetTime() - start);
+
+        if(!tiled)
+          {
+          start = vtkSlicerCameraPathStatistics::GetTime();
+          readBack = vtkSlicerCameraPathExporter::ReadPixels(
+            renderWindow, eyeImages[eye].GetPointer());
+          statistics->AddStageTime(vtkSlicerCameraPathStatistics::Readback,
+                                   vtkSlicerCameraPathStatistics::GetTime() - start);
+          }
+        }
+      stereoAppend->Modified();
+      }
+    else
+      {
+      start = vtkSlicerCameraPathStatistics::GetTime();
+      if(tiled)
+        {
+        rendered = tileRenderer->Render(renderWindow, frameImage.GetPointer());
+        }
+      else
+        {
+        renderWindow->Render();
+        }
+      statistics->AddStageTime(vtkSlicerCameraPathStatistics::Render,
+                               vtkSlicerCameraPathStatistics::GetTime() - start);
+      }
+    if (!rendered)
+      {
+      qWarning() << "Could not render the tiles of frame" << i
+                 << ", export canceled";
+      statistics->EndFrame();
+      break;
+      }
 
-    // Write screenshot
-    if(exportType == SCREENSHOTS)
+    if (!stereo)
       {
-      std::stringstream ss;
-      ss << path.toStdString() << "/"
-         << baseName.toStdString() << "_"
-         << std::setfill('0') << std::setw(5)<<i
-         << "." << suffix.toStdString();
-      const std::string s = ss.str();
-      const char* screenshotFileName = s.c_str();
-      qDebug() <<"Writing at "<< screenshotFileName;
-      imageWriter->SetFileName(screenshotFileName);
-      imageWriter->Write();
+      // Frames are read straight into a buffer of the writers or of the
+      // encoder, frames in memory are copied into it, including the wait for
+      // a free buffer
+      start = vtkSlicerCameraPathStatistics::GetTime();
+      if(frameInMemory && !tiled)
+        {
+        readBack = vtkSlicerCameraPathExporter::ReadPixels(
+          renderWindow, frameImage.GetPointer());
+        }
+      if(exportType == SCREENSHOTS && frameInMemory && readBack)
+        {
+        queued = exporter->AddFrame(frameImage.GetPointer(),
+                                    screenshotFileName.c_str());
+        }
+      else if(exportType == SCREENSHOTS && readBack)
+        {
+        queued = exporter->AddFrame(renderWindow, screenshotFileName.c_str());
+        }
+      statistics->AddStageTime(vtkSlicerCameraPathStatistics::Readback,
+                               vtkSlicerCameraPathStatistics::GetTime() - start);
+
+      // Queue video frame, the wait for a free buffer of the encoder being
+      // its time, as for stereo frames
+      if(encoder && readBack)
+        {
+        start = vtkSlicerCameraPathStatistics::GetTime();
+        encoded = frameInMemory ? encoder->AddFrame(frameImage.GetPointer()) :
+                                  encoder->AddFrame(renderWindow);
+        statistics->AddStageTime(vtkSlicerCameraPathStatistics::Encode,
+                                 vtkSlicerCameraPathStatistics::GetTime() - start);
+        }
       }
 
-    // Write video frame
-    if(exportType == VIDEOCLIP)
+    if (!readBack)
       {
-      qDebug() <<"Writing frame "<< i << "/" << d->timeSlider->maximum();
-      FFMPEGWriter->Write();
+      qWarning() << "Could not read the pixels of frame" << i
+                 << ", export canceled";
+      statistics->EndFrame();
+      break;
       }
 
+    // Write stereo screenshot, waiting for a free buffer and copying the
+    // frame into it
+    if(exportType == SCREENSHOTS && stereo)
+      {
+      start = vtkSlicerCameraPathStatistics::GetTime();
+      stereoAppend->Update();
+      queued = exporter->AddFrame(stereoAppend->GetOutput(),
+                                  screenshotFileName.c_str());
+      statistics->AddStageTime(vtkSlicerCameraPathStatistics::Write,
+                               vtkSlicerCameraPathStatistics::GetTime() - start);
+      }
+
+    // Queue stereo video frame, waiting for a free buffer and copying the
+    // frame into it
+    if(encoder && stereo)
+      {
+      start = vtkSlicerCameraPathStatistics::GetTime();
+      stereoAppend->Update();
+      encoded = encoder->AddFrame(stereoAppend->GetOutput());
+      statistics->AddStageTime(vtkSlicerCameraPathStatistics::Encode,
+                               vtkSlicerCameraPathStatistics::GetTime() - start);
+      }
+
+    // Downscale the frame for each output and queue it to its writers
+    vtkImageData* frame = frameImage.GetPointer();
+    if (stereo && !outputWriters.empty())
+      {
+      stereoAppend->Update();
+      frame = stereoAppend->GetOutput();
+      }
+    for (size_t o = 0; o < outputWriters.size(); ++o)
+      {
+      OutputWriter& writer = outputWriters[o];
+      start = vtkSlicerCameraPathStatistics::GetTime();
+      writer.Downscaler->Downscale(frame, writer.Image, writer.Output.Width,
+                                   writer.Output.Height);
+      statistics->AddStageTime(vtkSlicerCameraPathStatistics::Resize,
+                               vtkSlicerCameraPathStatistics::GetTime() - start);
+
+      start = vtkSlicerCameraPathStatistics::GetTime();
+      if (writer.Encoder)
+        {
+        encoded = writer.Encoder->AddFrame(writer.Image) && encoded;
+        statistics->AddStageTime(vtkSlicerCameraPathStatistics::Encode,
+                                 vtkSlicerCameraPathStatistics::GetTime() - start);
+        }
+      else
+        {
+        queued = writer.Exporter->AddFrame(writer.Image,
+          vtkSlicerCameraPathLogic::GetFrameFileName(
+            path.toStdString(), writer.BaseName, i,
+            writer.Output.Extension).c_str()) && queued;
+        statistics->AddStageTime(vtkSlicerCameraPathStatistics::Write,
+                                 vtkSlicerCameraPathStatistics::GetTime() - start);
+        }
+      }
+    if (!queued)
+      {
+      qWarning() << "Could not write the screenshots of frame" << i
+                 << ", export canceled";
+      statistics->EndFrame();
+      break;
+      }
+    if (!encoded)
+      {
+      qWarning() << "The encoder stopped, export canceled";
+      statistics->EndFrame();
+      break;
+      }
+    statistics->EndFrame();
+
     // Update progress dialog
     progressDialog.setValue(i);
     if (progressDialog.wasCanceled())
@@ -1091,27 +1963,338 @@ void qSlicerCameraPathModuleWidget::onRecordClicked()
       }
   }
 
-  // End video
-  if(exportType == VIDEOCLIP)
+  // Wait for the queued video frames
+  if(encoder && !encoder->End())
+    {
+    qWarning() << "The video could not be encoded";
+    }
+
+  // Wait for the queued screenshots
+  if(exportType == SCREENSHOTS && !exporter->End())
     {
-    FFMPEGWriter->End();
+    qWarning() << exporter->GetNumberOfErrors() << "screenshots could not be written";
     }
 
-  // Reset renderwindow size
-  renderWindow->SetSize(W, H);
+  // Wait for the queued outputs
+  for (size_t o = 0; o < outputWriters.size(); ++o)
+    {
+    OutputWriter& writer = outputWriters[o];
+    if (writer.Encoder && !writer.Encoder->End())
+      {
+      qWarning() << "The output" << writer.BaseName.c_str() << "could not be encoded";
+      }
+    if (writer.Exporter && !writer.Exporter->End())
+      {
+      qWarning() << writer.Exporter->GetNumberOfErrors() << "screenshots of the output"
+                 << writer.BaseName.c_str() << "could not be written";
+      }
+    }
 
-  // Back to screen rendering
-  renderWindow->OffScreenRenderingOff();
+  // Move the view camera back from the last rig pose
+  if (stereo)
+    {
+    this->setTime(d->Time);
+    }
+
+  // Release the props of the view, the offscreen window is kept, and let
+  // the view render them again in its own context
+  d->ExportView->RemoveViewProps();
+  if (viewInteractor)
+    {
+    viewInteractor->SetEnableRender(viewInteractorRenderEnabled);
+    }
+  if (threeDView)
+    {
+    threeDView->setRenderEnabled(viewRenderEnabled);
+    threeDView->scheduleRender();
+    }
 
   // Enable module widget
   d->flyThroughSection->setEnabled(true);
   d->keyFramesSection->setEnabled(true);
   d->exportSection->setEnabled(true);
+
+  this->updateStatisticsLabel();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::onRenderStarted()
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+  d->RenderStartTime = vtkSlicerCameraPathStatistics::GetTime();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::onRenderEnded()
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+  double renderTime = vtkSlicerCameraPathStatistics::GetTime() - d->RenderStartTime;
+  d->logic()->GetStatistics()->AddStageTime(
+        vtkSlicerCameraPathStatistics::Render, renderTime);
+
+  if (d->PlaybackFrameTime <= 0.0 || !d->PlaybackRenderWindow)
+    {
+    return;
+    }
+
+  // Adapt the quality of the next frame, a full quality render does not
+  // tell how long an interactive one takes
+  if (d->FullQualityRender)
+    {
+    d->FullQualityRender = false;
+    }
+  else
+    {
+    d->PlaybackUpdateRate = vtkSlicerCameraPathLogic::ComputeDesiredUpdateRate(
+          d->PlaybackUpdateRate, renderTime, d->PlaybackFrameTime, d->StillUpdateRate);
+    }
+  d->PlaybackRenderWindow->SetDesiredUpdateRate(d->PlaybackUpdateRate);
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::startAdaptiveQuality()
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  double frameTime =
+    vtkSlicerCameraPathLogic::GetPlaybackFrameTime(this->playbackViewNode());
+  if (frameTime <= 0.0)
+    {
+    frameTime = 1.0 / d->fpsSpinBox->value();
+    }
+
+  d->PlaybackFrameTime = frameTime;
+  d->StillUpdateRate = d->PlaybackRenderWindow->GetDesiredUpdateRate();
+  d->PlaybackUpdateRate = 1.0 / frameTime;
+  d->FullQualityRender = false;
+  d->PlaybackRenderWindow->SetDesiredUpdateRate(d->PlaybackUpdateRate);
+}
 
 //-----------------------------------------------------------------------------
-void qSlicerCameraPathModuleWidget::travelToTime(double t)
+void qSlicerCameraPathModuleWidget::stopAdaptiveQuality()
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  if (d->PlaybackFrameTime <= 0.0)
+    {
+    return;
+    }
+  d->PlaybackFrameTime = 0.0;
+
+  // Render the last frame again at full quality
+  d->PlaybackRenderWindow->SetDesiredUpdateRate(d->StillUpdateRate);
+  d->PlaybackRenderWindow->Render();
+}
+
+//-----------------------------------------------------------------------------
+vtkMRMLViewNode* qSlicerCameraPathModuleWidget::playbackViewNode()
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  vtkMRMLViewNode* viewNode = this->getCameraViewNode(
+        vtkMRMLCameraNode::SafeDownCast(d->defaultCameraComboBox->currentNode()));
+  if (viewNode)
+    {
+    return viewNode;
+    }
+  return vtkMRMLViewNode::SafeDownCast(d->viewComboBox->currentNode());
+}
+
+//-----------------------------------------------------------------------------
+vtkMRMLViewNode* qSlicerCameraPathModuleWidget::getCameraViewNode(vtkMRMLCameraNode* cameraNode)
+{
+  vtkMRMLScene* scene = this->mrmlScene();
+  if (!cameraNode || !scene || !cameraNode->GetActiveTag())
+    {
+    return 0;
+    }
+  return vtkMRMLViewNode::SafeDownCast(scene->GetNodeByID(cameraNode->GetActiveTag()));
+}
+
+//-----------------------------------------------------------------------------
+vtkMRMLCameraNode* qSlicerCameraPathModuleWidget::getViewCameraNode(vtkMRMLViewNode* viewNode)
+{
+  vtkMRMLScene* scene = this->mrmlScene();
+  if (!viewNode || !scene)
+    {
+    return 0;
+    }
+  std::vector<vtkMRMLNode*> cameraNodes;
+  scene->GetNodesByClass("vtkMRMLCameraNode", cameraNodes);
+  for (size_t i = 0; i < cameraNodes.size(); ++i)
+    {
+    vtkMRMLCameraNode* cameraNode = vtkMRMLCameraNode::SafeDownCast(cameraNodes[i]);
+    if (cameraNode && cameraNode->GetActiveTag() &&
+        !strcmp(cameraNode->GetActiveTag(), viewNode->GetID()))
+      {
+      return cameraNode;
+      }
+    }
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+QList<vtkMRMLCameraNode*> qSlicerCameraPathModuleWidget::linkedCameraNodes()
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  QList<vtkMRMLCameraNode*> cameraNodes;
+  vtkMRMLNode* defaultCameraNode = d->defaultCameraComboBox->currentNode();
+  foreach(vtkMRMLNode* node, d->linkedCamerasComboBox->checkedNodes())
+    {
+    vtkMRMLCameraNode* cameraNode = vtkMRMLCameraNode::SafeDownCast(node);
+    if (cameraNode && node != defaultCameraNode)
+      {
+      cameraNodes << cameraNode;
+      }
+    }
+  return cameraNodes;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::onLinkedCameraChanged(vtkMRMLNode* node)
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  double offset = vtkSlicerCameraPathLogic::GetCameraTimeOffset(
+        vtkMRMLCameraNode::SafeDownCast(node));
+  bool wasBlocked = d->timeOffsetSpinBox->blockSignals(true);
+  d->timeOffsetSpinBox->setValue(offset);
+  d->timeOffsetSpinBox->blockSignals(wasBlocked);
+
+  int rigIndex = vtkSlicerCameraPathLogic::GetCameraRigIndex(
+        vtkMRMLCameraNode::SafeDownCast(node));
+  wasBlocked = d->rigCameraSpinBox->blockSignals(true);
+  d->rigCameraSpinBox->setValue(rigIndex);
+  d->rigCameraSpinBox->blockSignals(wasBlocked);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::onLinkedCamerasChecked()
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  // Move the cameras just linked, playback updates them on the next frame
+  if (!d->Timer->isActive())
+    {
+    this->setTime(d->Time);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::onTimeOffsetChanged(double offset)
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  vtkSlicerCameraPathLogic::SetCameraTimeOffset(
+        vtkMRMLCameraNode::SafeDownCast(d->linkedCamerasComboBox->currentNode()),
+        offset);
+  this->onLinkedCamerasChecked();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::onRigCameraChanged(int index)
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  vtkSlicerCameraPathLogic::SetCameraRigIndex(
+        vtkMRMLCameraNode::SafeDownCast(d->linkedCamerasComboBox->currentNode()),
+        index);
+  this->onLinkedCamerasChecked();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::onDefaultCameraChanged(vtkMRMLNode* node)
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+  Q_UNUSED(node);
+
+  // Show the frame time of the view the camera is displayed in
+  double frameTime =
+    vtkSlicerCameraPathLogic::GetPlaybackFrameTime(this->playbackViewNode());
+  bool wasBlocked = d->frameTimeSpinBox->blockSignals(true);
+  d->frameTimeSpinBox->setValue(qRound(1000.0 * frameTime));
+  d->frameTimeSpinBox->blockSignals(wasBlocked);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::onFrameTimeChanged(int frameTime)
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  vtkSlicerCameraPathLogic::SetPlaybackFrameTime(this->playbackViewNode(),
+                                                 frameTime / 1000.0);
+  if (d->PlaybackFrameTime > 0.0)
+    {
+    d->PlaybackFrameTime =
+      frameTime > 0 ? frameTime / 1000.0 : 1.0 / d->fpsSpinBox->value();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::onResetStatisticsClicked()
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+  d->logic()->GetStatistics()->Reset();
+  this->updateStatisticsLabel();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::onExportStatisticsClicked()
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  QString fileName = ctkFileDialog::getSaveFileName(
+        this, tr("Save Timings"), ".", tr("Timings (*.csv *.json)"));
+  if (fileName.isEmpty())
+    {
+    return;
+    }
+
+  vtkSlicerCameraPathStatistics* statistics = d->logic()->GetStatistics();
+  if (QFileInfo(fileName).suffix().toLower() == "json")
+    {
+    statistics->WriteJSON(fileName.toStdString().c_str());
+    }
+  else
+    {
+    if (QFileInfo(fileName).suffix().toLower() != "csv")
+      {
+      fileName += ".csv";
+      }
+    statistics->WriteCSV(fileName.toStdString().c_str());
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::updateStatisticsLabel()
+{
+  Q_D(qSlicerCameraPathModuleWidget);
+
+  vtkSlicerCameraPathStatistics* statistics = d->logic()->GetStatistics();
+  if (statistics->GetNumberOfFrames() == 0)
+    {
+    d->statisticsLabel->setText(tr("No frame recorded"));
+    return;
+    }
+
+  QString text = tr("%1 frames, %2 dropped, %3 fps\nMean frame: %4 ms")
+      .arg(statistics->GetNumberOfFrames())
+      .arg(statistics->GetNumberOfDroppedFrames())
+      .arg(statistics->GetAchievedFrameRate(), 0, 'f', 1)
+      .arg(1000.0 * statistics->GetMeanFrameTime(), 0, 'f', 1);
+  for (int stage = 0; stage < vtkSlicerCameraPathStatistics::NumberOfStages; ++stage)
+    {
+    text += QString("\n  %1: %2 ms")
+        .arg(vtkSlicerCameraPathStatistics::GetStageName(stage))
+        .arg(1000.0 * statistics->GetMeanStageTime(stage), 0, 'f', 2);
+    }
+  d->statisticsLabel->setText(text);
+}
+
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathModuleWidget::travelToTime(double t, const CameraPose* pose)
 {
   Q_D(qSlicerCameraPathModuleWidget);
 
@@ -1125,19 +2308,91 @@ void qSlicerCameraPathModuleWidget::travelToTime(double t)
     {
     return;
     }
+  d->Time = t;
+
+  // The path evaluations, the applies and the renders are timed apart, the
+  // renders of the playback view being timed by onRenderEnded()
+  vtkSlicerCameraPathStatistics* statistics = d->logic()->GetStatistics();
+  double evaluationTime = 0.0;
+  double renderTime = 0.0;
+  double linkedRenderTime = 0.0;
+  double start = vtkSlicerCameraPathStatistics::GetTime();
 
   // Update default camera
   if (cameraPathNode->GetNumberOfKeyFrames() != 0)
     {
-    cameraPathNode->GetCameraAt(t, cameraNode);
-    cameraNode->GetCamera()->SetClippingRange(0.1,cameraNode->GetCamera()->GetDistance()*6);
+    CameraPose evaluatedPose;
+    if (!pose)
+      {
+      double evaluationStart = vtkSlicerCameraPathStatistics::GetTime();
+      cameraPathNode->GetPoseAt(t, evaluatedPose);
+      evaluationTime += vtkSlicerCameraPathStatistics::GetTime() - evaluationStart;
+      pose = &evaluatedPose;
+      }
+    applyCameraPose(cameraNode, *pose);
+
+    // Update linked cameras, evaluating the path once per time offset
+    QList<vtkMRMLCameraNode*> linkedCameras = this->linkedCameraNodes();
+    if (!linkedCameras.isEmpty())
+      {
+      std::map<double, CameraPose> poses;
+      poses[0.0] = *pose;
+      foreach(vtkMRMLCameraNode* linkedCamera, linkedCameras)
+        {
+        double offset = vtkSlicerCameraPathLogic::GetCameraTimeOffset(linkedCamera);
+        std::map<double, CameraPose>::iterator it = poses.find(offset);
+        if (it == poses.end())
+          {
+          double evaluationStart = vtkSlicerCameraPathStatistics::GetTime();
+          it = poses.insert(std::make_pair(offset, CameraPose())).first;
+          cameraPathNode->GetPoseAt(t + offset, it->second);
+          evaluationTime += vtkSlicerCameraPathStatistics::GetTime() - evaluationStart;
+          }
+
+        // Linked cameras bound to a rig camera take its pose
+        int rigIndex = vtkSlicerCameraPathLogic::GetCameraRigIndex(linkedCamera);
+        if (rigIndex >= 0 && rigIndex < cameraPathNode->GetNumberOfRigCameras())
+          {
+          CameraPose rigPose;
+          cameraPathNode->GetRigPose(rigIndex, it->second, rigPose);
+          applyCameraPose(linkedCamera, rigPose);
+          }
+        else
+          {
+          applyCameraPose(linkedCamera, it->second);
+          }
+        }
+
+      // Render all the views now, so that they show the same frame instead
+      // of rendering whenever each one is scheduled. Each view has its own
+      // render window, the views are rendered one after the other.
+      linkedCameras.prepend(cameraNode);
+      QList<qMRMLThreeDView*> views;
+      foreach(vtkMRMLCameraNode* camera, linkedCameras)
+        {
+        qMRMLThreeDView* view = this->getMRMLThreeDView(this->getCameraViewNode(camera));
+        if (view && !views.contains(view))
+          {
+          views << view;
+          double renderStart = vtkSlicerCameraPathStatistics::GetTime();
+          view->forceRender();
+          double viewRenderTime = vtkSlicerCameraPathStatistics::GetTime() - renderStart;
+          renderTime += viewRenderTime;
+          if (view->renderWindow() != d->PlaybackRenderWindow)
+            {
+            linkedRenderTime += viewRenderTime;
+            }
+          }
+        }
+      }
     }
 
   // Update time label
   std::stringstream stream;
-  stream << std::fixed << std::setprecision(1) << t;
+  stream << std::fixed << std::setprecision(2) << t;
   std::string s = stream.str();
   d->timeValueLabel->setText(QString::fromStdString(s));
+  this->updateTimeSlider();
 
   // Check if time associated with a keyframe
   vtkIdType index = cameraPathNode->KeyFrameIndexAt(t);
@@ -1147,6 +2402,14 @@ void qSlicerCameraPathModuleWidget::travelToTime(double t)
     d->keyFramesTableWidget->selectRow(index);
     this->onItemClicked(d->keyFramesTableWidget->item(index,1));
     }
+
+  statistics->AddStageTime(vtkSlicerCameraPathStatistics::Evaluation,
+                           evaluationTime);
+  statistics->AddStageTime(vtkSlicerCameraPathStatistics::Apply,
+                           vtkSlicerCameraPathStatistics::GetTime() - start -
+                           evaluationTime - renderTime);
+  statistics->AddStageTime(vtkSlicerCameraPathStatistics::Render,
+                           linkedRenderTime);
 }
 
 //-----------------------------------------------------------------------------
@@ -1284,14 +2547,30 @@ void qSlicerCameraPathModuleWidget::showErrorTimeMsgBox(double time, vtkIdType i
 }
 
 //-----------------------------------------------------------------------------
-vtkRenderWindow* qSlicerCameraPathModuleWidget::getMRMLViewRenderWindow(vtkMRMLViewNode* viewNode)
+qMRMLThreeDView* qSlicerCameraPathModuleWidget::getMRMLThreeDView(vtkMRMLViewNode* viewNode)
 {
-//  const char* viewNodeID = cameraNode->GetActiveTag();
-//  vtkMRMLViewNode* viewNode = vtkMRMLViewNode::SafeDownCast(cameraNode->GetScene()->GetNodeByID(viewNodeID));
-
+  if (!viewNode)
+    {
+    return 0;
+    }
   qSlicerLayoutManager *layoutManager = qSlicerApplication::application()->layoutManager();
   qMRMLThreeDWidget* threeDWidget = qobject_cast<qMRMLThreeDWidget*>(layoutManager->mrmlViewFactory("vtkMRMLViewNode")->viewWidget(viewNode));
-  vtkRenderWindow *renderWindow = threeDWidget->threeDView()->renderWindow();
+  if (!threeDWidget)
+    {
+    return 0;
+    }
+  return threeDWidget->threeDView();
+}
+
+//-----------------------------------------------------------------------------
+vtkRenderWindow* qSlicerCameraPathModuleWidget::getMRMLViewRenderWindow(vtkMRMLViewNode* viewNode)
+{
+  qMRMLThreeDView* threeDView = this->getMRMLThreeDView(viewNode);
+  if (!threeDView)
+    {
+    return 0;
+    }
+  vtkRenderWindow *renderWindow = threeDView->renderWindow();
 
   return renderWindow;
 }
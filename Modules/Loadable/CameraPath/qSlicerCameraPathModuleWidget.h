@@ -28,8 +28,11 @@
 #include "vtkRenderWindow.h"
 #include "vtkMRMLViewNode.h"
 
+class qMRMLThreeDView;
 class qSlicerCameraPathModuleWidgetPrivate;
+class vtkMRMLCameraNode;
 class vtkMRMLNode;
+struct CameraPose;
 
 /// \ingroup Slicer_QtModules_ExtensionTemplate
 class Q_SLICER_QTMODULES_CAMERAPATH_EXPORT qSlicerCameraPathModuleWidget :
@@ -43,36 +46,65 @@ public:
   qSlicerCameraPathModuleWidget(QWidget *parent=0);
   virtual ~qSlicerCameraPathModuleWidget();
 
-  void travelToTime(double t);
+  /// Move the default camera to the path pose at time \a t, or to \a pose
+  /// if it was already evaluated.
+  void travelToTime(double t, const CameraPose* pose = 0);
+  /// Seek the path at exactly time \a t, clamped to the path time range.
+  /// During playback, playback continues from \a t.
+  void setTime(double t);
+  double time()const;
   void populateKeyFramesTableWidget();
   void emptyKeyFramesTableWidget();
   void emptyCameraTableWidget();
   void updateCameraTable(int index);
-  void updateSliderRange();
+  /// Move the time slider to the current time, the slider spans the path
+  /// time range with a fixed resolution
+  void updateTimeSlider();
   void showErrorTimeMsgBox(double time, vtkIdType index);
+  qMRMLThreeDView* getMRMLThreeDView(vtkMRMLViewNode *viewNode);
   vtkRenderWindow* getMRMLViewRenderWindow(vtkMRMLViewNode *viewNode);
 
-  enum ExportType{ VIDEOCLIP=0, SCREENSHOTS};
+  /// View the camera is displayed in, if any
+  vtkMRMLViewNode* getCameraViewNode(vtkMRMLCameraNode* cameraNode);
+  /// Camera displayed in the view, if any
+  vtkMRMLCameraNode* getViewCameraNode(vtkMRMLViewNode* viewNode);
+
+  /// Checked linked cameras, other than the default camera
+  QList<vtkMRMLCameraNode*> linkedCameraNodes();
+
+  /// View of the default camera, or the export view if the camera is not
+  /// displayed in a view
+  vtkMRMLViewNode* playbackViewNode();
+
+  enum ExportType{ VIDEOCLIP=0, SCREENSHOTS, ENCODERCOMMAND};
   enum ExportQuality{ LOW=0, MEDIUM, HIGH};
 
 public slots:
 
   void onCameraPathNodeChanged(vtkMRMLNode* node);
   void onCameraPathNodeModified(vtkObject* caller);
+  void onKeyFramesEdited(vtkObject* caller, void* callData, unsigned long event);
   void onCameraPathNodeRenamed(QString nodeName);
   void onCameraPathNodeAdded(vtkMRMLNode* node);
   void onCameraPathNodeAddedByUser(vtkMRMLNode* node);
   void onCameraPathNodeRemoved(vtkMRMLNode* node);
   void onCameraPathVisibilityToggled(bool visibility);
 
-  void onTimeSliderChanged(int frameNbr);
+  void onTimeSliderChanged(int value);
   void onFirstFrameClicked();
   void onPreviousFrameClicked();
   void onPlayPauseToogled(bool play);
   void onNextFrameClicked();
   void onLastFrameClicked();
   void onFPSChanged(int framerate);
+  void onDefaultCameraChanged(vtkMRMLNode* node);
+  void onFrameTimeChanged(int frameTime);
+  void onLinkedCameraChanged(vtkMRMLNode* node);
+  void onLinkedCamerasChecked();
+  void onTimeOffsetChanged(double offset);
+  void onRigCameraChanged(int index);
   void playToNextFrame();
+  void scrubToSliderTime();
   void onDeleteAllClicked();
   void onDeleteSelectedClicked();
   void onGoToKeyFrameClicked();
@@ -87,8 +119,17 @@ public slots:
   void onRenderWindowModified(vtkObject *caller);
   void onCurrentSizeClicked(bool);
   void onCustomSizeClicked(bool);
+  void onExportTypeChanged(int exportType);
+  void onExportQualityChanged(int exportQuality);
+  void onExportCodecChanged(int codec);
+  void onExportBitRateChanged(int bitRate);
   void onRecordClicked();
 
+  void onRenderStarted();
+  void onRenderEnded();
+  void onResetStatisticsClicked();
+  void onExportStatisticsClicked();
+
 protected:
   QScopedPointer<qSlicerCameraPathModuleWidgetPrivate> d_ptr;
 
@@ -99,7 +140,14 @@ private:
   Q_DISABLE_COPY(qSlicerCameraPathModuleWidget);
 
   void setTimerInterval(int framerate);
-  double getFrameTime(int frameNbr);
+  void updateStatisticsLabel();
+
+  /// Lower the rendering quality of the playback view to render each frame
+  /// within its frame time, see vtkSlicerCameraPathLogic::ComputeDesiredUpdateRate()
+  void startAdaptiveQuality();
+  void stopAdaptiveQuality();
+  /// Show the pose of \a frame during playback
+  void playFrame(int frame);
 };
 
 #endif
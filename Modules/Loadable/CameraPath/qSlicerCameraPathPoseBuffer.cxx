@@ -0,0 +1,407 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QWaitCondition>
+
+// CameraPath includes
+#include "qSlicerCameraPathPoseBuffer.h"
+#include "vtkMRMLPointSplineNode.h"
+#include "vtkSlicerCameraPathLogic.h"
+
+// STD includes
+#include <limits>
+#include <vector>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// Copy of the path splines evaluated by the worker thread
+struct PathSnapshot
+{
+  double TMin;
+  int Framerate;
+  int LastFrame;
+  std::vector<double> Intervals[3];
+  std::vector<double> Coefficients[3][3];
+};
+
+//-----------------------------------------------------------------------------
+// Relaxed accesses are not available with Qt 4, use ordered ones
+int atomicLoad(QAtomicInt& value)
+{
+  return value.fetchAndAddOrdered(0);
+}
+
+//-----------------------------------------------------------------------------
+void atomicStore(QAtomicInt& value, int newValue)
+{
+  value.fetchAndStoreOrdered(newValue);
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+class qSlicerCameraPathPoseBufferPrivate
+{
+public:
+  typedef QSharedPointer<const PathSnapshot> SnapshotPointer;
+
+  struct Slot
+  {
+    int Frame;
+    int Generation;
+    CameraPose Pose;
+  };
+
+  qSlicerCameraPathPoseBufferPrivate();
+
+  static SnapshotPointer createSnapshot(vtkMRMLCameraPathNode* cameraPathNode,
+                                        int framerate);
+  static void evaluate(const PathSnapshot& snapshot, int frame, CameraPose& pose);
+
+  /// Post a new request to the worker thread. If \a keepOlderBelow is
+  /// INT_MIN, all the buffered poses are dropped.
+  void request(SnapshotPointer snapshot, int frame, int keepOlderBelow);
+
+  /// Wake the worker thread up if it waits
+  void wakeUp();
+
+  std::vector<Slot> Slots;
+  /// Number of poses pushed, written by the worker thread only
+  QAtomicInt Head;
+  /// Number of poses taken, written by the GUI thread only
+  QAtomicInt Tail;
+  /// Incremented for each request, poses of older requests are dropped
+  QAtomicInt Generation;
+  QAtomicInt Stopped;
+  /// Set by the worker thread while it waits for a request, a pose to be
+  /// taken or stop(), so that the GUI thread only locks to wake it up
+  QAtomicInt Waiting;
+
+  /// Request read by the worker thread
+  QMutex Mutex;
+  QWaitCondition WakeUp;
+  SnapshotPointer Snapshot;
+  int StartFrame;
+
+  /// GUI thread only: poses of the requests since KeepFromGeneration are
+  /// valid below frame KeepOlderBelow, see invalidate()
+  int KeepFromGeneration;
+  int KeepOlderBelow;
+  int LastTakenFrame;
+};
+
+//-----------------------------------------------------------------------------
+qSlicerCameraPathPoseBufferPrivate::qSlicerCameraPathPoseBufferPrivate()
+  : Head(0)
+  , Tail(0)
+  , Generation(0)
+  , Stopped(0)
+  , Waiting(0)
+  , StartFrame(0)
+  , KeepFromGeneration(0)
+  , KeepOlderBelow(std::numeric_limits<int>::min())
+  , LastTakenFrame(-1)
+{
+  this->Slots.resize(64);
+}
+
+//-----------------------------------------------------------------------------
+qSlicerCameraPathPoseBufferPrivate::SnapshotPointer
+qSlicerCameraPathPoseBufferPrivate::createSnapshot(
+  vtkMRMLCameraPathNode* cameraPathNode, int framerate)
+{
+  if (!cameraPathNode || cameraPathNode->GetNumberOfKeyFrames() < 2 ||
+      framerate <= 0)
+    {
+    return SnapshotPointer();
+    }
+
+  PathSnapshot* snapshot = new PathSnapshot;
+  snapshot->TMin = cameraPathNode->GetMinimumT();
+  snapshot->Framerate = framerate;
+  snapshot->LastFrame = vtkSlicerCameraPathLogic::GetNumberOfFrames(
+    snapshot->TMin, cameraPathNode->GetMaximumT(), framerate) - 1;
+
+  vtkMRMLPointSplineNode* splines[3] = {
+    cameraPathNode->GetPositionSplines(),
+    cameraPathNode->GetFocalPointSplines(),
+    cameraPathNode->GetViewUpSplines()};
+  for (int channel = 0; channel < 3; ++channel)
+    {
+    if (!splines[channel]->GetCoefficients(snapshot->Intervals[channel],
+                                           snapshot->Coefficients[channel]))
+      {
+      delete snapshot;
+      return SnapshotPointer();
+      }
+    }
+  return SnapshotPointer(snapshot);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathPoseBufferPrivate::evaluate(const PathSnapshot& snapshot,
+                                                  int frame, CameraPose& pose)
+{
+  double t = vtkSlicerCameraPathLogic::GetFrameTime(snapshot.TMin, frame,
+                                                   snapshot.Framerate);
+  vtkMRMLPointSplineNode::EvaluateCoefficients(
+    snapshot.Intervals[0], snapshot.Coefficients[0], t, pose.Position);
+  vtkMRMLPointSplineNode::EvaluateCoefficients(
+    snapshot.Intervals[1], snapshot.Coefficients[1], t, pose.FocalPoint);
+  vtkMRMLPointSplineNode::EvaluateCoefficients(
+    snapshot.Intervals[2], snapshot.Coefficients[2], t, pose.ViewUp);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathPoseBufferPrivate::request(SnapshotPointer snapshot,
+                                                 int frame, int keepOlderBelow)
+{
+  QMutexLocker locker(&this->Mutex);
+  this->Snapshot = snapshot;
+  this->StartFrame = frame;
+  int generation = this->Generation.fetchAndAddOrdered(1) + 1;
+  if (keepOlderBelow == std::numeric_limits<int>::min())
+    {
+    this->KeepFromGeneration = generation;
+    }
+  this->KeepOlderBelow = keepOlderBelow;
+  this->WakeUp.wakeOne();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathPoseBufferPrivate::wakeUp()
+{
+  if (atomicLoad(this->Waiting))
+    {
+    QMutexLocker locker(&this->Mutex);
+    this->WakeUp.wakeOne();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// qSlicerCameraPathPoseBuffer methods
+
+//-----------------------------------------------------------------------------
+qSlicerCameraPathPoseBuffer::qSlicerCameraPathPoseBuffer(QObject* _parent)
+  : Superclass(_parent)
+  , d_ptr(new qSlicerCameraPathPoseBufferPrivate)
+{
+}
+
+//-----------------------------------------------------------------------------
+qSlicerCameraPathPoseBuffer::~qSlicerCameraPathPoseBuffer()
+{
+  this->stop();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathPoseBuffer::setCapacity(int capacity)
+{
+  Q_D(qSlicerCameraPathPoseBuffer);
+  if (this->isRunning() || capacity < 1)
+    {
+    return;
+    }
+  d->Slots.resize(capacity);
+  atomicStore(d->Head, 0);
+  atomicStore(d->Tail, 0);
+}
+
+//-----------------------------------------------------------------------------
+int qSlicerCameraPathPoseBuffer::capacity()const
+{
+  Q_D(const qSlicerCameraPathPoseBuffer);
+  return static_cast<int>(d->Slots.size());
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathPoseBuffer::setPath(vtkMRMLCameraPathNode* cameraPathNode,
+                                          int framerate, int frame)
+{
+  Q_D(qSlicerCameraPathPoseBuffer);
+  d->request(d->createSnapshot(cameraPathNode, framerate), frame,
+             std::numeric_limits<int>::min());
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathPoseBuffer::invalidate(vtkMRMLCameraPathNode* cameraPathNode,
+                                             double t)
+{
+  Q_D(qSlicerCameraPathPoseBuffer);
+
+  qSlicerCameraPathPoseBufferPrivate::SnapshotPointer snapshot;
+  {
+  QMutexLocker locker(&d->Mutex);
+  snapshot = d->Snapshot;
+  }
+  if (!snapshot)
+    {
+    return;
+    }
+  qSlicerCameraPathPoseBufferPrivate::SnapshotPointer newSnapshot =
+    d->createSnapshot(cameraPathNode, snapshot->Framerate);
+
+  // frames are numbered from the first keyframe: if it moved, no buffered
+  // pose is at the right time anymore
+  if (!newSnapshot || newSnapshot->TMin != snapshot->TMin)
+    {
+    d->request(newSnapshot, d->LastTakenFrame + 1,
+               std::numeric_limits<int>::min());
+    return;
+    }
+
+  // first frame that may have changed, the poses of previous frames are kept
+  // unless an earlier request already dropped them
+  int frame = qMax(0, vtkSlicerCameraPathLogic::GetFrameAt(
+                        newSnapshot->TMin, t, newSnapshot->Framerate));
+  int keepOlderBelow = frame;
+  if (d->KeepOlderBelow != std::numeric_limits<int>::min())
+    {
+    keepOlderBelow = qMin(frame, d->KeepOlderBelow);
+    }
+
+  // resume after the last pose still valid, or after the last pose taken
+  int startFrame = d->LastTakenFrame + 1;
+  int tail = atomicLoad(d->Tail);
+  int head = atomicLoad(d->Head);
+  int generation = atomicLoad(d->Generation);
+  for (int i = tail; i != head; ++i)
+    {
+    const qSlicerCameraPathPoseBufferPrivate::Slot& slot =
+      d->Slots[i % d->Slots.size()];
+    bool valid = slot.Generation == generation ||
+      (slot.Generation >= d->KeepFromGeneration && slot.Frame < d->KeepOlderBelow);
+    if (valid && slot.Frame < keepOlderBelow)
+      {
+      startFrame = qMax(startFrame, slot.Frame + 1);
+      }
+    }
+  startFrame = qMin(startFrame, keepOlderBelow);
+
+  d->request(newSnapshot, startFrame, keepOlderBelow);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathPoseBuffer::seek(int frame)
+{
+  Q_D(qSlicerCameraPathPoseBuffer);
+  qSlicerCameraPathPoseBufferPrivate::SnapshotPointer snapshot;
+  {
+  QMutexLocker locker(&d->Mutex);
+  snapshot = d->Snapshot;
+  }
+  d->request(snapshot, frame, std::numeric_limits<int>::min());
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCameraPathPoseBuffer::takePose(int frame, CameraPose& pose)
+{
+  Q_D(qSlicerCameraPathPoseBuffer);
+
+  int tail = atomicLoad(d->Tail);
+  int head = atomicLoad(d->Head);
+  int generation = atomicLoad(d->Generation);
+  bool found = false;
+  for (; tail != head; ++tail)
+    {
+    const qSlicerCameraPathPoseBufferPrivate::Slot& slot =
+      d->Slots[tail % d->Slots.size()];
+    bool valid = slot.Generation == generation ||
+      (slot.Generation >= d->KeepFromGeneration && slot.Frame < d->KeepOlderBelow);
+    if (!valid || slot.Frame < frame)
+      {
+      continue;
+      }
+    if (slot.Frame == frame)
+      {
+      pose = slot.Pose;
+      found = true;
+      ++tail;
+      }
+    break;
+    }
+  atomicStore(d->Tail, tail);
+  d->LastTakenFrame = frame;
+  // room was made in the buffer
+  d->wakeUp();
+  return found;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathPoseBuffer::stop()
+{
+  Q_D(qSlicerCameraPathPoseBuffer);
+  atomicStore(d->Stopped, 1);
+  d->wakeUp();
+  this->wait();
+  atomicStore(d->Stopped, 0);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCameraPathPoseBuffer::run()
+{
+  Q_D(qSlicerCameraPathPoseBuffer);
+
+  qSlicerCameraPathPoseBufferPrivate::SnapshotPointer snapshot;
+  int generation = atomicLoad(d->Generation) - 1;
+  int frame = 0;
+  const int capacity = static_cast<int>(d->Slots.size());
+
+  while (!atomicLoad(d->Stopped))
+    {
+    // pick up the last request
+    if (atomicLoad(d->Generation) != generation)
+      {
+      QMutexLocker locker(&d->Mutex);
+      generation = atomicLoad(d->Generation);
+      snapshot = d->Snapshot;
+      frame = d->StartFrame;
+      }
+
+    // nothing to compute or buffer full: wait for a request, a pose to be
+    // taken or stop(), checking again once Waiting is visible to them
+    int head = atomicLoad(d->Head);
+    if (!snapshot || frame > snapshot->LastFrame ||
+        head - atomicLoad(d->Tail) >= capacity)
+      {
+      QMutexLocker locker(&d->Mutex);
+      atomicStore(d->Waiting, 1);
+      if (!atomicLoad(d->Stopped) && atomicLoad(d->Generation) == generation &&
+          (!snapshot || frame > snapshot->LastFrame ||
+           head - atomicLoad(d->Tail) >= capacity))
+        {
+        d->WakeUp.wait(&d->Mutex);
+        }
+      atomicStore(d->Waiting, 0);
+      continue;
+      }
+
+    qSlicerCameraPathPoseBufferPrivate::Slot& slot = d->Slots[head % capacity];
+    slot.Frame = frame;
+    slot.Generation = generation;
+    d->evaluate(*snapshot, frame, slot.Pose);
+    atomicStore(d->Head, head + 1);
+    ++frame;
+    }
+}
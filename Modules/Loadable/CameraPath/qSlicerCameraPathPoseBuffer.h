@@ -0,0 +1,81 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qSlicerCameraPathPoseBuffer_h
+#define __qSlicerCameraPathPoseBuffer_h
+
+// Qt includes
+#include <QThread>
+
+// CameraPath includes
+#include "vtkMRMLCameraPathNode.h"
+
+class qSlicerCameraPathPoseBufferPrivate;
+
+//----------------------------------------------------------------------------
+/// \ingroup Slicer_QtModules_CameraPath
+/// Look-ahead buffer of camera poses for playback.
+/// A worker thread evaluates a copy of the path splines for the frames
+/// following the playback position and pushes the poses into a single
+/// producer, single consumer ring buffer. Taking a pose does not wait for
+/// the spline evaluation, it only locks to wake the worker up when the
+/// worker waits for room in the buffer.
+/// All the methods but run() must be called from the same (GUI) thread.
+class qSlicerCameraPathPoseBuffer
+  : public QThread
+{
+  Q_OBJECT
+public:
+  typedef QThread Superclass;
+  qSlicerCameraPathPoseBuffer(QObject* parent = 0);
+  virtual ~qSlicerCameraPathPoseBuffer();
+
+  /// Number of poses computed ahead, 64 by default.
+  /// It can only be changed while the thread is not running.
+  void setCapacity(int capacity);
+  int capacity()const;
+
+  /// Copy the splines of \a cameraPathNode and compute the poses from
+  /// \a frame, frames being sampled at \a framerate from the first keyframe.
+  void setPath(vtkMRMLCameraPathNode* cameraPathNode, int framerate, int frame);
+
+  /// Take the new splines of \a cameraPathNode after an edit and drop the
+  /// buffered poses from time \a t onwards, the poses before \a t are kept.
+  void invalidate(vtkMRMLCameraPathNode* cameraPathNode, double t);
+
+  /// Drop the buffered poses and compute the poses from \a frame.
+  void seek(int frame);
+
+  /// Take the pose of \a frame if it is ready, dropping the poses of the
+  /// previous frames. Return false otherwise, the pose should then be
+  /// evaluated on the path node and the buffer moved with seek().
+  bool takePose(int frame, CameraPose& pose);
+
+  /// Stop the worker thread and wait for it
+  void stop();
+
+protected:
+  virtual void run();
+
+  QScopedPointer<qSlicerCameraPathPoseBufferPrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(qSlicerCameraPathPoseBuffer);
+  Q_DISABLE_COPY(qSlicerCameraPathPoseBuffer);
+};
+
+#endif
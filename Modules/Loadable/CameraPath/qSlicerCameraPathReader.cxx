@@ -16,6 +16,7 @@
 ==============================================================================*/
 
 // Qt includes
+#include <QDebug>
 #include <QFileInfo>
 
 // SlicerQt includes
@@ -26,6 +27,11 @@
 #include "vtkSlicerCameraPathLogic.h"
 
 // MRML includes
+#include <vtkMRMLScene.h>
+
+// STD includes
+#include <string>
+#include <vector>
 
 // VTK includes
 #include <vtkNew.h>
@@ -97,43 +103,75 @@ bool qSlicerCameraPathReader::load(const IOProperties& properties)
 {
   Q_D(qSlicerCameraPathReader);
 
-  // get the properties
+  // get the properties, fileName can be a single file or a list of files
   Q_ASSERT(properties.contains("fileName"));
-  QString fileName = properties["fileName"].toString();
-
-  QString name = QFileInfo(fileName).baseName();
-  if (properties.contains("name"))
+  QStringList fileNames;
+  if (properties["fileName"].type() == QVariant::StringList)
     {
-    name = properties["name"].toString();
+    fileNames = properties["fileName"].toStringList();
     }
-
-  if (d->CameraPathLogic.GetPointer() == 0)
+  else
+    {
+    fileNames << properties["fileName"].toString();
+    }
+  if (fileNames.isEmpty())
     {
     return false;
     }
 
-  // pass to logic to do the loading
-  char* nodeIDs = d->CameraPathLogic->LoadCameraPath(
-        fileName.toLatin1(), name.toLatin1());
-
-  if (nodeIDs)
+  if (d->CameraPathLogic.GetPointer() == 0 ||
+      d->CameraPathLogic->GetMRMLScene() == 0)
     {
-    // returned a comma separated list of ids of the nodes that were loaded
-    QStringList nodeIDList;
-    char *ptr = strtok(nodeIDs, ",");
+    return false;
+    }
 
-    while (ptr)
+  // a single file may be given its node name, several files are read and
+  // their paths computed on the worker threads of the logic
+  char* nodeIDs = 0;
+  if (fileNames.size() == 1)
+    {
+    QString name = QFileInfo(fileNames[0]).baseName();
+    if (properties.contains("name"))
       {
-      nodeIDList.append(ptr);
-      ptr = strtok(NULL, ",");
+      name = properties["name"].toString();
       }
-    this->setLoadedNodes(nodeIDList);
+    nodeIDs = d->CameraPathLogic->LoadCameraPath(fileNames[0].toLatin1(),
+                                                 name.toLatin1());
     }
   else
     {
-    this->setLoadedNodes(QStringList());
+    std::vector<std::string> fileNameVector;
+    foreach(const QString& fileName, fileNames)
+      {
+      fileNameVector.push_back(fileName.toStdString());
+      }
+    nodeIDs = d->CameraPathLogic->LoadCameraPaths(fileNameVector);
+    }
+  if (!nodeIDs)
+    {
+    qWarning() << "Could not read camera path files" << fileNames;
     return false;
     }
 
-  return nodeIDs != 0;
+  // returned a comma separated list of ids of the nodes that were loaded,
+  // one camera path node per file read
+  QStringList nodeIDList;
+  int numberOfCameraPaths = 0;
+  vtkMRMLScene* scene = d->CameraPathLogic->GetMRMLScene();
+  char *ptr = strtok(nodeIDs, ",");
+  while (ptr)
+    {
+    nodeIDList.append(ptr);
+    vtkMRMLNode* node = scene->GetNodeByID(ptr);
+    if (node && node->IsA("vtkMRMLCameraPathNode"))
+      {
+      ++numberOfCameraPaths;
+      }
+    ptr = strtok(NULL, ",");
+    }
+  free(nodeIDs);
+
+  this->setLoadedNodes(nodeIDList);
+
+  return numberOfCameraPaths == fileNames.size();
 }